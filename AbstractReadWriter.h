@@ -23,12 +23,20 @@ public:
 
     virtual QByteArray readAll() = 0;
 
+    virtual qint64 read(char *data, qint64 maxSize) = 0;
+
     virtual qint64 write(const QByteArray &byteArray) const = 0;
 
     virtual QString settingsText() const = 0;
 
+    // 丢弃已到达但还没读出的数据, 持久会话在两块板之间调用; 默认读出后丢掉
+    virtual void discardBuffers() { readAll(); }
+
 signals:
     void readyRead();
+
+    // 网络类读写者断线/重连成功时发出; 串口只在设备被拔出时发出 false
+    void connectionChanged(bool connected);
 };
 
 
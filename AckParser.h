@@ -0,0 +1,170 @@
+#ifndef ACKPARSER_H
+#define ACKPARSER_H
+
+#include <cstdint>
+#include <cstring>
+#include "ComTest.h"
+#include "BinaryProtocol.h"
+
+/*
+ * 应答帧解析, 直接在原始字节上分词, 不分配内存.
+ * 二进制协议帧按固定偏移直接取测试项和状态, 见 parseBinary.
+ * "ack/nack <测试项>" 通过编译期生成的 FNV-1a 哈希 switch 映射到 eTestAckDef 和 TEST_IDX_*;
+ * 若两个键哈希冲突, case 标签重复会直接导致编译失败.
+ *
+ *   eg. gz_test com nack 485 7f
+ *       [0]     [1] [2]  [3] [4]
+ */
+namespace AckParser {
+
+struct Token {
+    const char *data;
+    int len;
+};
+
+struct ParsedAck {
+    ComTest::eTestAckDef ack;
+    int id;             // TEST_IDX_*
+    bool isPass;
+    uint32_t result;    // nack 485 时为通道掩码
+};
+
+constexpr uint32_t kFnvOffset = 2166136261u;
+constexpr uint32_t kFnvPrime = 16777619u;
+
+constexpr uint32_t fnv1a(const char *s, uint32_t h = kFnvOffset)
+{
+    return *s ? fnv1a(s + 1, (h ^ static_cast<uint8_t>(*s)) * kFnvPrime) : h;
+}
+
+inline uint32_t fnv1a(const char *s, int len, uint32_t h)
+{
+    for (int i = 0; i < len; i++)
+        h = (h ^ static_cast<uint8_t>(s[i])) * kFnvPrime;
+    return h;
+}
+
+// 按空格分词, 最多 maxTokens 个, 返回实际个数
+inline int tokenize(const char *data, int len, Token *tokens, int maxTokens)
+{
+    int n = 0;
+    int i = 0;
+    while (i < len && n < maxTokens) {
+        while (i < len && data[i] == ' ')
+            i++;
+        if (i >= len)
+            break;
+        const int start = i;
+        while (i < len && data[i] != ' ')
+            i++;
+        tokens[n].data = data + start;
+        tokens[n].len = i - start;
+        n++;
+    }
+    return n;
+}
+
+inline bool tokenEquals(const Token &t, const char *s, int len)
+{
+    return t.len == len && memcmp(t.data, s, static_cast<size_t>(len)) == 0;
+}
+
+inline uint32_t parseHex(const Token &t)
+{
+    int i = 0;
+    if (t.len > 2 && t.data[0] == '0' && (t.data[1] == 'x' || t.data[1] == 'X'))
+        i = 2;
+    uint32_t v = 0;
+    for (; i < t.len; i++) {
+        const char c = t.data[i];
+        uint32_t d;
+        if (c >= '0' && c <= '9')
+            d = static_cast<uint32_t>(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            d = static_cast<uint32_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            d = static_cast<uint32_t>(c - 'A' + 10);
+        else
+            return 0;   // 与 QString::toULong 一致, 非法时为0
+        v = (v << 4) | d;
+    }
+    return v;
+}
+
+#define GZ_ACK_CASE(verb, item, ackValue, idx)                                       \
+    case fnv1a(verb " " item):                                                       \
+        if (!tokenEquals(tokens[2], verb, sizeof(verb) - 1)                          \
+                || !tokenEquals(tokens[3], item, sizeof(item) - 1))                  \
+            return false;                                                            \
+        out->ack = ComTest::ackValue;                                                \
+        out->id = idx;                                                               \
+        break;
+
+// 二进制应答帧, CRC 已由 FrameParser 校验, 这里只检查长度和字段范围
+inline bool parseBinary(const char *data, int len, ParsedAck *out)
+{
+    if (len < BinaryProtocol::FRAME_MIN
+            || len != BinaryProtocol::HEADER_LEN + static_cast<uint8_t>(data[2]) + BinaryProtocol::CRC_LEN)
+        return false;
+    const int item = BinaryProtocol::frameItem(data);
+    const int status = BinaryProtocol::frameStatus(data);
+    if (BinaryProtocol::frameType(data) != BinaryProtocol::TYPE_ACK || item >= TEST_ITEMS_NUM
+            || (status != BinaryProtocol::STATUS_ACK && status != BinaryProtocol::STATUS_NACK))
+        return false;
+
+    out->id = item;
+    out->isPass = (status == BinaryProtocol::STATUS_ACK);
+    out->ack = static_cast<ComTest::eTestAckDef>(ComTest::GZ_ACK_DEBUG_COM_SUCCESS + item * 2 + (out->isPass ? 0 : 1));
+    out->result = 0;
+    if (!out->isPass && item == TEST_IDX_485) {
+        // 通道掩码, 小端
+        const char *payload = BinaryProtocol::framePayload(data);
+        const int n = qMin(BinaryProtocol::framePayloadLen(data), 4);
+        for (int i = n - 1; i >= 0; i--)
+            out->result = (out->result << 8) | static_cast<uint8_t>(payload[i]);
+    }
+    return true;
+}
+
+// 解析一帧应答(ASCII 或二进制), 不是已知应答时返回 false
+inline bool parse(const char *data, int len, ParsedAck *out)
+{
+    if (BinaryProtocol::isFrame(data, len))
+        return parseBinary(data, len, out);
+
+    Token tokens[5];
+    const int n = tokenize(data, len, tokens, 5);
+    if (n < 4)
+        return false;
+
+    uint32_t h = fnv1a(tokens[2].data, tokens[2].len, kFnvOffset);
+    h = fnv1a(" ", 1, h);
+    h = fnv1a(tokens[3].data, tokens[3].len, h);
+
+    switch (h) {
+    GZ_ACK_CASE("ack",  "uart_debug", GZ_ACK_DEBUG_COM_SUCCESS, TEST_IDX_DEBUG_COM)
+    GZ_ACK_CASE("nack", "uart_debug", GZ_ACK_DEBUG_COM_FAILED,  TEST_IDX_DEBUG_COM)
+    GZ_ACK_CASE("ack",  "ethernet",   GZ_ACK_ETHERNET_SUCCESS,  TEST_IDX_ETHERNET)
+    GZ_ACK_CASE("nack", "ethernet",   GZ_ACK_ETHERNET_FAILED,   TEST_IDX_ETHERNET)
+    GZ_ACK_CASE("ack",  "485",        GZ_ACK_485_SUCCESS,       TEST_IDX_485)
+    GZ_ACK_CASE("nack", "485",        GZ_ACK_485_FAILED,        TEST_IDX_485)
+    GZ_ACK_CASE("ack",  "can",        GZ_ACK_CAN_SUCCESS,       TEST_IDX_CAN)
+    GZ_ACK_CASE("nack", "can",        GZ_ACK_CAN_FAILED,        TEST_IDX_CAN)
+    GZ_ACK_CASE("ack",  "pmbus",      GZ_ACK_PMBUS_SUCCESS,     TEST_IDX_PMBUS)
+    GZ_ACK_CASE("nack", "pmbus",      GZ_ACK_PMBUS_FAILED,      TEST_IDX_PMBUS)
+    default:
+        return false;
+    }
+
+    out->isPass = ((out->ack - ComTest::GZ_ACK_DEBUG_COM_SUCCESS) % 2) == 0;
+    out->result = 0;
+    if (!out->isPass && out->id == TEST_IDX_485 && n > 4)
+        out->result = parseHex(tokens[4]);
+    return true;
+}
+
+#undef GZ_ACK_CASE
+
+}
+
+#endif // ACKPARSER_H
@@ -0,0 +1,131 @@
+#include "AsyncReadWriter.h"
+#include "AbstractReadWriter.h"
+
+#include <QtCore/QMetaObject>
+
+ReadWriterWorker::ReadWriterWorker(AbstractReadWriter *readWriter, ByteRingBuffer *ring)
+        : readWriter(readWriter), ring(ring) {
+    readWriter->setParent(this);
+    connect(readWriter, &AbstractReadWriter::readyRead, this, &ReadWriterWorker::onReadyRead);
+    connect(readWriter, &AbstractReadWriter::connectionChanged, this, &ReadWriterWorker::onConnectionChanged);
+}
+
+bool ReadWriterWorker::open() {
+    // 网络读写者可能在 open 中就发出 connectionChanged(true), 此时要已经算作打开
+    opened = true;
+    bool result = readWriter->open();
+    opened = result;
+    connected = result && readWriter->isConnected();
+    return result;
+}
+
+void ReadWriterWorker::close() {
+    opened = false;
+    connected = false;
+    readWriter->close();
+}
+
+void ReadWriterWorker::onConnectionChanged(bool isConnected) {
+    connected = opened && isConnected;
+    emit connectionChanged(connected);
+}
+
+void ReadWriterWorker::write(const QByteArray &data) {
+    readWriter->write(data);
+}
+
+void ReadWriterWorker::discard() {
+    readWriter->discardBuffers();
+}
+
+void ReadWriterWorker::onReadyRead() {
+    for (;;) {
+        char *span;
+        size_t room = ring->writableSpan(&span);
+        if (room == 0) {
+            // 消费者跟不上, 丢弃并计数, 不让串口驱动缓冲区溢出
+            char scratch[256];
+            auto n = readWriter->read(scratch, sizeof(scratch));
+            if (n <= 0)
+                break;
+            ring->addDropped(static_cast<size_t>(n));
+            continue;
+        }
+        auto n = readWriter->read(span, static_cast<qint64>(room));
+        if (n <= 0)
+            break;
+        ring->commitWrite(static_cast<size_t>(n));
+    }
+
+    // 缓冲区从空变为非空时才通知, 避免每个数据块都投递一个事件
+    if (!ring->isEmpty() && !notifyPending.exchange(true)) {
+        emit dataArrived();
+    }
+}
+
+
+AsyncReadWriter::AsyncReadWriter(AbstractReadWriter *readWriter, QObject *parent, size_t rxCapacity)
+        : QObject(parent), ring(rxCapacity) {
+    settings = readWriter->settingsText();
+    worker = new ReadWriterWorker(readWriter, &ring);
+    worker->moveToThread(&thread);
+    connect(worker, &ReadWriterWorker::dataArrived, this, &AsyncReadWriter::onDataArrived);
+    connect(worker, &ReadWriterWorker::connectionChanged, this, &AsyncReadWriter::connectionChanged);
+    thread.setObjectName("readWriterIo");
+    thread.start(QThread::HighPriority);
+}
+
+AsyncReadWriter::~AsyncReadWriter() {
+    close();
+    thread.quit();
+    thread.wait();
+    delete worker;
+}
+
+bool AsyncReadWriter::open() {
+    bool result = false;
+    QMetaObject::invokeMethod(worker, "open", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, result));
+    return result;
+}
+
+void AsyncReadWriter::close() {
+    if (thread.isRunning()) {
+        QMetaObject::invokeMethod(worker, "close", Qt::BlockingQueuedConnection);
+    }
+}
+
+bool AsyncReadWriter::isOpen() const {
+    return worker->opened;
+}
+
+bool AsyncReadWriter::isConnected() const {
+    return worker->connected;
+}
+
+QString AsyncReadWriter::settingsText() const {
+    return settings;
+}
+
+size_t AsyncReadWriter::resync() {
+    if (thread.isRunning()) {
+        QMetaObject::invokeMethod(worker, "discard", Qt::BlockingQueuedConnection);
+    }
+    // IO线程已清掉底层缓冲, 环形缓冲区里剩下的都是旧数据, 之后到达的才属于下一块板
+    const size_t stale = ring.size();
+    ring.clear();
+    return stale;
+}
+
+qint64 AsyncReadWriter::write(const QByteArray &data) {
+    if (!worker->opened) {
+        return 0;
+    }
+    QMetaObject::invokeMethod(worker, "write", Qt::QueuedConnection, Q_ARG(QByteArray, data));
+    return data.size();
+}
+
+void AsyncReadWriter::onDataArrived() {
+    // 先清标志再通知消费者, 之后到达的数据会重新触发 dataArrived
+    worker->notifyPending = false;
+    emit readyRead();
+}
@@ -0,0 +1,105 @@
+#ifndef ASYNCREADWRITER_H
+#define ASYNCREADWRITER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <atomic>
+#include "ByteRingBuffer.h"
+
+class AbstractReadWriter;
+
+/*
+ * 在独立IO线程中运行的读写者, 只被 AsyncReadWriter 使用.
+ * 收到的数据直接读入环形缓冲区, 不经过 QByteArray.
+ */
+class ReadWriterWorker : public QObject {
+Q_OBJECT
+public:
+    ReadWriterWorker(AbstractReadWriter *readWriter, ByteRingBuffer *ring);
+
+    std::atomic<bool> notifyPending{false};
+    std::atomic<bool> opened{false};
+    std::atomic<bool> connected{false};
+
+public slots:
+    bool open();
+
+    void close();
+
+    void write(const QByteArray &data);
+
+    void discard();
+
+private slots:
+    void onReadyRead();
+
+    void onConnectionChanged(bool isConnected);
+
+signals:
+    void dataArrived();
+
+    void connectionChanged(bool isConnected);
+
+private:
+    AbstractReadWriter *readWriter;
+    ByteRingBuffer *ring;
+};
+
+
+/*
+ * 把任意 AbstractReadWriter 放到自己的 QThread 中运行.
+ * IO线程是唯一的生产者, 把收到的字节写入预分配的无锁环形缓冲区;
+ * 所属线程(一般是GUI线程)是唯一的消费者, 收到 readyRead() 后从 rxBuffer() 取数据.
+ */
+class AsyncReadWriter : public QObject {
+Q_OBJECT
+public:
+    // 接管 readWriter 的所有权, readWriter 不能有 parent
+    explicit AsyncReadWriter(AbstractReadWriter *readWriter, QObject *parent = nullptr,
+                             size_t rxCapacity = 64 * 1024);
+
+    ~AsyncReadWriter() override;
+
+    // 在IO线程中打开, 阻塞等待结果. 网络端口只发起连接就返回, 连上后发出 connectionChanged(true)
+    bool open();
+
+    void close();
+
+    bool isOpen() const;
+
+    bool isConnected() const;
+
+    QString settingsText() const;
+
+    // 丢弃底层和环形缓冲区中尚未处理的数据, 阻塞到IO线程处理完; 返回环形缓冲区中丢弃的字节数
+    size_t resync();
+
+    // 排队到IO线程发送, 返回排队的字节数
+    qint64 write(const QByteArray &data);
+
+    ByteRingBuffer &rxBuffer() { return ring; }
+
+    size_t queueDepth() const { return ring.size(); }
+
+    size_t highWaterMark() const { return ring.highWaterMark(); }
+
+    unsigned long long droppedBytes() const { return ring.droppedBytes(); }
+
+signals:
+    void readyRead();
+
+    // 底层连接断开或重连成功, 在所属线程中发出
+    void connectionChanged(bool isConnected);
+
+private slots:
+    void onDataArrived();
+
+private:
+    ByteRingBuffer ring;
+    QThread thread;
+    ReadWriterWorker *worker{nullptr};
+    QString settings;
+};
+
+
+#endif //ASYNCREADWRITER_H
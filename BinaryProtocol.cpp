@@ -0,0 +1,124 @@
+#include "BinaryProtocol.h"
+#include "ComTest.h"
+
+#include <cstring>
+
+namespace BinaryProtocol {
+
+const char kHello[] = "gz_test proto bin1";
+const char kHelloAck[] = "gz_test proto ack bin1";
+
+namespace {
+
+struct CrcTable {
+    uint16_t v[256];
+
+    CrcTable()
+    {
+        for (int i = 0; i < 256; i++) {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; bit++)
+                crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+            v[i] = crc;
+        }
+    }
+};
+
+const CrcTable &crcTable()
+{
+    static const CrcTable table;
+    return table;
+}
+
+struct CommandTable {
+    QByteArray frames[TEST_ITEMS_NUM];
+
+    CommandTable()
+    {
+        for (int i = 0; i < TEST_ITEMS_NUM; i++)
+            frames[i] = encode(TYPE_COMMAND, i, STATUS_ACK);
+    }
+};
+
+bool equals(const char *data, int len, const char *text)
+{
+    const size_t n = strlen(text);
+    return len == static_cast<int>(n) && memcmp(data, text, n) == 0;
+}
+
+}
+
+uint16_t crc16(const char *data, int len)
+{
+    const uint16_t *table = crcTable().v;
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < len; i++)
+        crc = static_cast<uint16_t>((crc << 8) ^ table[((crc >> 8) ^ static_cast<uint8_t>(data[i])) & 0xFF]);
+    return crc;
+}
+
+int frameLength(const char *data, int len)
+{
+    if (!isFrame(data, len))
+        return -1;
+    if (len < HEADER_LEN)
+        return 0;
+
+    const int bodyLen = static_cast<uint8_t>(data[2]);
+    if (bodyLen < BODY_MIN || bodyLen > BODY_MAX)
+        return -1;
+    const int total = HEADER_LEN + bodyLen + CRC_LEN;
+    if (len < total)
+        return 0;
+
+    const uint16_t crc = crc16(data + 2, 1 + bodyLen);
+    const uint16_t expected = static_cast<uint16_t>((static_cast<uint8_t>(data[total - 2]) << 8)
+                                                    | static_cast<uint8_t>(data[total - 1]));
+    return crc == expected ? total : -1;
+}
+
+QByteArray encode(int type, int item, int status, const char *payload, int payloadLen)
+{
+    payloadLen = qBound(0, payloadLen, BODY_MAX - BODY_MIN);
+    const int bodyLen = BODY_MIN + payloadLen;
+    QByteArray frame(HEADER_LEN + bodyLen + CRC_LEN, '\0');
+    char *p = frame.data();
+    p[0] = static_cast<char>(SOF0);
+    p[1] = static_cast<char>(SOF1);
+    p[2] = static_cast<char>(bodyLen);
+    p[3] = static_cast<char>(type);
+    p[4] = static_cast<char>(item);
+    p[5] = static_cast<char>(status);
+    if (payloadLen > 0)
+        memcpy(p + HEADER_LEN + BODY_MIN, payload, static_cast<size_t>(payloadLen));
+    const uint16_t crc = crc16(p + 2, 1 + bodyLen);
+    p[HEADER_LEN + bodyLen] = static_cast<char>(crc >> 8);
+    p[HEADER_LEN + bodyLen + 1] = static_cast<char>(crc & 0xFF);
+    return frame;
+}
+
+const QByteArray &command(int item)
+{
+    static const CommandTable table;
+    return table.frames[item];
+}
+
+int itemOfCommand(const char *data, int len)
+{
+    if (frameLength(data, len) != len || frameType(data) != TYPE_COMMAND)
+        return -1;
+    const int item = frameItem(data);
+    return item < TEST_ITEMS_NUM ? item : -1;
+}
+
+bool isHello(const char *data, int len)
+{
+    return equals(data, len, kHello);
+}
+
+bool isHelloAck(const char *data, int len)
+{
+    return equals(data, len, kHelloAck);
+}
+
+}
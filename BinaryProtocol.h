@@ -0,0 +1,80 @@
+#ifndef BINARYPROTOCOL_H
+#define BINARYPROTOCOL_H
+
+#include <QByteArray>
+#include <cstdint>
+
+/*
+ * 可选的二进制帧协议, 与 ASCII "gz_test com" 命令二选一, 每次测试开始时协商:
+ *   主机发送 ASCII "gz_test proto bin1", 支持的固件回复 "gz_test proto ack bin1" 后本次测试改用二进制帧;
+ *   其他回复或 PROTO_NEGOTIATE_MS 内没有回复时继续使用 ASCII.
+ * 固件复位后回到 ASCII; 二进制模式下也要认识 ASCII 协商命令(不含帧头, 不会与二进制帧混淆).
+ *
+ *   A5 5A | len | type item status payload[len-3] | crc16
+ *
+ * len 为 type 到 payload 的字节数; crc16 为 CRC-16/CCITT-FALSE(多项式 0x1021, 初值 0xFFFF),
+ * 覆盖 len 到 payload, 高字节在前.
+ * 命令帧 type=01, status=00, 无 payload, 共 8 字节; 应答帧 type=02, status 00=ack 01=nack,
+ * nack 485 的 payload 为通道掩码(小端, 1~4 字节).
+ * 校验失败时跳过一个字节重新找帧头, 噪声之后的重新同步是确定的.
+ */
+namespace BinaryProtocol {
+
+enum {
+    SOF0 = 0xA5,
+    SOF1 = 0x5A,
+    HEADER_LEN = 3,     // 帧头 + len
+    CRC_LEN = 2,
+    BODY_MIN = 3,       // type item status
+    BODY_MAX = 64,
+    FRAME_MIN = HEADER_LEN + BODY_MIN + CRC_LEN,
+    FRAME_MAX = HEADER_LEN + BODY_MAX + CRC_LEN
+};
+
+enum FrameType {
+    TYPE_COMMAND = 0x01,
+    TYPE_ACK = 0x02
+};
+
+enum Status {
+    STATUS_ACK = 0x00,
+    STATUS_NACK = 0x01
+};
+
+// 协商命令和固件的确认应答(ASCII, 不含结束符)
+extern const char kHello[];
+extern const char kHelloAck[];
+
+uint16_t crc16(const char *data, int len);
+
+// data 以二进制帧头开始
+inline bool isFrame(const char *data, int len)
+{
+    return len >= 1 && static_cast<uint8_t>(data[0]) == SOF0
+           && (len < 2 || static_cast<uint8_t>(data[1]) == SOF1);
+}
+
+// data 开头的完整帧长度; 数据还不够一帧时返回 0, 不是帧头、长度非法或校验失败时返回 -1
+int frameLength(const char *data, int len);
+
+// 以下字段访问要求 frame 已通过 frameLength 校验
+inline int frameType(const char *frame) { return static_cast<uint8_t>(frame[3]); }
+inline int frameItem(const char *frame) { return static_cast<uint8_t>(frame[4]); }
+inline int frameStatus(const char *frame) { return static_cast<uint8_t>(frame[5]); }
+inline const char *framePayload(const char *frame) { return frame + HEADER_LEN + BODY_MIN; }
+inline int framePayloadLen(const char *frame) { return static_cast<uint8_t>(frame[2]) - BODY_MIN; }
+
+QByteArray encode(int type, int item, int status, const char *payload = nullptr, int payloadLen = 0);
+
+// 测试项 id 的命令帧, 第一次调用时生成, 之后直接复用
+const QByteArray &command(int item);
+
+// 命令帧对应的 TEST_IDX_*, 不是有效的命令帧时返回 -1
+int itemOfCommand(const char *data, int len);
+
+bool isHello(const char *data, int len);
+bool isHelloAck(const char *data, int len);
+
+}
+
+#endif // BINARYPROTOCOL_H
@@ -0,0 +1,150 @@
+#ifndef BYTERINGBUFFER_H
+#define BYTERINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+/*
+ * 单生产者/单消费者无锁字节环形缓冲区.
+ * 存储在构造时一次性分配(容量向上取整为2的幂), 之后读写均不分配内存.
+ * 生产者线程只调用 write/writableSpan/commitWrite/addDropped,
+ * 消费者线程只调用 read/readableSpan/consume/clear.
+ */
+class ByteRingBuffer
+{
+public:
+    explicit ByteRingBuffer(size_t capacity = 64 * 1024)
+        : m_capacity(roundUpPow2(capacity))
+        , m_mask(m_capacity - 1)
+        , m_data(new char[m_capacity])
+    {
+    }
+
+    ByteRingBuffer(const ByteRingBuffer &) = delete;
+    ByteRingBuffer &operator=(const ByteRingBuffer &) = delete;
+
+    size_t capacity() const { return m_capacity; }
+
+    // 当前排队字节数, 任一线程均可调用(近似值)
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    bool isEmpty() const { return size() == 0; }
+
+    // 自创建(或 resetStats)以来排队字节数的最大值
+    size_t highWaterMark() const { return m_highWater.load(std::memory_order_relaxed); }
+    // 缓冲区满时丢弃的字节数
+    unsigned long long droppedBytes() const { return m_dropped.load(std::memory_order_relaxed); }
+    void resetStats() {
+        m_highWater.store(size(), std::memory_order_relaxed);
+        m_dropped.store(0, std::memory_order_relaxed);
+    }
+
+    /* ---------------- 生产者 ---------------- */
+
+    // 返回可直接写入的连续空间, 写完后调用 commitWrite
+    size_t writableSpan(char **ptr) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t room = m_capacity - (head - tail);
+        const size_t offset = head & m_mask;
+        const size_t contiguous = m_capacity - offset;
+        *ptr = m_data.get() + offset;
+        return room < contiguous ? room : contiguous;
+    }
+
+    void commitWrite(size_t len) {
+        const size_t head = m_head.load(std::memory_order_relaxed) + len;
+        m_head.store(head, std::memory_order_release);
+
+        const size_t used = head - m_tail.load(std::memory_order_acquire);
+        if (used > m_highWater.load(std::memory_order_relaxed))
+            m_highWater.store(used, std::memory_order_relaxed);
+    }
+
+    // 拷贝写入, 返回实际写入的字节数; 放不下的部分计入 droppedBytes
+    size_t write(const char *data, size_t len) {
+        size_t written = 0;
+        while (written < len) {
+            char *span;
+            size_t room = writableSpan(&span);
+            if (room == 0)
+                break;
+            if (room > len - written)
+                room = len - written;
+            memcpy(span, data + written, room);
+            commitWrite(room);
+            written += room;
+        }
+        if (written < len)
+            addDropped(len - written);
+        return written;
+    }
+
+    void addDropped(size_t len) {
+        m_dropped.fetch_add(len, std::memory_order_relaxed);
+    }
+
+    /* ---------------- 消费者 ---------------- */
+
+    // 返回可直接读取的连续数据, 处理完后调用 consume
+    size_t readableSpan(const char **ptr) const {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t avail = head - tail;
+        const size_t offset = tail & m_mask;
+        const size_t contiguous = m_capacity - offset;
+        *ptr = m_data.get() + offset;
+        return avail < contiguous ? avail : contiguous;
+    }
+
+    void consume(size_t len) {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+    size_t read(char *dst, size_t len) {
+        size_t done = 0;
+        while (done < len) {
+            const char *span;
+            size_t avail = readableSpan(&span);
+            if (avail == 0)
+                break;
+            if (avail > len - done)
+                avail = len - done;
+            memcpy(dst + done, span, avail);
+            consume(avail);
+            done += avail;
+        }
+        return done;
+    }
+
+    // 丢弃所有未读数据
+    void clear() {
+        m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    static size_t roundUpPow2(size_t v) {
+        size_t n = 1;
+        while (n < v)
+            n <<= 1;
+        return n;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<char[]> m_data;
+
+    // 读写索引只增不减, 中间填充避免生产者和消费者伪共享同一缓存行
+    char m_pad0[64];
+    std::atomic<size_t> m_head{0};
+    char m_pad1[64];
+    std::atomic<size_t> m_tail{0};
+    char m_pad2[64];
+    std::atomic<size_t> m_highWater{0};
+    std::atomic<unsigned long long> m_dropped{0};
+};
+
+#endif // BYTERINGBUFFER_H
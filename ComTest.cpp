@@ -0,0 +1,425 @@
+#include "ComTest.h"
+#include "AckParser.h"
+#include "BinaryProtocol.h"
+#include "Logging.h"
+
+#include <cstring>
+
+namespace {
+
+// 各测试项的日志名和结果描述, 下标为 TEST_IDX_*
+// 默认超时: 调试串口只是回显, 板子不在线时尽快判定; 485/can 要逐通道收发, 给得宽一些
+struct TestItemText {
+    const char *name;
+    const char *logName;
+    const char *resultName;
+    int timeoutMs;
+};
+
+const TestItemText kItemText[TEST_ITEMS_NUM] = {
+    { "uart_debug", "debug com",    QT_TRANSLATE_NOOP("ComTest", "调试串口"),   1000 },
+    { "ethernet",   "ethernet com", QT_TRANSLATE_NOOP("ComTest", "以太网通信"), 3000 },
+    { "485",        "485 com",      QT_TRANSLATE_NOOP("ComTest", "485通信"),    5000 },
+    { "can",        "can com",      QT_TRANSLATE_NOOP("ComTest", "can通信"),    5000 },
+    { "pmbus",      "pmbus com",    QT_TRANSLATE_NOOP("ComTest", "pmbus通信"),  3000 },
+};
+
+// ASCII 命令只生成一次
+struct AsciiCommandTable {
+    QByteArray commands[TEST_ITEMS_NUM];
+
+    AsciiCommandTable()
+    {
+        for (int i = 0; i < TEST_ITEMS_NUM; i++)
+            commands[i] = ComTest::commandOf(i);
+    }
+};
+
+const QByteArray &asciiCommand(int id)
+{
+    static const AsciiCommandTable table;
+    return table.commands[id];
+}
+
+}
+
+ComTest::ComTest(QObject *parent)
+    : QObject(parent)
+{
+    m_tickTimer.setInterval(TEST_TICK_MS);
+    connect(&m_tickTimer, &QTimer::timeout, this, &ComTest::onTick);
+    m_deadlineTimer.setSingleShot(true);
+    m_deadlineTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_deadlineTimer, &QTimer::timeout, this, &ComTest::onDeadline);
+    for(int i = 0; i < TEST_ITEMS_NUM; i++ )
+        m_itemTimeoutMs[i] = kItemText[i].timeoutMs;
+
+    Reset();
+}
+
+ComTest::~ComTest(void)
+{
+
+}
+
+const char *ComTest::itemName(int id)
+{
+    return kItemText[id].name;
+}
+
+int ComTest::defaultItemTimeout(int id)
+{
+    return kItemText[id].timeoutMs;
+}
+
+void ComTest::setItemTimeout(int id, int ms)
+{
+    m_itemTimeoutMs[id] = qBound(TEST_TIMEOUT_MIN_MS, ms, TEST_TIMEOUT_MAX_MS);
+}
+
+const char *ComTest::attemptName(int attempt)
+{
+    static const char *const names[] = { "ack", "nack", "timeout" };
+    return names[attempt];
+}
+
+const char *ComTest::protocolName(int protocol)
+{
+    static const char *const names[] = { "ascii", "binary" };
+    return names[protocol];
+}
+
+int ComTest::itemOfCommand(const char *data, int len)
+{
+    if( BinaryProtocol::isFrame(data, len) )
+        return BinaryProtocol::itemOfCommand(data, len);
+
+    AckParser::Token tokens[3];
+    if( AckParser::tokenize(data, len, tokens, 3) < 3 )
+        return -1;
+    for(int i = 0; i < TEST_ITEMS_NUM; i++ ) {
+        if( AckParser::tokenEquals(tokens[2], kItemText[i].name, static_cast<int>(strlen(kItemText[i].name))) )
+            return i;
+    }
+    return -1;
+}
+
+QByteArray ComTest::commandOf(int id)
+{
+    return QByteArray("gz_test com ") + kItemText[id].name;
+}
+
+const QByteArray &ComTest::command(int id) const
+{
+    return m_protocol == GZ_PROTO_BINARY ? BinaryProtocol::command(id) : asciiCommand(id);
+}
+
+void ComTest::Test(void)
+{
+    if( m_running )
+        return;
+
+    Reset();
+    m_runId++;
+    m_running = true;
+    m_progressPart = 0;
+    m_progressCnt = 0;
+    m_cycleTimer.start();
+    m_protocol = GZ_PROTO_ASCII;
+
+    if( m_tryBinary ) {
+        // 先协商协议, 确认或超时后再发测试命令
+        m_negotiating = true;
+        emit sendData(QByteArray::fromRawData(BinaryProtocol::kHello, int(strlen(BinaryProtocol::kHello))));
+        m_deadlineTimer.start(PROTO_NEGOTIATE_MS);
+    } else {
+        startItems();
+    }
+    m_tickTimer.start();
+}
+
+void ComTest::startItems(void)
+{
+    if( m_pipelined ) {
+        // 各测试项互不依赖, 连续发出, 应答按测试项名称匹配
+        for(int i = 0; i < TEST_ITEMS_NUM; i++ )
+            emit sendData(command(i));
+        qCDebug(lcSequencer) << "pipelined test, all items sent";
+        armDeadline();
+    } else {
+        // 发送查询设备是否在线
+        sendStep(GZ_STEP_DEBUG_COM);
+    }
+}
+
+void ComTest::endNegotiation(bool binary)
+{
+    m_negotiating = false;
+    m_deadlineTimer.stop();
+    m_protocol = binary ? GZ_PROTO_BINARY : GZ_PROTO_ASCII;
+
+    QString log = binary ? QString("protocol: binary")
+                         : QString("binary protocol not supported, using ascii");
+    qCInfo(lcSequencer) << log;
+    emit logInfo(log);
+    GZ_TRACE(TRACE_PROTOCOL, m_traceId, m_protocol, 0);
+
+    startItems();
+}
+
+void ComTest::Abort(void)
+{
+    if( m_running )
+        finish(GZ_END_COM_TIMEOUT);
+}
+
+void ComTest::Fail(eTestEndResult result)
+{
+    if( m_running )
+        return;
+
+    Reset();
+    m_runId++;
+    m_running = true;
+    m_cycleTimer.start();
+    m_protocol = GZ_PROTO_ASCII;
+    finish(result);
+}
+
+void ComTest::sendStep(eTestStepDef step)
+{
+    m_step = step;
+    m_ack = GZ_ACK_NONE;
+    emit sendData(command(step));
+    qCDebug(lcSequencer) << "test step:" << step;
+    armDeadline();
+}
+
+/*
+ * 顺序模式下从发出命令开始计时当前测试项;
+ * 流水线模式下从上一次应答开始计时第一个未完成的测试项(固件按顺序处理命令),
+ * 每个测试项在前一项应答后都有自己完整的超时预算.
+ */
+void ComTest::armDeadline(void)
+{
+    if( m_pipelined ) {
+        m_waitItem = 0;
+        while( m_waitItem < TEST_ITEMS_NUM - 1 && m_done[m_waitItem] )
+            m_waitItem++;
+    } else {
+        m_waitItem = m_step;
+    }
+    m_deadlineTimer.start(m_itemTimeoutMs[m_waitItem]);
+}
+
+void ComTest::onTick(void)
+{
+    m_progressCnt++;
+    emit progress(m_progressPart, m_progressCnt);
+}
+
+void ComTest::onDeadline(void)
+{
+    if( m_running && m_negotiating ) {
+        endNegotiation(false);
+        return;
+    }
+    // 等待重发的项由重发时重新计时
+    if( !m_running || m_retryPending[m_waitItem] )
+        return;
+    // timeout, debug comm has problem
+    QString log = QString("%1 timeout after %2 ms").arg(kItemText[m_waitItem].logName).arg(m_itemTimeoutMs[m_waitItem]);
+    qCInfo(lcSequencer) << log;
+    emit logInfo(log);
+    GZ_TRACE(TRACE_TIMEOUT, m_traceId, m_waitItem, m_itemTimeoutMs[m_waitItem]);
+
+    m_attempts[m_waitItem].append(GZ_ATTEMPT_TIMEOUT);
+    if( scheduleRetry(m_waitItem) )
+        return;
+    finish(GZ_END_COM_TIMEOUT);
+}
+
+/*
+ * 只重发这一项, 尝试次数用完时返回 false.
+ * 顺序模式下序列停在该项; 流水线模式下其余项照常等待应答.
+ */
+bool ComTest::scheduleRetry(int item)
+{
+    const int attempts = m_attempts[item].size();
+    if( attempts >= m_maxAttempts )
+        return false;
+
+    const int backoff = TEST_RETRY_BACKOFF_MS << (attempts - 1);
+    m_retryPending[item] = true;
+    if( !m_pipelined )
+        m_deadlineTimer.stop();
+
+    QString log = QString("%1 retry %2/%3 in %4 ms").arg(kItemText[item].logName)
+            .arg(attempts).arg(m_maxAttempts - 1).arg(backoff);
+    qCInfo(lcSequencer) << log;
+    emit logInfo(log);
+    GZ_TRACE(TRACE_RETRY, m_traceId, item, attempts);
+
+    const quint32 runId = m_runId;
+    QTimer::singleShot(backoff, this, [this, item, runId]() {
+        if( !m_running || runId != m_runId )
+            return;
+        m_retryPending[item] = false;
+        if( m_pipelined ) {
+            emit sendData(command(item));
+            armDeadline();
+        } else {
+            sendStep(static_cast<eTestStepDef>(item));
+        }
+    });
+    return true;
+}
+
+void ComTest::handleAck(eTestAckDef ack)
+{
+    const int item = (ack - GZ_ACK_DEBUG_COM_SUCCESS) / 2;
+    const bool isSuccess = ((ack - GZ_ACK_DEBUG_COM_SUCCESS) % 2) == 0;
+
+    if( (m_pipelined ? m_done[item] : item != m_step) || m_retryPending[item] ) {
+        // 重复或迟到的应答, 不推进序列
+        qCDebug(lcSequencer) << "ack for item" << item << "while waiting for" << m_step << ", ignored";
+        return;
+    }
+
+    m_attempts[item].append(isSuccess ? GZ_ATTEMPT_PASS : GZ_ATTEMPT_NACK);
+    if( !isSuccess && scheduleRetry(item) )
+        return;
+
+    m_done[item] = true;
+    m_doneCnt++;
+    m_progressPart = m_doneCnt;
+    m_progressCnt = 0;
+    emit progress(m_progressPart, m_progressCnt);
+
+    QString log = QString("%1 %2").arg(kItemText[item].logName, isSuccess ? "success" : "failed");
+    if( !isSuccess && item == TEST_IDX_485 ) {
+        log += ", result:";
+        log += QString::number( m_result[TEST_IDX_485].result, 16);
+    }
+    qCDebug(lcSequencer) << log;
+    emit logInfo(log);
+
+    if( m_doneCnt == TEST_ITEMS_NUM ) {
+        // end
+        for(int i = 0; i < TEST_ITEMS_NUM; i++ ) {
+            if( m_result[i].isPass != true ) {
+                finish(GZ_END_FAILED);
+                return;
+            }
+        }
+        finish(GZ_END_SUCCESS);
+        return;
+    }
+
+    if( m_pipelined )
+        armDeadline();
+    else
+        sendStep( static_cast<eTestStepDef>(m_step + 1) );
+}
+
+void ComTest::appendResultInfo(int item)
+{
+    const bool isSuccess = m_result[item].isPass;
+
+    m_result_info.append("\r\n");
+    m_result_info.append(tr(kItemText[item].resultName));
+    m_result_info.append(isSuccess ? tr("  \t正常") : tr("  \t异常"));
+    if( m_attempts[item].size() > 1 ) {
+        QStringList attempts;
+        for( int attempt : m_attempts[item] )
+            attempts << attemptName(attempt);
+        m_result_info.append(tr("  (尝试%1次: %2)").arg(m_attempts[item].size()).arg(attempts.join(", ")));
+    }
+    if( !isSuccess && item == TEST_IDX_485 ) {
+        m_result_info.append(tr("\r\n(详情如下)："));
+        for(int i=0; i<8; i++) {
+            m_result_info.append(tr("\r\n\t通道"));
+            m_result_info.append( QString::number( (i+1), 10 ) );
+
+            uint8_t mask = 1<<i;
+            if(m_result[TEST_IDX_485].result & mask)
+                m_result_info.append(tr("正常"));
+            else
+                m_result_info.append(tr("异常"));
+        }
+    }
+}
+
+void ComTest::finish(eTestEndResult result)
+{
+    m_tickTimer.stop();
+    m_deadlineTimer.stop();
+    m_running = false;
+    m_negotiating = false;
+
+    // 结果按测试项顺序排列, 与应答到达顺序无关
+    for(int i = 0; i < TEST_ITEMS_NUM; i++ ) {
+        if( m_done[i] )
+            appendResultInfo(i);
+    }
+
+    const qint64 elapsed = m_cycleTimer.elapsed();
+    m_cycleMs = elapsed;
+    QString log = QString("cycle time %1 ms (%2)").arg(elapsed).arg(m_pipelined ? "pipelined" : "sequential");
+    if( result != GZ_END_COM_TIMEOUT ) {
+        m_lastCycleMs[m_pipelined ? 1 : 0] = elapsed;
+        const qint64 other = m_lastCycleMs[m_pipelined ? 0 : 1];
+        if( other >= 0 )
+            log += QString(", last %1 cycle %2 ms").arg(m_pipelined ? "sequential" : "pipelined").arg(other);
+    }
+    qCInfo(lcSequencer) << log;
+    emit logInfo(log);
+    GZ_TRACE(TRACE_FINISH, m_traceId, result, elapsed);
+
+    emit finished(result);
+}
+
+int ComTest::DealWithFrame(const char *data, int len)
+{
+    if( m_running && m_negotiating ) {
+        // 协商期间的任何应答都结束协商: 只有确认才用二进制, 旧固件的回显或 nack 立即回退
+        endNegotiation(BinaryProtocol::isHelloAck(data, len));
+        return FRAME_PROTOCOL;
+    }
+    if( BinaryProtocol::isHelloAck(data, len) )
+        return FRAME_PROTOCOL;
+
+    /* eg. data: gz_test com ack/nack uart_debug */
+    AckParser::ParsedAck ack;
+    if( !AckParser::parse(data, len, &ack) ) {
+        qCDebug(lcParser) << "err ack:" << QByteArray::fromRawData(data, len);
+        return -1;
+    }
+
+    // 只保存正在等待的项: 已判定、等待重发或(顺序模式下)还没发出的项不被迟到或多余的应答改写结果
+    if( m_running && (m_done[ack.id] || m_retryPending[ack.id] || (!m_pipelined && ack.id != m_step)) ) {
+        qCDebug(lcSequencer) << "ack for item" << ack.id << "while waiting for" << m_step << ", dropped";
+        return ack.id;
+    }
+
+    SaveResult(ack.id, ack.isPass, ack.result);
+    m_ack = ack.ack;
+
+    // 应答到达即推进序列, 不再等待下一个轮询周期
+    if( m_running )
+        handleAck(m_ack);
+    return ack.id;
+}
+
+void ComTest::DealWithAck( QString ackBuff )
+{
+    const QByteArray data = ackBuff.toLatin1();
+    DealWithFrame(data.constData(), data.size());
+}
+
+void ComTest::SaveResult(int id, bool isPass, uint32_t result)
+{
+    m_result[id].isPass = isPass;
+    if( !isPass && id == TEST_IDX_485 )
+        m_result[id].result = result;
+}
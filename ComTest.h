@@ -0,0 +1,205 @@
+#ifndef COMTEST_H
+#define COMTEST_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <cstdint>
+
+class ComTest : public QObject
+{
+    Q_OBJECT
+
+#define    TEST_ITEMS_NUM  5
+
+#define    MAX_FAIL_CNT    3    // 单项最多尝试次数(含第一次)
+
+#define    TEST_IDX_DEBUG_COM    0
+#define    TEST_IDX_ETHERNET     1
+#define    TEST_IDX_485          2
+#define    TEST_IDX_CAN          3
+#define    TEST_IDX_PMBUS        4
+
+#define    TEST_TICK_MS          200  // 进度刷新周期, 与超时判断无关
+#define    TEST_TIMEOUT_MIN_MS   20
+#define    TEST_TIMEOUT_MAX_MS   60000
+#define    TEST_RETRY_BACKOFF_MS 100  // 第一次重试前的等待, 之后每次加倍
+#define    PROTO_NEGOTIATE_MS    200  // 等待固件确认二进制协议, 超时按 ASCII 测试
+
+#define    FRAME_PROTOCOL        -2   // DealWithFrame: 协议协商应答, 不属于任何测试项
+
+public:
+    typedef enum _gz_test_step{
+        GZ_STEP_DEBUG_COM,
+        GZ_STEP_ETHERNET,
+        GZ_STEP_485,
+        GZ_STEP_CAN,
+        GZ_STEP_PMBUS
+    }eTestStepDef;
+    typedef enum _gz_test_ack_def{
+        GZ_ACK_NONE,
+        GZ_ACK_DEBUG_COM_SUCCESS,
+        GZ_ACK_DEBUG_COM_FAILED,
+        GZ_ACK_ETHERNET_SUCCESS,
+        GZ_ACK_ETHERNET_FAILED,
+        GZ_ACK_485_SUCCESS,
+        GZ_ACK_485_FAILED,
+        GZ_ACK_CAN_SUCCESS,
+        GZ_ACK_CAN_FAILED,
+        GZ_ACK_PMBUS_SUCCESS,
+        GZ_ACK_PMBUS_FAILED
+    }eTestAckDef;
+    Q_ENUM(eTestAckDef)
+
+    typedef struct {
+        bool isPass;
+        uint32_t result;
+    }eTestDetailDef;
+
+    // 单项每次尝试的结果
+    typedef enum _gz_test_attempt {
+        GZ_ATTEMPT_PASS,
+        GZ_ATTEMPT_NACK,
+        GZ_ATTEMPT_TIMEOUT
+    }eTestAttemptDef;
+
+    typedef enum _gz_test_end {
+        GZ_END_SUCCESS,
+        GZ_END_FAILED,
+        GZ_END_COM_TIMEOUT
+    }eTestEndResult;
+
+    typedef enum _gz_test_protocol {
+        GZ_PROTO_ASCII,
+        GZ_PROTO_BINARY
+    }eProtocolDef;
+
+public:
+    explicit ComTest(QObject *parent = nullptr);
+    ~ComTest();
+
+    bool isRunning(void) const { return m_running; }
+    const QString &resultInfo(void) const { return m_result_info; }
+
+    // 流水线模式: 一次性发出所有测试命令, 按应答中的测试项名称匹配结果
+    void setPipelined(bool pipelined) { m_pipelined = pipelined; }
+    bool isPipelined(void) const { return m_pipelined; }
+    // 二进制协议: 每次测试开始时先与固件协商, 固件不支持时本次测试回退到 ASCII
+    void setBinaryProtocol(bool binary) { m_tryBinary = binary; }
+    bool isBinaryProtocol(void) const { return m_tryBinary; }
+    // 本次(或上一次)测试实际使用的协议
+    eProtocolDef protocol(void) const { return m_protocol; }
+    static const char *protocolName(int protocol);
+    // 上一次完整测试的用时(ms), 按模式分别记录, 没有记录时为 -1
+    qint64 lastCycleTime(bool pipelined) const { return m_lastCycleMs[pipelined ? 1 : 0]; }
+    // 上一次测试(含超时)的用时(ms)
+    qint64 cycleTime(void) const { return m_cycleMs; }
+
+    // 各测试项的结果, id 为 TEST_IDX_*
+    static const char *itemName(int id);
+    // 测试命令 "gz_test com <item>" 或二进制命令帧对应的 TEST_IDX_*, 不是测试命令时返回 -1
+    static int itemOfCommand(const char *data, int len);
+    // 测试项 id 的 ASCII 命令 "gz_test com <item>"
+    static QByteArray commandOf(int id);
+    // 测试项 id 在当前协议下的命令, 预先生成, 发送时不再转换
+    const QByteArray &command(int id) const;
+
+    // 各测试项等待应答的超时(ms), 限制在 TEST_TIMEOUT_MIN_MS ~ TEST_TIMEOUT_MAX_MS
+    static int defaultItemTimeout(int id);
+    void setItemTimeout(int id, int ms);
+    int itemTimeout(int id) const { return m_itemTimeoutMs[id]; }
+
+    // nack 或超时的测试项单独重发, 最多尝试 attempts 次, 已通过的项不会重复; 1 表示不重试
+    void setMaxAttempts(int attempts) { m_maxAttempts = qMax(1, attempts); }
+    int maxAttempts(void) const { return m_maxAttempts; }
+    // 各测试项本次测试的全部尝试记录(eTestAttemptDef)
+    const QVector<int> &itemAttempts(int id) const { return m_attempts[id]; }
+    static const char *attemptName(int attempt);
+
+    // 写入跟踪环时的工位编号
+    void setTraceId(quint16 id) { m_traceId = id; }
+    bool isItemDone(int id) const { return m_done[id]; }
+    const eTestDetailDef &itemResult(int id) const { return m_result[id]; }
+
+    // 解析器交出的一帧应答(不含结束符), 返回应答的测试项 TEST_IDX_*, 无法解析时返回 -1,
+    // 协商应答返回 FRAME_PROTOCOL
+    int DealWithFrame(const char *data, int len);
+
+public slots:
+    // 启动测试序列后立即返回, 结束时发出 finished(eTestEndResult)
+    void Test(void);
+    void Abort(void);
+    // 测试序列还没开始就失败(如网口连不上): 按没有任何应答结束, 同样发出 finished
+    void Fail(eTestEndResult result);
+    void DealWithAck( QString ackBuff );
+    void SaveResult(int id, bool isPass, uint32_t result);
+    void Reset(void) {
+        m_ack = GZ_ACK_NONE;
+        m_result_info = "\r\n结果如下:\r\n";
+        m_doneCnt = 0;
+        for(int i=0; i<TEST_ITEMS_NUM; i++) {
+            m_result[i].isPass = false;
+            m_result[i].result = 0;
+            m_done[i] = false;
+            m_retryPending[i] = false;
+            m_attempts[i].clear();
+        }
+    }
+signals:
+    void sendData(QByteArray data);
+    void progress(int part, int cnt);
+    void logInfo(const QString &message);
+    void finished(int result);
+
+private slots:
+    void onTick(void);
+    void onDeadline(void);
+
+private:
+    void startItems(void);
+    void endNegotiation(bool binary);
+    void sendStep(eTestStepDef step);
+    void armDeadline(void);
+    bool scheduleRetry(int item);
+    void handleAck(eTestAckDef ack);
+    void finish(eTestEndResult result);
+    void appendResultInfo(int item);
+
+private:
+    friend class Widget;
+
+    eTestAckDef m_ack = GZ_ACK_NONE;
+    eTestDetailDef m_result[TEST_ITEMS_NUM];
+    QString m_result_info = "\r\n结果如下:\r\n";
+
+    int m_testItemsNum = TEST_ITEMS_NUM;
+    bool m_tryBinary = false;
+    bool m_negotiating = false;
+    eProtocolDef m_protocol = GZ_PROTO_ASCII;
+
+    // 序列状态: 等待应答期间只由定时器唤醒, 不占用CPU
+    QTimer m_tickTimer;
+    QTimer m_deadlineTimer;
+    int m_itemTimeoutMs[TEST_ITEMS_NUM];
+    int m_waitItem = 0;  // 当前超时计时对应的测试项
+    int m_maxAttempts = MAX_FAIL_CNT;
+    QVector<int> m_attempts[TEST_ITEMS_NUM];
+    bool m_retryPending[TEST_ITEMS_NUM];  // 等待重发, 期间的应答不处理
+    quint32 m_runId = 0;  // 区分已结束测试的重发定时
+    quint16 m_traceId = 0;
+    eTestStepDef m_step = GZ_STEP_DEBUG_COM;
+    bool m_running = false;
+    int m_progressPart = 0;
+    int m_progressCnt = 0;
+
+    bool m_pipelined = false;
+    bool m_done[TEST_ITEMS_NUM];  // 已收到应答的测试项
+    int m_doneCnt = 0;
+    QElapsedTimer m_cycleTimer;
+    qint64 m_lastCycleMs[2] = { -1, -1 };
+    qint64 m_cycleMs = -1;
+};
+
+#endif // COMTEST_H
@@ -0,0 +1,528 @@
+#include "ControlServer.h"
+#include "TestStation.h"
+#include "ComTest.h"
+#include "PortMonitor.h"
+#include "ResultStore.h"
+#include "Logging.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtSerialPort/QSerialPortInfo>
+
+namespace {
+
+const char *const kStateNames[] = { "idle", "running", "done" };
+
+}
+
+ControlServer::ControlServer(QObject *parent)
+    : QObject(parent)
+{
+    m_methods.insert("ports.list", &ControlServer::rpcPortsList);
+    m_methods.insert("test.start", &ControlServer::rpcTestStart);
+    m_methods.insert("test.run", &ControlServer::rpcTestRun);
+    m_methods.insert("test.status", &ControlServer::rpcTestStatus);
+    m_methods.insert("test.abort", &ControlServer::rpcTestAbort);
+    m_methods.insert("events.subscribe", &ControlServer::rpcSubscribe);
+    m_methods.insert("results.query", &ControlServer::rpcResultsQuery);
+}
+
+ControlServer::~ControlServer()
+{
+    if (m_portMonitor != nullptr)
+        disconnect(m_portMonitor, nullptr, this, nullptr);
+    for (TestStation *station : m_watched)
+        disconnect(station, nullptr, this, nullptr);
+    qDeleteAll(m_ownStations);
+    for (Client *client : m_clients) {
+        disconnect(client->device, nullptr, this, nullptr);
+        delete client;
+    }
+}
+
+void ControlServer::setPortMonitor(PortMonitor *monitor)
+{
+    if (m_portMonitor != nullptr)
+        disconnect(m_portMonitor, nullptr, this, nullptr);
+    m_portMonitor = monitor;
+    if (m_portMonitor != nullptr)
+        connect(m_portMonitor, &PortMonitor::probeFinished, this, &ControlServer::onProbeFinished);
+}
+
+bool ControlServer::listenTcp(quint16 port, const QHostAddress &address)
+{
+    if (m_tcpServer == nullptr) {
+        m_tcpServer = new QTcpServer(this);
+        connect(m_tcpServer, &QTcpServer::newConnection, this, &ControlServer::onTcpConnection);
+    }
+    if (!m_tcpServer->listen(address, port)) {
+        m_errorString = m_tcpServer->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ControlServer::listenLocal(const QString &name)
+{
+    if (m_localServer == nullptr) {
+        m_localServer = new QLocalServer(this);
+        connect(m_localServer, &QLocalServer::newConnection, this, &ControlServer::onLocalConnection);
+    }
+    // 上次异常退出留下的套接字文件
+    QLocalServer::removeServer(name);
+    if (!m_localServer->listen(name)) {
+        m_errorString = m_localServer->errorString();
+        return false;
+    }
+    return true;
+}
+
+quint16 ControlServer::tcpPort(void) const
+{
+    return m_tcpServer != nullptr ? m_tcpServer->serverPort() : 0;
+}
+
+void ControlServer::onTcpConnection(void)
+{
+    while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        Client *client = addClient(socket);
+        connect(socket, &QTcpSocket::disconnected, this, [this, client]() {
+            removeClient(client);
+        });
+    }
+}
+
+void ControlServer::onLocalConnection(void)
+{
+    while (QLocalSocket *socket = m_localServer->nextPendingConnection()) {
+        Client *client = addClient(socket);
+        connect(socket, &QLocalSocket::disconnected, this, [this, client]() {
+            removeClient(client);
+        });
+    }
+}
+
+ControlServer::Client *ControlServer::addClient(QIODevice *device)
+{
+    Client *client = new Client;
+    client->device = device;
+    m_clients.append(client);
+    connect(device, &QIODevice::readyRead, this, [this, client]() {
+        readClient(client);
+    });
+    qCDebug(lcUi) << "control client connected, total" << m_clients.size();
+    return client;
+}
+
+void ControlServer::removeClient(Client *client)
+{
+    if (!m_clients.removeOne(client))
+        return;
+    // 等待结果的请求没有人接收了, 测试本身照常进行
+    for (auto it = m_pendingRuns.begin(); it != m_pendingRuns.end(); ++it) {
+        QList<PendingRun> &runs = it.value();
+        for (int i = runs.size() - 1; i >= 0; i--) {
+            if (runs.at(i).client == client)
+                runs.removeAt(i);
+        }
+    }
+    for (auto it = m_deferredStarts.begin(); it != m_deferredStarts.end(); ++it) {
+        QList<DeferredStart> &starts = it.value();
+        for (int i = starts.size() - 1; i >= 0; i--) {
+            if (starts.at(i).client == client)
+                starts.removeAt(i);
+        }
+    }
+    for (auto it = m_pendingQueries.begin(); it != m_pendingQueries.end();) {
+        if (it.value().client == client)
+            it = m_pendingQueries.erase(it);
+        else
+            ++it;
+    }
+    disconnect(client->device, nullptr, this, nullptr);
+    client->device->deleteLater();
+    delete client;
+    qCDebug(lcUi) << "control client disconnected, total" << m_clients.size();
+}
+
+void ControlServer::readClient(Client *client)
+{
+    client->buffer.append(client->device->readAll());
+    int from = 0;
+    int end;
+    while ((end = client->buffer.indexOf('\n', from)) >= 0) {
+        const QByteArray line = client->buffer.mid(from, end - from).trimmed();
+        from = end + 1;
+        if (!line.isEmpty())
+            handleLine(client, line);
+    }
+    client->buffer.remove(0, from);
+
+    if (client->buffer.size() > CONTROL_MAX_LINE) {
+        client->buffer.clear();
+        replyError(client, QJsonValue(QJsonValue::Null), RPC_INVALID_REQUEST, "request too long");
+    }
+}
+
+void ControlServer::handleLine(Client *client, const QByteArray &line)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        replyError(client, QJsonValue(QJsonValue::Null), RPC_PARSE_ERROR, "parse error");
+        return;
+    }
+
+    const QJsonObject request = doc.object();
+    // 不带 id 的请求是通知, 照常执行但不应答
+    const QJsonValue id = request.value("id");
+    const QJsonValue method = request.value("method");
+    if (!method.isString()) {
+        replyError(client, id.isUndefined() ? QJsonValue(QJsonValue::Null) : id, RPC_INVALID_REQUEST, "invalid request");
+        return;
+    }
+    const QJsonValue params = request.value("params");
+    if (!params.isUndefined() && !params.isObject()) {
+        replyError(client, id, RPC_INVALID_PARAMS, "params must be an object");
+        return;
+    }
+
+    const Method handler = m_methods.value(method.toString(), nullptr);
+    if (handler == nullptr) {
+        replyError(client, id, RPC_METHOD_NOT_FOUND, QString("method not found: %1").arg(method.toString()));
+        return;
+    }
+    (this->*handler)(client, id, params.toObject());
+}
+
+void ControlServer::send(Client *client, const QJsonObject &message, bool droppable)
+{
+    if (droppable && client->device->bytesToWrite() > CONTROL_MAX_BACKLOG) {
+        m_droppedEvents++;
+        return;
+    }
+    QByteArray data = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    data.append('\n');
+    client->device->write(data);
+}
+
+void ControlServer::reply(Client *client, const QJsonValue &id, const QJsonValue &result)
+{
+    if (id.isUndefined())
+        return;
+    QJsonObject message;
+    message["jsonrpc"] = "2.0";
+    message["id"] = id;
+    message["result"] = result;
+    send(client, message);
+}
+
+void ControlServer::replyError(Client *client, const QJsonValue &id, int code, const QString &text)
+{
+    if (id.isUndefined())
+        return;
+    QJsonObject error;
+    error["code"] = code;
+    error["message"] = text;
+    QJsonObject message;
+    message["jsonrpc"] = "2.0";
+    message["id"] = id;
+    message["error"] = error;
+    send(client, message);
+}
+
+void ControlServer::notify(const QString &portName, const char *method, const QJsonObject &params, bool droppable)
+{
+    QJsonObject message;
+    message["jsonrpc"] = "2.0";
+    message["method"] = method;
+    message["params"] = params;
+    for (Client *client : m_clients) {
+        if (client->allEvents || client->ports.contains(portName))
+            send(client, message, droppable);
+    }
+}
+
+TestStation *ControlServer::findStation(const QString &portName) const
+{
+    for (TestStation *station : m_watched) {
+        if (station->portName() == portName)
+            return station;
+    }
+    return nullptr;
+}
+
+TestStation *ControlServer::stationFor(const QString &portName)
+{
+    TestStation *station = nullptr;
+    if (m_stationProvider) {
+        station = m_stationProvider(portName);
+    } else {
+        station = m_ownStations.value(portName, nullptr);
+        if (station == nullptr) {
+            station = new TestStation(portName);
+            station->setLatencyStats(m_latencyStats);
+            station->setResultStore(m_resultStore);
+            m_ownStations.insert(portName, station);
+        }
+    }
+    if (station != nullptr)
+        watchStation(station);
+    return station;
+}
+
+void ControlServer::watchStation(TestStation *station)
+{
+    if (m_watched.contains(station))
+        return;
+    m_watched.append(station);
+
+    connect(station, &TestStation::finished, this, [this, station]() {
+        onStationFinished(station);
+    });
+    // 工位由提供者删除时不再跟踪
+    connect(station, &QObject::destroyed, this, [this, station]() {
+        m_watched.removeOne(station);
+        m_pendingRuns.remove(station);
+        m_refresher.unwatch(station);
+    });
+    const QString portName = station->portName();
+    m_refresher.watch(station, [this, portName](const StationSnapshot &snapshot) {
+        if (snapshot.state != StationSnapshot::RUNNING)
+            return;
+        QJsonObject params;
+        params["port"] = portName;
+        params["part"] = snapshot.part;
+        params["cnt"] = snapshot.cnt;
+        notify(portName, "test.progress", params, true);
+    });
+}
+
+void ControlServer::onStationFinished(TestStation *station)
+{
+    const QJsonObject result = station->resultJson();
+    for (const PendingRun &run : m_pendingRuns.take(station))
+        reply(run.client, run.id, result);
+    notify(station->portName(), "test.finished", result);
+}
+
+void ControlServer::startTest(Client *client, const QJsonValue &id, const QJsonObject &params, bool waitResult)
+{
+    const QString portName = params.value("port").toString().trimmed();
+    if (portName.isEmpty()) {
+        replyError(client, id, RPC_INVALID_PARAMS, "missing port");
+        return;
+    }
+    TestStation *station = stationFor(portName);
+    if (station == nullptr) {
+        replyError(client, id, RPC_OPEN_FAILED, QString("no station for %1").arg(portName));
+        return;
+    }
+    if (station->isRunning()) {
+        replyError(client, id, RPC_PORT_BUSY, QString("%1 is running").arg(portName));
+        return;
+    }
+    if (m_portMonitor != nullptr && m_portMonitor->isProbing(portName)) {
+        // 探测只收发一条命令, 最多 PORT_PROBE_TIMEOUT_MS; 同时打开会抢端口或收到探测的应答
+        DeferredStart deferred;
+        deferred.client = client;
+        deferred.id = id;
+        deferred.params = params;
+        deferred.waitResult = waitResult;
+        m_deferredStarts[portName].append(deferred);
+        qCDebug(lcUi) << portName << "probing, start deferred";
+        return;
+    }
+
+    // 每块板的板号不同, 不带时清空, 不沿用上一块板的
+    station->setBoardSerial(params.value("serial").toString());
+    if (params.contains("pipelined"))
+        station->comTest()->setPipelined(params.value("pipelined").toBool());
+    if (params.contains("binary"))
+        station->comTest()->setBinaryProtocol(params.value("binary").toBool());
+    if (params.contains("attempts"))
+        station->comTest()->setMaxAttempts(params.value("attempts").toInt(MAX_FAIL_CNT));
+
+    client->ports.insert(portName);
+    if (!station->start()) {
+        replyError(client, id, RPC_OPEN_FAILED, QString("open %1 failed").arg(portName));
+        return;
+    }
+    m_refresher.wake();
+    emit testStarted(portName);
+    emit logInfo(QString("[%1] 控制接口开始测试").arg(portName));
+
+    QJsonObject started;
+    started["port"] = portName;
+    notify(portName, "test.started", started);
+
+    if (!waitResult) {
+        reply(client, id, started);
+    } else if (!id.isUndefined()) {
+        PendingRun run;
+        run.client = client;
+        run.id = id;
+        m_pendingRuns[station].append(run);
+    }
+}
+
+void ControlServer::onProbeFinished(const QString &portName)
+{
+    // 同一端口多个请求时第一个开始测试, 其余按 PORT_BUSY 应答
+    for (const DeferredStart &deferred : m_deferredStarts.take(portName))
+        startTest(deferred.client, deferred.id, deferred.params, deferred.waitResult);
+}
+
+void ControlServer::rpcPortsList(Client *client, const QJsonValue &id, const QJsonObject &params)
+{
+    Q_UNUSED(params);
+    QStringList ports;
+    if (m_portLister) {
+        ports = m_portLister();
+    } else {
+        for (const QSerialPortInfo &info : QSerialPortInfo::availablePorts())
+            ports << info.portName();
+    }
+    QJsonObject result;
+    result["ports"] = QJsonArray::fromStringList(ports);
+    reply(client, id, result);
+}
+
+void ControlServer::rpcTestStart(Client *client, const QJsonValue &id, const QJsonObject &params)
+{
+    startTest(client, id, params, false);
+}
+
+void ControlServer::rpcTestRun(Client *client, const QJsonValue &id, const QJsonObject &params)
+{
+    startTest(client, id, params, true);
+}
+
+void ControlServer::rpcTestStatus(Client *client, const QJsonValue &id, const QJsonObject &params)
+{
+    const QString portName = params.value("port").toString().trimmed();
+    if (portName.isEmpty()) {
+        replyError(client, id, RPC_INVALID_PARAMS, "missing port");
+        return;
+    }
+
+    QJsonObject result;
+    result["port"] = portName;
+    TestStation *station = findStation(portName);
+    if (station == nullptr) {
+        result["state"] = kStateNames[StationSnapshot::IDLE];
+        reply(client, id, result);
+        return;
+    }
+    const StationSnapshot snapshot = station->snapshot();
+    result["state"] = kStateNames[snapshot.state];
+    result["part"] = snapshot.part;
+    result["cnt"] = snapshot.cnt;
+    if (station->lastResult() >= 0)
+        result["last"] = station->resultJson();
+    reply(client, id, result);
+}
+
+void ControlServer::rpcTestAbort(Client *client, const QJsonValue &id, const QJsonObject &params)
+{
+    const QString portName = params.value("port").toString().trimmed();
+    TestStation *station = findStation(portName);
+    const bool running = station != nullptr && station->isRunning();
+    // 结果照常以 test.finished 和 test.run 的应答返回
+    if (running)
+        station->abort();
+    QJsonObject result;
+    result["port"] = portName;
+    result["aborted"] = running;
+    reply(client, id, result);
+}
+
+void ControlServer::rpcSubscribe(Client *client, const QJsonValue &id, const QJsonObject &params)
+{
+    const QJsonArray ports = params.value("ports").toArray();
+    if (ports.isEmpty())
+        client->allEvents = true;
+    for (const QJsonValue &port : ports)
+        client->ports.insert(port.toString().trimmed());
+
+    QJsonObject result;
+    result["all"] = client->allEvents;
+    // QSet::toList 自 Qt 5.14 起已弃用, 直接逐个放入
+    QJsonArray subscribed;
+    for (const QString &port : client->ports)
+        subscribed.append(port);
+    result["ports"] = subscribed;
+    reply(client, id, result);
+}
+
+void ControlServer::rpcResultsQuery(Client *client, const QJsonValue &id, const QJsonObject &params)
+{
+    if (m_resultStore == nullptr || !m_resultStore->isOpen()) {
+        replyError(client, id, RPC_NO_RESULT_STORE, "results database not enabled");
+        return;
+    }
+    // 默认最近 24 小时
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 to = static_cast<qint64>(params.value("to").toDouble(static_cast<double>(now + 1)));
+    const qint64 from = static_cast<qint64>(params.value("from").toDouble(static_cast<double>(to - 24 * 3600 * 1000LL)));
+    const int limit = qBound(1, params.value("limit").toInt(100), 10000);
+
+    // 在结果库的后台线程中查询, 不阻塞其他请求和界面; 客户端在结果回来之前断开时丢弃
+    const quint64 query = ++m_lastQueryId;
+    PendingRun pending;
+    pending.client = client;
+    pending.id = id;
+    m_pendingQueries.insert(query, pending);
+    m_resultStore->queryAsync(params.value("serial").toString(), from, to, limit, this,
+                              [this, query](const QVector<RunRecord> &runs) {
+        onQueryFinished(query, runs);
+    });
+}
+
+void ControlServer::onQueryFinished(quint64 query, const QVector<RunRecord> &found)
+{
+    static const char *const resultNames[] = { "success", "failed", "timeout" };
+
+    const PendingRun pending = m_pendingQueries.take(query);
+    if (pending.client == nullptr)
+        return;
+
+    QJsonArray runs;
+    for (const RunRecord &run : found) {
+        QJsonArray items;
+        for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+            QJsonObject item;
+            item["name"] = ComTest::itemName(i);
+            item["done"] = run.done[i];
+            item["pass"] = run.pass[i];
+            item["attempts"] = run.attempts[i];
+            item["rtt_ms"] = run.rttUs[i] >= 0 ? QJsonValue(run.rttUs[i] / 1000.0) : QJsonValue();
+            items.append(item);
+        }
+        QJsonObject json;
+        json["id"] = run.id;
+        json["serial"] = run.serial;
+        json["port"] = run.port;
+        json["started_at"] = run.startedAt;
+        if (run.result >= 0 && run.result <= ComTest::GZ_END_COM_TIMEOUT)
+            json["result"] = resultNames[run.result];
+        json["code"] = run.result;
+        json["pipelined"] = run.pipelined;
+        json["protocol"] = ComTest::protocolName(run.protocol);
+        json["cycle_ms"] = run.cycleMs;
+        json["mask_485"] = static_cast<qint64>(run.mask485);
+        if (!run.capture.isEmpty())
+            json["capture"] = run.capture;
+        json["items"] = items;
+        runs.append(json);
+    }
+    QJsonObject result;
+    result["runs"] = runs;
+    reply(pending.client, pending.id, result);
+}
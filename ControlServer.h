@@ -0,0 +1,158 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "UiRefresher.h"
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+class LatencyStats;
+class PortMonitor;
+class ResultStore;
+class TestStation;
+struct RunRecord;
+
+/*
+ * 供产线控制器(MES)调用的本地控制接口: JSON-RPC 2.0, 每行一个 JSON 对象,
+ * 监听本机 TCP 端口和/或本地套接字(Unix socket / Windows 命名管道). 方法:
+ *   ports.list                              可用端口
+ *   test.start  {port, serial, pipelined, binary, attempts}   开始测试, 立即返回
+ *   test.run    {同上}                      开始测试, 结束时返回结果和各项详情(TestStation::resultJson)
+ *   test.status {port}                      当前进度和上一次结果
+ *   test.abort  {port}                      中止测试
+ *   events.subscribe {ports}                订阅这些端口(不带时为全部)的事件
+ *   results.query {serial, from, to, limit} 按板号和时间(ms)查询结果库, 需要 setResultStore;
+ *                                           在结果库的后台线程中查询, 查完再应答
+ * 服务端通知: test.started / test.progress(按帧率合并) / test.finished.
+ * 开始测试的连接自动订阅该端口; 端口正在被热插拔探测时, 探测结束后才开始.
+ * 所有请求都在事件循环中即时处理, 不等待测试,
+ * 各工位的收发在自己的IO线程中进行; 客户端读得慢时丢弃它的进度通知, 应答和结果不丢.
+ */
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+#define    CONTROL_MAX_LINE        65536
+#define    CONTROL_MAX_BACKLOG     (1024 * 1024)
+
+#define    RPC_PARSE_ERROR         -32700
+#define    RPC_INVALID_REQUEST     -32600
+#define    RPC_METHOD_NOT_FOUND    -32601
+#define    RPC_INVALID_PARAMS      -32602
+#define    RPC_PORT_BUSY           -32000
+#define    RPC_OPEN_FAILED         -32001
+#define    RPC_NO_RESULT_STORE     -32002
+
+public:
+    typedef std::function<TestStation *(const QString &portName)> StationProvider;
+    typedef std::function<QStringList()> PortLister;
+
+    explicit ControlServer(QObject *parent = nullptr);
+    ~ControlServer();
+
+    // 只应监听本机地址, 接口没有鉴权
+    bool listenTcp(quint16 port, const QHostAddress &address = QHostAddress::LocalHost);
+    bool listenLocal(const QString &name);
+    quint16 tcpPort(void) const;
+    QString errorString(void) const { return m_errorString; }
+
+    // 按端口名取工位, 不设置时由服务自己创建并持有; 界面把自己的多工位会话交给服务, 两边看到同一个工位
+    void setStationProvider(StationProvider provider) { m_stationProvider = std::move(provider); }
+    // 不设置时枚举串口
+    void setPortLister(PortLister lister) { m_portLister = std::move(lister); }
+    // 服务自己创建的工位使用
+    void setLatencyStats(LatencyStats *stats) { m_latencyStats = stats; }
+    // 服务自己创建的工位把结果写入 store; 同时供 results.query 查询
+    void setResultStore(ResultStore *store) { m_resultStore = store; }
+    // 开始测试前检查端口是否正在被探测, 为 nullptr 时不检查
+    void setPortMonitor(PortMonitor *monitor);
+
+    int clientCount(void) const { return m_clients.size(); }
+    quint64 droppedEvents(void) const { return m_droppedEvents; }
+
+signals:
+    void testStarted(const QString &portName);
+    void logInfo(const QString &message);
+
+private slots:
+    void onTcpConnection(void);
+    void onLocalConnection(void);
+
+private:
+    struct Client {
+        QIODevice *device;
+        QByteArray buffer;
+        bool allEvents = false;
+        QSet<QString> ports;
+    };
+    struct PendingRun {
+        Client *client = nullptr;
+        QJsonValue id;
+    };
+    // 等端口探测结束的 test.start / test.run
+    struct DeferredStart {
+        Client *client;
+        QJsonValue id;
+        QJsonObject params;
+        bool waitResult;
+    };
+    typedef void (ControlServer::*Method)(Client *client, const QJsonValue &id, const QJsonObject &params);
+
+    Client *addClient(QIODevice *device);
+    void removeClient(Client *client);
+    void readClient(Client *client);
+    void handleLine(Client *client, const QByteArray &line);
+
+    void send(Client *client, const QJsonObject &message, bool droppable = false);
+    void reply(Client *client, const QJsonValue &id, const QJsonValue &result);
+    void replyError(Client *client, const QJsonValue &id, int code, const QString &message);
+    void notify(const QString &portName, const char *method, const QJsonObject &params, bool droppable = false);
+
+    TestStation *stationFor(const QString &portName);
+    TestStation *findStation(const QString &portName) const;
+    void watchStation(TestStation *station);
+    void onStationFinished(TestStation *station);
+    void startTest(Client *client, const QJsonValue &id, const QJsonObject &params, bool waitResult);
+    void onProbeFinished(const QString &portName);
+
+    void rpcPortsList(Client *client, const QJsonValue &id, const QJsonObject &params);
+    void rpcTestStart(Client *client, const QJsonValue &id, const QJsonObject &params);
+    void rpcTestRun(Client *client, const QJsonValue &id, const QJsonObject &params);
+    void rpcTestStatus(Client *client, const QJsonValue &id, const QJsonObject &params);
+    void rpcTestAbort(Client *client, const QJsonValue &id, const QJsonObject &params);
+    void rpcSubscribe(Client *client, const QJsonValue &id, const QJsonObject &params);
+    void rpcResultsQuery(Client *client, const QJsonValue &id, const QJsonObject &params);
+    void onQueryFinished(quint64 query, const QVector<RunRecord> &found);
+
+private:
+    QTcpServer *m_tcpServer = nullptr;
+    QLocalServer *m_localServer = nullptr;
+    QString m_errorString;
+    QList<Client *> m_clients;
+    QHash<QString, Method> m_methods;
+    StationProvider m_stationProvider;
+    PortLister m_portLister;
+    LatencyStats *m_latencyStats = nullptr;
+    ResultStore *m_resultStore = nullptr;
+    PortMonitor *m_portMonitor = nullptr;
+    QHash<QString, QList<DeferredStart>> m_deferredStarts;
+    QHash<QString, TestStation *> m_ownStations;
+    QList<TestStation *> m_watched;
+    QHash<TestStation *, QList<PendingRun>> m_pendingRuns;
+    QHash<quint64, PendingRun> m_pendingQueries;  // 等待结果库返回的 results.query
+    quint64 m_lastQueryId = 0;
+    UiRefresher m_refresher;  // 进度通知与界面一样按帧率合并
+    quint64 m_droppedEvents = 0;
+};
+
+#endif // CONTROLSERVER_H
@@ -0,0 +1,180 @@
+#include "FrameParser.h"
+#include "ByteRingBuffer.h"
+#include "BinaryProtocol.h"
+
+#include <cstring>
+
+namespace {
+
+const char kHeader[] = "gz_test";
+const int kHeaderLen = sizeof(kHeader) - 1;
+
+inline bool isDelimiter(char c)
+{
+    return c == '\r' || c == '\n' || c == '\0';
+}
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\0';
+}
+
+}
+
+FrameParser::FrameParser(int maxFrameLen)
+    : m_pending(new char[maxFrameLen * 2])
+    , m_capacity(maxFrameLen * 2)
+{
+}
+
+FrameParser::~FrameParser()
+{
+}
+
+void FrameParser::reset(void)
+{
+    m_pendingLen = 0;
+    m_scanned = 0;
+}
+
+bool FrameParser::emitFrame(const char *data, int len)
+{
+    while (len > 0 && isBlank(data[0])) {
+        data++;
+        len--;
+    }
+    while (len > 0 && isBlank(data[len - 1]))
+        len--;
+    if (len == 0)
+        return false;
+
+    m_frames++;
+    if (m_handler)
+        m_handler(data, len);
+    return true;
+}
+
+void FrameParser::emitBinaryFrame(const char *data, int len)
+{
+    // 二进制帧中可能有空白和结束符, 不做裁剪
+    m_frames++;
+    if (m_handler)
+        m_handler(data, len);
+}
+
+/*
+ * 在 data[from, len) 中查找帧边界并交出完整帧.
+ * *consumed 返回最后一个未结束帧的起始位置.
+ */
+int FrameParser::scan(const char *data, int len, int from, int *consumed)
+{
+    int frames = 0;
+    int start = 0;
+    for (int i = from; i < len; i++) {
+        const char c = data[i];
+        if (isDelimiter(c)) {
+            if (i > start && emitFrame(data + start, i - start))
+                frames++;
+            start = i + 1;
+        } else if (c == kHeader[0] && i > start && i + kHeaderLen <= len
+                   && memcmp(data + i, kHeader, kHeaderLen) == 0) {
+            // 两帧首尾相连, 没有结束符
+            if (emitFrame(data + start, i - start))
+                frames++;
+            start = i;
+        } else if (static_cast<unsigned char>(c) == BinaryProtocol::SOF0) {
+            const int n = BinaryProtocol::frameLength(data + i, len - i);
+            if (n < 0)
+                continue;   // 不是帧头或校验失败
+            if (i > start && emitFrame(data + start, i - start))
+                frames++;
+            start = i;
+            if (n == 0)
+                break;      // 二进制帧还没收全, 从帧头开始保留
+            emitBinaryFrame(data + i, n);
+            frames++;
+            i += n - 1;
+            start = i + 1;
+        }
+    }
+    *consumed = start;
+    return frames;
+}
+
+void FrameParser::keepPending(const char *data, int len)
+{
+    if (len > m_capacity / 2) {
+        // 超长且没有边界, 视为噪声丢弃
+        m_discarded += static_cast<unsigned long long>(len);
+        reset();
+        return;
+    }
+    memmove(m_pending.get(), data, static_cast<size_t>(len));
+    m_pendingLen = len;
+    // 帧头可能被截断在末尾, 下次从可能的帧头位置重新检查; 未收全的二进制帧从头检查
+    if (BinaryProtocol::isFrame(data, len))
+        m_scanned = 0;
+    else
+        m_scanned = len > kHeaderLen - 1 ? len - (kHeaderLen - 1) : 0;
+}
+
+int FrameParser::feed(const char *data, int len)
+{
+    int frames = 0;
+
+    while (len > 0) {
+        if (m_pendingLen == 0) {
+            // 快速路径: 直接在调用者的数据上解析, 只保存末尾半帧
+            int consumed = 0;
+            frames += scan(data, len, 0, &consumed);
+            if (consumed < len)
+                keepPending(data + consumed, len - consumed);
+            return frames;
+        }
+
+        // 有上次遗留的半帧, 拼接后继续扫描
+        int take = m_capacity - m_pendingLen;
+        if (take > len)
+            take = len;
+        memcpy(m_pending.get() + m_pendingLen, data, static_cast<size_t>(take));
+        m_pendingLen += take;
+        data += take;
+        len -= take;
+
+        int consumed = 0;
+        frames += scan(m_pending.get(), m_pendingLen, m_scanned, &consumed);
+        keepPending(m_pending.get() + consumed, m_pendingLen - consumed);
+    }
+
+    return frames;
+}
+
+int FrameParser::feed(ByteRingBuffer &ring)
+{
+    int frames = 0;
+    const char *span;
+    size_t avail;
+    while ((avail = ring.readableSpan(&span)) > 0) {
+        frames += feed(span, static_cast<int>(avail));
+        ring.consume(avail);
+    }
+    return frames;
+}
+
+int FrameParser::flush(void)
+{
+    if (m_pendingLen == 0)
+        return 0;
+
+    if (BinaryProtocol::isFrame(m_pending.get(), m_pendingLen)) {
+        // 总线空闲时仍不完整的二进制帧, 丢弃
+        m_discarded += static_cast<unsigned long long>(m_pendingLen);
+        reset();
+        return 0;
+    }
+
+    const unsigned long long before = m_frames;
+    emitFrame(m_pending.get(), m_pendingLen);
+    reset();
+    return static_cast<int>(m_frames - before);
+}
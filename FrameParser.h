@@ -0,0 +1,60 @@
+#ifndef FRAMEPARSER_H
+#define FRAMEPARSER_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+class ByteRingBuffer;
+
+/*
+ * 增量式应答帧解析器.
+ * 帧以 '\r' / '\n' 结尾, 或者在下一个 "gz_test" 帧头处结束; 固件不带结束符时,
+ * 由调用者在总线空闲 FRAME_IDLE_FLUSH_MS 后调用 flush() 交出最后一帧.
+ * 一次 feed 可以提取任意多帧, 帧以指针+长度回调, 不构造 QString/QByteArray;
+ * 只有跨越两次 feed 的半帧才会被拷贝到内部缓冲区.
+ * 同时识别二进制协议帧(见 BinaryProtocol.h): 帧头处按长度取整帧并校验 CRC, 原样交出;
+ * 校验失败的字节按普通文本处理, 从下一个帧头重新同步.
+ */
+class FrameParser
+{
+#define    FRAME_MAX_LEN          256
+#define    FRAME_IDLE_FLUSH_MS    50
+
+public:
+    typedef std::function<void(const char *data, int len)> FrameHandler;
+
+    explicit FrameParser(int maxFrameLen = FRAME_MAX_LEN);
+    ~FrameParser();
+
+    void setFrameHandler(FrameHandler handler) { m_handler = std::move(handler); }
+
+    // 追加数据, 回调其中所有完整帧, 返回本次提取的帧数
+    int feed(const char *data, int len);
+    // 直接从环形缓冲区的连续段解析, 读完即释放
+    int feed(ByteRingBuffer &ring);
+    // 总线空闲: 把未结束的半帧当作完整帧交出
+    int flush(void);
+    void reset(void);
+
+    bool hasPending(void) const { return m_pendingLen > 0; }
+    unsigned long long frameCount(void) const { return m_frames; }
+    unsigned long long discardedBytes(void) const { return m_discarded; }
+
+private:
+    int scan(const char *data, int len, int from, int *consumed);
+    bool emitFrame(const char *data, int len);
+    void emitBinaryFrame(const char *data, int len);
+    void keepPending(const char *data, int len);
+
+private:
+    FrameHandler m_handler;
+    std::unique_ptr<char[]> m_pending;
+    int m_capacity;
+    int m_pendingLen = 0;
+    int m_scanned = 0;  // m_pending 中已确认不含帧边界的长度
+    unsigned long long m_frames = 0;
+    unsigned long long m_discarded = 0;
+};
+
+#endif // FRAMEPARSER_H
@@ -0,0 +1,253 @@
+#include "HeadlessRunner.h"
+#include "TestStation.h"
+#include "ComTest.h"
+#include "SimDutServer.h"
+#include "ControlServer.h"
+#include "Logging.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+#include <cstring>
+
+HeadlessRunner::HeadlessRunner(const QElapsedTimer &startupTimer, QObject *parent)
+    : QObject(parent)
+    , m_startupTimer(startupTimer)
+{
+    for (int i = 0; i < TEST_ITEMS_NUM; i++)
+        m_itemTimeoutMs[i] = ComTest::defaultItemTimeout(i);
+}
+
+bool HeadlessRunner::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0)
+            return true;
+    }
+    return false;
+}
+
+bool HeadlessRunner::parseArguments(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("agv charging station fixture test, headless mode");
+    parser.addHelpOption();
+    QCommandLineOption headlessOption("headless", "Run without GUI.");
+    QCommandLineOption portOption(QStringList() << "p" << "port",
+                                  "Port of the DUT: serial name, tcp://host:port, udp://host:port, sim[:options] or replay:<capture file>.",
+                                  "name");
+    QCommandLineOption pipelinedOption("pipelined", "Send all test commands up front.");
+    QCommandLineOption simServerOption("sim-server", "Serve a simulated network DUT on localhost instead of testing.",
+                                       "port");
+    QCommandLineOption simOption("sim", "Behaviour of the simulated network DUT.", "spec", "sim");
+    QCommandLineOption timeoutOption("timeout", "Per-item ack timeouts in ms, e.g. uart_debug=300,can=8000.",
+                                     "item=ms,...");
+    parser.addOption(headlessOption);
+    parser.addOption(portOption);
+    parser.addOption(pipelinedOption);
+    parser.addOption(simServerOption);
+    parser.addOption(simOption);
+    parser.addOption(timeoutOption);
+    QCommandLineOption attemptsOption("attempts", "Max attempts per item, 1 disables retry.", "n",
+                                      QString::number(MAX_FAIL_CNT));
+    parser.addOption(attemptsOption);
+    QCommandLineOption traceOption("trace", "Record a binary trace and dump it here when the test does not pass.",
+                                   "file");
+    parser.addOption(traceOption);
+    QCommandLineOption captureOption("capture", "Save all raw bytes sent and received to a capture file in this directory.",
+                                     "dir");
+    parser.addOption(captureOption);
+    QCommandLineOption binaryOption("binary", "Negotiate the binary frame protocol, falling back to ASCII if the DUT does not support it.");
+    parser.addOption(binaryOption);
+    QCommandLineOption controlOption("control", "Serve the JSON-RPC control API on this localhost TCP port instead of testing once.",
+                                     "port");
+    parser.addOption(controlOption);
+    QCommandLineOption controlSocketOption("control-socket", "Serve the JSON-RPC control API on this local socket name.",
+                                           "name");
+    parser.addOption(controlSocketOption);
+    QCommandLineOption serialOption("serial", "Serial number of the board under test, saved with the result.", "sn");
+    parser.addOption(serialOption);
+    QCommandLineOption dbOption("db", "Append the result to this SQLite results database (default: $GZ_RESULT_DB).",
+                                "file", QString::fromLocal8Bit(qgetenv("GZ_RESULT_DB")));
+    parser.addOption(dbOption);
+
+    if (!parser.parse(arguments)) {
+        fprintf(stderr, "%s\n", qPrintable(parser.errorText()));
+        return false;
+    }
+    if (parser.isSet("help")) {
+        fprintf(stdout, "%s", qPrintable(parser.helpText()));
+        m_helpRequested = true;
+        return true;
+    }
+    if (parser.isSet(simServerOption)) {
+        bool ok = false;
+        m_simServerPort = parser.value(simServerOption).toInt(&ok);
+        if (!ok || m_simServerPort <= 0 || m_simServerPort > 65535) {
+            fprintf(stderr, "invalid --sim-server port\n");
+            return false;
+        }
+        m_simSpec = parser.value(simOption);
+        return true;
+    }
+    m_resultDb = parser.value(dbOption);
+    if (parser.isSet(controlOption) || parser.isSet(controlSocketOption)) {
+        if (parser.isSet(controlOption)) {
+            bool ok = false;
+            m_controlPort = parser.value(controlOption).toInt(&ok);
+            if (!ok || m_controlPort <= 0 || m_controlPort > 65535) {
+                fprintf(stderr, "invalid --control port\n");
+                return false;
+            }
+        }
+        m_controlSocket = parser.value(controlSocketOption);
+        return true;
+    }
+    if (!parser.isSet(portOption)) {
+        fprintf(stderr, "missing --port\n");
+        return false;
+    }
+
+    m_portName = parser.value(portOption);
+    m_boardSerial = parser.value(serialOption);
+    m_pipelined = parser.isSet(pipelinedOption);
+    m_binary = parser.isSet(binaryOption);
+    m_traceFile = parser.value(traceOption);
+    TraceRing::instance().setEnabled(!m_traceFile.isEmpty());
+    m_captureDir = parser.value(captureOption);
+    m_maxAttempts = parser.value(attemptsOption).toInt();
+    if (m_maxAttempts < 1) {
+        fprintf(stderr, "invalid --attempts\n");
+        return false;
+    }
+
+    for (const QString &option : parser.value(timeoutOption).split(',')) {
+        if (option.isEmpty())
+            continue;
+        const QString name = option.section('=', 0, 0).trimmed();
+        bool ok = false;
+        const int ms = option.section('=', 1).trimmed().toInt(&ok);
+        int item = 0;
+        while (item < TEST_ITEMS_NUM && name != ComTest::itemName(item))
+            item++;
+        if (!ok || item == TEST_ITEMS_NUM) {
+            fprintf(stderr, "invalid --timeout entry: %s\n", qPrintable(option));
+            return false;
+        }
+        m_itemTimeoutMs[item] = ms;
+    }
+    return true;
+}
+
+void HeadlessRunner::start(void)
+{
+    if (m_simServerPort > 0) {
+        startSimServer();
+        return;
+    }
+    if (m_controlPort > 0 || !m_controlSocket.isEmpty()) {
+        startControlServer();
+        return;
+    }
+
+    StartupTrace::mark("event loop");
+    m_station = new TestStation(m_portName, this);
+    m_station->comTest()->setPipelined(m_pipelined);
+    m_station->comTest()->setMaxAttempts(m_maxAttempts);
+    m_station->comTest()->setBinaryProtocol(m_binary);
+    m_station->setLatencyStats(&m_latencyStats);
+    m_station->setCaptureDir(m_captureDir);
+    m_station->setBoardSerial(m_boardSerial);
+    if (!m_resultDb.isEmpty() && m_resultStore.open(m_resultDb))
+        m_station->setResultStore(&m_resultStore);
+    for (int i = 0; i < TEST_ITEMS_NUM; i++)
+        m_station->setItemTimeout(i, m_itemTimeoutMs[i]);
+    connect(m_station->comTest(), &ComTest::sendData, this, &HeadlessRunner::onFirstSend);
+    connect(m_station, &TestStation::logInfo, this, [](const QString &msg) {
+        fprintf(stderr, "%s\n", qPrintable(msg));
+    });
+    connect(m_station, &TestStation::finished, this, &HeadlessRunner::onFinished);
+    StartupTrace::mark("station");
+
+    if (!m_station->start()) {
+        StartupTrace::finish("open port");
+        fprintf(stderr, "open %s failed\n", qPrintable(m_portName));
+        dumpTrace();
+        QCoreApplication::exit(HEADLESS_EXIT_OPEN_FAILED);
+    }
+}
+
+void HeadlessRunner::startSimServer(void)
+{
+    m_simServer = new SimDutServer(SimDutConfig::fromSpec(m_simSpec), this);
+    if (!m_simServer->listen(QHostAddress::LocalHost, static_cast<quint16>(m_simServerPort))) {
+        fprintf(stderr, "listen on %d failed: %s\n", m_simServerPort, qPrintable(m_simServer->errorString()));
+        QCoreApplication::exit(HEADLESS_EXIT_OPEN_FAILED);
+        return;
+    }
+    // 常驻运行, 由调用者结束进程
+    fprintf(stderr, "simulated DUT on tcp://127.0.0.1:%d and udp://127.0.0.1:%d\n",
+            m_simServerPort, m_simServerPort);
+}
+
+void HeadlessRunner::startControlServer(void)
+{
+    m_controlServer = new ControlServer(this);
+    m_controlServer->setLatencyStats(&m_latencyStats);
+    if (!m_resultDb.isEmpty() && m_resultStore.open(m_resultDb))
+        m_controlServer->setResultStore(&m_resultStore);
+    connect(m_controlServer, &ControlServer::logInfo, this, [](const QString &msg) {
+        fprintf(stderr, "%s\n", qPrintable(msg));
+    });
+    if (m_controlPort > 0 && !m_controlServer->listenTcp(static_cast<quint16>(m_controlPort))) {
+        fprintf(stderr, "listen on %d failed: %s\n", m_controlPort, qPrintable(m_controlServer->errorString()));
+        QCoreApplication::exit(HEADLESS_EXIT_OPEN_FAILED);
+        return;
+    }
+    if (!m_controlSocket.isEmpty() && !m_controlServer->listenLocal(m_controlSocket)) {
+        fprintf(stderr, "listen on %s failed: %s\n", qPrintable(m_controlSocket),
+                qPrintable(m_controlServer->errorString()));
+        QCoreApplication::exit(HEADLESS_EXIT_OPEN_FAILED);
+        return;
+    }
+    // 常驻运行, 由调用者结束进程
+    if (m_controlPort > 0)
+        fprintf(stderr, "control api on tcp://127.0.0.1:%d\n", m_controlPort);
+    if (!m_controlSocket.isEmpty())
+        fprintf(stderr, "control api on local socket %s\n", qPrintable(m_controlSocket));
+}
+
+void HeadlessRunner::onFirstSend(void)
+{
+    // 进程启动到第一条命令交给端口的时间
+    m_firstTxMs = m_startupTimer.elapsed();
+    StartupTrace::finish("open port + first tx");
+    disconnect(m_station->comTest(), &ComTest::sendData, this, &HeadlessRunner::onFirstSend);
+}
+
+void HeadlessRunner::printResult(void)
+{
+    QJsonObject json = m_station->resultJson();
+    json["startup_to_first_tx_ms"] = m_firstTxMs;
+
+    fprintf(stdout, "%s\n", QJsonDocument(json).toJson(QJsonDocument::Compact).constData());
+    fflush(stdout);
+}
+
+void HeadlessRunner::dumpTrace(void)
+{
+    if (!m_traceFile.isEmpty() && TraceRing::instance().dumpToFile(m_traceFile, m_station->traceId()))
+        fprintf(stderr, "trace written to %s\n", qPrintable(m_traceFile));
+}
+
+void HeadlessRunner::onFinished(int result)
+{
+    if (result != ComTest::GZ_END_SUCCESS)
+        dumpTrace();
+    printResult();
+    // 进程马上退出, 等结果写入数据库
+    m_resultStore.close();
+    QCoreApplication::exit(result);
+}
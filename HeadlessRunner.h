@@ -0,0 +1,82 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include "LatencyStats.h"
+#include "ComTest.h"
+#include "ResultStore.h"
+
+class TestStation;
+class SimDutServer;
+class ControlServer;
+
+/*
+ * 无界面批处理模式, 供产线 MES 脚本调用:
+ *   bw_agv_gz_test --headless --port COM3 [--pipelined] [--timeout uart_debug=300,can=8000] [--attempts 3] [--trace fail.trace]
+ *                  [--capture dir] [--binary] [--serial SN] [--db results.db]
+ *   bw_agv_gz_test --headless --port replay:dir/COM3_20240101_080000_000.gzcap[?speed=max]
+ *   bw_agv_gz_test --headless --sim-server 7000 [--sim sim:nack=can]
+ *   bw_agv_gz_test --headless --control 7100 [--control-socket gz_test]
+ * 只使用 QCoreApplication, 不创建任何窗口; 结果以一行 JSON 输出到 stdout,
+ * --db(默认取环境变量 GZ_RESULT_DB)非空时结果同时写入 SQLite 结果库(ResultStore).
+ * 进程退出码与 ComTest::eTestEndResult 一致, 参数或端口错误使用下面的扩展码.
+ * --sim-server 不做测试, 在本机指定端口上常驻一个网口工装板替身(SimDutServer).
+ * --control/--control-socket 不做测试, 常驻提供 JSON-RPC 控制接口(ControlServer), 由 MES 按端口启动测试.
+ */
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+
+#define    HEADLESS_EXIT_OPEN_FAILED    3
+#define    HEADLESS_EXIT_USAGE          4
+
+public:
+    explicit HeadlessRunner(const QElapsedTimer &startupTimer, QObject *parent = nullptr);
+
+    // 命令行中带 --headless 时走无界面模式, 在构造 QApplication 之前判断
+    static bool isRequested(int argc, char *argv[]);
+
+    // 解析参数, 失败时已打印原因; --help 打印帮助后返回 true, 由 isHelpRequested 区分
+    bool parseArguments(const QStringList &arguments);
+    bool isHelpRequested(void) const { return m_helpRequested; }
+
+public slots:
+    void start(void);
+
+private slots:
+    void onFirstSend(void);
+    void onFinished(int result);
+
+private:
+    void startSimServer(void);
+    void startControlServer(void);
+    void printResult(void);
+    void dumpTrace(void);
+
+private:
+    QElapsedTimer m_startupTimer;
+    qint64 m_firstTxMs = -1;
+    QString m_portName;
+    bool m_helpRequested = false;
+    bool m_pipelined = false;
+    bool m_binary = false;
+    int m_maxAttempts = MAX_FAIL_CNT;
+    QString m_traceFile;  // 非空时开启跟踪环, 测试未通过时写入此文件
+    QString m_captureDir;
+    QString m_boardSerial;
+    QString m_resultDb;
+    ResultStore m_resultStore;
+    int m_itemTimeoutMs[TEST_ITEMS_NUM];
+    int m_simServerPort = -1;
+    QString m_simSpec;
+    TestStation *m_station = nullptr;
+    LatencyStats m_latencyStats;
+    SimDutServer *m_simServer = nullptr;
+    int m_controlPort = -1;
+    QString m_controlSocket;
+    ControlServer *m_controlServer = nullptr;
+};
+
+#endif // HEADLESSRUNNER_H
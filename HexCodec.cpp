@@ -0,0 +1,296 @@
+#include "HexCodec.h"
+
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define HEX_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace HexCodec {
+
+namespace {
+
+const char kDigits[] = "0123456789ABCDEF";
+
+struct Tables {
+    char pair[256][2];
+    unsigned char nibble[256];  // 0xFF 表示不是十六进制数字
+
+    Tables()
+    {
+        for (int i = 0; i < 256; i++) {
+            pair[i][0] = kDigits[i >> 4];
+            pair[i][1] = kDigits[i & 0xF];
+            nibble[i] = 0xFF;
+        }
+        for (int i = 0; i < 10; i++)
+            nibble['0' + i] = static_cast<unsigned char>(i);
+        for (int i = 0; i < 6; i++) {
+            nibble['A' + i] = static_cast<unsigned char>(10 + i);
+            nibble['a' + i] = static_cast<unsigned char>(10 + i);
+        }
+    }
+};
+
+const Tables &tables()
+{
+    static const Tables t;
+    return t;
+}
+
+// 从第 i 个字节开始编码剩余部分, 每个字节后跟空格, 最后一个除外
+void encodeTail(const unsigned char *src, size_t i, size_t n, char *dst)
+{
+    const Tables &t = tables();
+    char *out = dst + 3 * i;
+    for (; i < n; i++) {
+        out[0] = t.pair[src[i]][0];
+        out[1] = t.pair[src[i]][1];
+        if (i + 1 < n)
+            out[2] = ' ';
+        out += 3;
+    }
+}
+
+// 从 src[i] 开始逐字符解码, 接着已写入的 done 个字节
+size_t decodeTail(const char *src, size_t i, size_t len, unsigned char *dst, size_t done)
+{
+    const Tables &t = tables();
+    int high = -1;
+    for (; i < len; i++) {
+        const unsigned char v = t.nibble[static_cast<unsigned char>(src[i])];
+        if (v == 0xFF)
+            continue;
+        if (high < 0) {
+            high = v;
+        } else {
+            dst[done++] = static_cast<unsigned char>((high << 4) | v);
+            high = -1;
+        }
+    }
+    return done;
+}
+
+#ifdef HEX_X86_SIMD
+
+#define HEX_TARGET(isa) __attribute__((target(isa)))
+
+// 16 个字节的高/低半字节转成 ASCII: 0-9 -> '0'-'9', 10-15 -> 'A'-'F'
+inline __m128i nibblesToAscii(__m128i nib)
+{
+    const __m128i gt9 = _mm_cmpgt_epi8(nib, _mm_set1_epi8(9));
+    return _mm_add_epi8(_mm_add_epi8(nib, _mm_set1_epi8('0')), _mm_and_si128(gt9, _mm_set1_epi8('A' - '0' - 10)));
+}
+
+// 16 个输入字节 -> 交错的 32 个字符: lo 为前 8 字节, hi 为后 8 字节
+inline void hexPairs(__m128i v, __m128i *lo, __m128i *hi)
+{
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i h = nibblesToAscii(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const __m128i l = nibblesToAscii(_mm_and_si128(v, mask));
+    *lo = _mm_unpacklo_epi8(h, l);
+    *hi = _mm_unpackhi_epi8(h, l);
+}
+
+// SSE2 没有字节重排, 算好 32 个字符后逐对拷贝并插入空格
+size_t encodeSse2(const unsigned char *src, size_t n, char *dst)
+{
+    size_t i = 0;
+    alignas(16) char pairs[32];
+    for (; i + 16 < n; i += 16) {
+        __m128i lo, hi;
+        hexPairs(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), &lo, &hi);
+        _mm_store_si128(reinterpret_cast<__m128i *>(pairs), lo);
+        _mm_store_si128(reinterpret_cast<__m128i *>(pairs + 16), hi);
+        char *out = dst + 3 * i;
+        for (int k = 0; k < 16; k++) {
+            out[3 * k] = pairs[2 * k];
+            out[3 * k + 1] = pairs[2 * k + 1];
+            out[3 * k + 2] = ' ';
+        }
+    }
+    return i;
+}
+
+/*
+ * 16 字节 -> 48 个字符(含每字节后的空格): 交错字符 A(字节0-7)、B(字节8-15)
+ * 按下表重排到三个输出向量, -1 位置为 0, 再或上空格.
+ */
+#define HEX_SPREAD_MASKS                                                                         \
+    const __m128i a0 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);     \
+    const __m128i a1 = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1); \
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5); \
+    const __m128i b2 = _mm_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1); \
+    const __m128i s0 = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0); \
+    const __m128i s1 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0); \
+    const __m128i s2 = _mm_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ')
+
+HEX_TARGET("ssse3")
+size_t encodeSsse3(const unsigned char *src, size_t n, char *dst)
+{
+    HEX_SPREAD_MASKS;
+    size_t i = 0;
+    for (; i + 16 < n; i += 16) {
+        __m128i a, b;
+        hexPairs(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), &a, &b);
+        __m128i *out = reinterpret_cast<__m128i *>(dst + 3 * i);
+        _mm_storeu_si128(out, _mm_or_si128(_mm_shuffle_epi8(a, a0), s0));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, a1), _mm_shuffle_epi8(b, b1)), s1));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(b, b2), s2));
+    }
+    return i;
+}
+
+// 每个 128 位通道独立处理 16 字节, 重排表与 SSSE3 相同
+HEX_TARGET("avx2")
+size_t encodeAvx2(const unsigned char *src, size_t n, char *dst)
+{
+    HEX_SPREAD_MASKS;
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i letter = _mm256_set1_epi8('A' - '0' - 10);
+    const __m256i ya0 = _mm256_broadcastsi128_si256(a0), ya1 = _mm256_broadcastsi128_si256(a1);
+    const __m256i yb1 = _mm256_broadcastsi128_si256(b1), yb2 = _mm256_broadcastsi128_si256(b2);
+    const __m256i ys0 = _mm256_broadcastsi128_si256(s0), ys1 = _mm256_broadcastsi128_si256(s1);
+    const __m256i ys2 = _mm256_broadcastsi128_si256(s2);
+
+    size_t i = 0;
+    for (; i + 32 < n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i h = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+        __m256i l = _mm256_and_si256(v, mask);
+        h = _mm256_add_epi8(_mm256_add_epi8(h, zero), _mm256_and_si256(_mm256_cmpgt_epi8(h, nine), letter));
+        l = _mm256_add_epi8(_mm256_add_epi8(l, zero), _mm256_and_si256(_mm256_cmpgt_epi8(l, nine), letter));
+        const __m256i a = _mm256_unpacklo_epi8(h, l);  // 通道0: 字节0-7, 通道1: 字节16-23
+        const __m256i b = _mm256_unpackhi_epi8(h, l);  // 通道0: 字节8-15, 通道1: 字节24-31
+
+        const __m256i o0 = _mm256_or_si256(_mm256_shuffle_epi8(a, ya0), ys0);
+        const __m256i o1 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(a, ya1), _mm256_shuffle_epi8(b, yb1)), ys1);
+        const __m256i o2 = _mm256_or_si256(_mm256_shuffle_epi8(b, yb2), ys2);
+
+        __m128i *out = reinterpret_cast<__m128i *>(dst + 3 * i);
+        _mm_storeu_si128(out, _mm256_castsi256_si128(o0));
+        _mm_storeu_si128(out + 1, _mm256_castsi256_si128(o1));
+        _mm_storeu_si128(out + 2, _mm256_castsi256_si128(o2));
+        _mm_storeu_si128(out + 3, _mm256_extracti128_si256(o0, 1));
+        _mm_storeu_si128(out + 4, _mm256_extracti128_si256(o1, 1));
+        _mm_storeu_si128(out + 5, _mm256_extracti128_si256(o2, 1));
+    }
+    return i;
+}
+
+// ASCII 十六进制数字 -> 半字节; 有非法字符时 *valid 为 false
+inline __m128i asciiToNibbles(__m128i c, bool *valid)
+{
+    const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i alpha = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    *valid = _mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) == 0xFFFF;
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_andnot_si128(isDigit, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+/*
+ * 格式规整的 "HH HH ... HH " 每 48 个字符解出 16 字节; 遇到不规整的块交给标量实现,
+ * 保证与标量结果一致.
+ */
+HEX_TARGET("ssse3")
+size_t decodeSsse3(const char *src, size_t len, unsigned char *dst, size_t *consumed)
+{
+    const __m128i h0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i h1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i h2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i l0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i l1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i l2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i p0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i p1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i p2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+    const __m128i space = _mm_set1_epi8(' ');
+
+    size_t i = 0, done = 0;
+    for (; i + 48 <= len; i += 48, done += 16) {
+        const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16));
+        const __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 32));
+
+        const __m128i sp = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(x0, p0), _mm_shuffle_epi8(x1, p1)),
+                                        _mm_shuffle_epi8(x2, p2));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(sp, space)) != 0xFFFF)
+            break;
+
+        bool validHi, validLo;
+        const __m128i hi = asciiToNibbles(_mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(x0, h0), _mm_shuffle_epi8(x1, h1)),
+                                                       _mm_shuffle_epi8(x2, h2)), &validHi);
+        const __m128i lo = asciiToNibbles(_mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(x0, l0), _mm_shuffle_epi8(x1, l1)),
+                                                       _mm_shuffle_epi8(x2, l2)), &validLo);
+        if (!validHi || !validLo)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + done), _mm_or_si128(_mm_slli_epi16(hi, 4), lo));
+    }
+    *consumed = i;
+    return done;
+}
+
+#endif // HEX_X86_SIMD
+
+}
+
+Impl bestImpl()
+{
+#ifdef HEX_X86_SIMD
+    static const Impl best = __builtin_cpu_supports("avx2") ? IMPL_AVX2
+                           : __builtin_cpu_supports("ssse3") ? IMPL_SSSE3
+                           : IMPL_SSE2;
+    return best;
+#else
+    return IMPL_SCALAR;
+#endif
+}
+
+const char *implName(Impl impl)
+{
+    static const char *const names[IMPL_NUM] = { "scalar", "sse2", "ssse3", "avx2" };
+    return names[impl];
+}
+
+bool isSupported(Impl impl)
+{
+    return impl <= bestImpl();
+}
+
+void encode(const unsigned char *src, size_t n, char *dst, Impl impl)
+{
+    size_t done = 0;
+#ifdef HEX_X86_SIMD
+    if (impl > bestImpl())
+        impl = bestImpl();
+    // 向量循环总留至少一个字节给标量尾部, 最后一个字节后面不写空格
+    if (impl == IMPL_AVX2)
+        done = encodeAvx2(src, n, dst);
+    if (impl >= IMPL_SSSE3)
+        done += encodeSsse3(src + done, n - done, dst + 3 * done);
+    else if (impl == IMPL_SSE2)
+        done = encodeSse2(src, n, dst);
+#else
+    (void) impl;
+#endif
+    encodeTail(src, done, n, dst);
+}
+
+size_t decode(const char *src, size_t len, unsigned char *dst, Impl impl)
+{
+    size_t consumed = 0, done = 0;
+#ifdef HEX_X86_SIMD
+    if (impl >= IMPL_SSSE3 && bestImpl() >= IMPL_SSSE3)
+        done = decodeSsse3(src, len, dst, &consumed);
+#else
+    (void) impl;
+#endif
+    return decodeTail(src, consumed, len, dst, done);
+}
+
+}
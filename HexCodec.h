@@ -0,0 +1,37 @@
+#ifndef HEXCODEC_H
+#define HEXCODEC_H
+
+#include <cstddef>
+
+/*
+ * 报文十六进制编解码, 格式为大写、字节间一个空格: "67 7A 5F 74".
+ * 线性时间, 调用者一次分配好输出; x86 上按 CPU 支持选择 AVX2 / SSSE3 / SSE2 实现,
+ * 其余平台和不足一个向量的尾部使用查表的标量实现, 各实现输出完全一致.
+ */
+namespace HexCodec {
+
+enum Impl {
+    IMPL_SCALAR,
+    IMPL_SSE2,
+    IMPL_SSSE3,
+    IMPL_AVX2,
+    IMPL_NUM
+};
+
+// 本机可用的最快实现
+Impl bestImpl();
+const char *implName(Impl impl);
+bool isSupported(Impl impl);
+
+// n 字节编码后的长度(3n-1)
+inline size_t encodedSize(size_t n) { return n ? 3 * n - 1 : 0; }
+// dst 至少 encodedSize(n) 字节, 不写结束符
+void encode(const unsigned char *src, size_t n, char *dst, Impl impl = bestImpl());
+
+// 解码最多 len/2 字节, 返回写入的字节数. 空白和其他非十六进制字符跳过,
+// 十六进制数字按出现顺序两两成对, 最后落单的半个字节丢弃.
+size_t decode(const char *src, size_t len, unsigned char *dst, Impl impl = bestImpl());
+
+}
+
+#endif // HEXCODEC_H
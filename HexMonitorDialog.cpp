@@ -0,0 +1,99 @@
+#include "HexMonitorDialog.h"
+#include "LogModel.h"
+#include "TestStation.h"
+#include "global.h"
+
+#include <QFont>
+#include <QHBoxLayout>
+#include <QListView>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QVBoxLayout>
+
+HexMonitorDialog::HexMonitorDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_model(new LogModel(HEX_MONITOR_LINES, this))
+    , m_view(new QListView(this))
+    , m_pauseBtn(new QPushButton(tr("暂停"), this))
+{
+    setWindowTitle(tr("报文监视"));
+    resize(760, 400);
+
+    m_model->setTimeFormat("[HH:mm:ss.zzz] ");
+    m_view->setModel(m_model);
+    m_view->setUniformItemSizes(true);
+    m_view->setFont(QFont("Courier New", 9));
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, [this]() {
+        QScrollBar *bar = m_view->verticalScrollBar();
+        if (bar->value() >= bar->maximum() - bar->pageStep())
+            m_view->scrollToBottom();
+    });
+
+    m_pauseBtn->setCheckable(true);
+    auto clearBtn = new QPushButton(tr("清空"), this);
+    connect(m_pauseBtn, &QPushButton::toggled, this, &HexMonitorDialog::onPauseToggled);
+    connect(clearBtn, &QPushButton::clicked, m_model, &LogModel::clear);
+
+    auto buttons = new QHBoxLayout;
+    buttons->addStretch();
+    buttons->addWidget(m_pauseBtn);
+    buttons->addWidget(clearBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_view);
+    layout->addLayout(buttons);
+}
+
+void HexMonitorDialog::attach(TestStation *station)
+{
+    for (const auto &s : m_stations) {
+        if (s == station)
+            return;
+    }
+    m_stations.append(station);
+    connect(station, &TestStation::rawTraffic, this, &HexMonitorDialog::onRawTraffic);
+    station->setTrafficTap(isVisible() && !m_pauseBtn->isChecked());
+}
+
+void HexMonitorDialog::onRawTraffic(bool isTx, const QByteArray &data)
+{
+    auto station = qobject_cast<TestStation *>(sender());
+    if (station == nullptr || data.isEmpty())
+        return;
+
+    // 一次编码整条报文, 再把每行末尾的空格换成换行, 由日志模型拆成续行
+    QByteArray hex = dataToHex(data);
+    const int rowChars = HEX_MONITOR_ROW_BYTES * 3;
+    for (int i = rowChars - 1; i < hex.size(); i += rowChars)
+        hex[i] = '\n';
+
+    m_model->append(QString("[%1] %2 %3: %4").arg(station->portName(), isTx ? QString("TX") : QString("RX"))
+                    .arg(data.size()).arg(QString::fromLatin1(hex)));
+}
+
+void HexMonitorDialog::onPauseToggled(bool paused)
+{
+    m_pauseBtn->setText(paused ? tr("继续") : tr("暂停"));
+    updateTap();
+}
+
+void HexMonitorDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    updateTap();
+}
+
+void HexMonitorDialog::hideEvent(QHideEvent *event)
+{
+    QDialog::hideEvent(event);
+    updateTap();
+}
+
+void HexMonitorDialog::updateTap(void)
+{
+    const bool enable = isVisible() && !m_pauseBtn->isChecked();
+    for (const auto &s : m_stations) {
+        if (s != nullptr)
+            s->setTrafficTap(enable);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef HEXMONITORDIALOG_H
+#define HEXMONITORDIALOG_H
+
+#include <QDialog>
+#include <QList>
+#include <QPointer>
+
+class LogModel;
+class QListView;
+class QPushButton;
+class TestStation;
+
+/*
+ * 报文监视: 以十六进制显示各工位收发的原始字节, 每行 32 字节.
+ * 只在窗口可见且未暂停时打开工位的 trafficTap, 平时收发不做任何拷贝.
+ */
+class HexMonitorDialog : public QDialog
+{
+    Q_OBJECT
+
+#define    HEX_MONITOR_LINES       2000
+#define    HEX_MONITOR_ROW_BYTES   32
+
+public:
+    explicit HexMonitorDialog(QWidget *parent = nullptr);
+
+    void attach(TestStation *station);
+
+private slots:
+    void onRawTraffic(bool isTx, const QByteArray &data);
+    void onPauseToggled(bool paused);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void updateTap(void);
+
+private:
+    QList<QPointer<TestStation> > m_stations;
+    LogModel *m_model;
+    QListView *m_view;
+    QPushButton *m_pauseBtn;
+};
+
+#endif // HEXMONITORDIALOG_H
@@ -0,0 +1,96 @@
+#include "LatencyDialog.h"
+#include "LatencyStats.h"
+#include "global.h"
+#include "uiglobal.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+LatencyDialog::LatencyDialog(LatencyStats *stats, QWidget *parent)
+    : QDialog(parent)
+    , m_stats(stats)
+    , m_table(new QTableWidget(this))
+{
+    setWindowTitle(tr("往返延时统计"));
+    resize(640, 360);
+
+    m_table->setColumnCount(LatencyStats::csvHeader().size());
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("端口") << tr("测试项") << tr("次数") << tr("无应答")
+                                       << "min(ms)" << "p50(ms)" << "p90(ms)" << "p99(ms)" << "max(ms)" << tr("平均(ms)"));
+    m_table->verticalHeader()->setVisible(false);
+    m_table->verticalHeader()->setDefaultSectionSize(22);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+
+    auto refreshBtn = new QPushButton(tr("刷新"), this);
+    auto resetBtn = new QPushButton(tr("清零"), this);
+    auto exportBtn = new QPushButton(tr("导出CSV"), this);
+    connect(refreshBtn, &QPushButton::clicked, this, &LatencyDialog::refresh);
+    connect(resetBtn, &QPushButton::clicked, this, &LatencyDialog::resetStats);
+    connect(exportBtn, &QPushButton::clicked, this, &LatencyDialog::exportCsv);
+
+    auto buttons = new QHBoxLayout;
+    buttons->addStretch();
+    buttons->addWidget(refreshBtn);
+    buttons->addWidget(resetBtn);
+    buttons->addWidget(exportBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_table);
+    layout->addLayout(buttons);
+}
+
+void LatencyDialog::showEvent(QShowEvent *event)
+{
+    refresh();
+    QDialog::showEvent(event);
+}
+
+void LatencyDialog::refresh(void)
+{
+    const QList<QStringList> rows = m_stats->summaryRows();
+    m_table->setRowCount(rows.size());
+    for (int row = 0; row < rows.size(); row++) {
+        const QStringList &cells = rows.at(row);
+        for (int col = 0; col < cells.size(); col++) {
+            QTableWidgetItem *item = m_table->item(row, col);
+            if (item == nullptr) {
+                item = new QTableWidgetItem;
+                m_table->setItem(row, col, item);
+            }
+            // "*" 为所有端口合并
+            item->setText(col == 0 && cells.at(col) == "*" ? tr("全部") : cells.at(col));
+        }
+    }
+    m_table->resizeColumnsToContents();
+}
+
+void LatencyDialog::exportCsv(void)
+{
+    const QString defaultName = QString("latency_%1.csv")
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmm"));
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("导出延时统计"), defaultName, "CSV (*.csv)");
+    if (fileName.isEmpty())
+        return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text) || !m_stats->exportCsv(&file)) {
+        showError(tr("导出失败"), file.errorString(), this);
+        return;
+    }
+    showMessage(tr("导出延时统计"), tr("已保存到 %1").arg(fileName), this);
+}
+
+void LatencyDialog::resetStats(void)
+{
+    if (!showQuestion(tr("清零"), tr("确定清除全部延时统计?"), this))
+        return;
+    m_stats->reset();
+    refresh();
+}
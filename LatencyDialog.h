@@ -0,0 +1,34 @@
+#ifndef LATENCYDIALOG_H
+#define LATENCYDIALOG_H
+
+#include <QDialog>
+
+class LatencyStats;
+class QTableWidget;
+
+/*
+ * 往返延时统计: 每个端口每个测试项一行, 可刷新、清零和导出 CSV(交班时保存).
+ */
+class LatencyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyDialog(LatencyStats *stats, QWidget *parent = nullptr);
+
+public slots:
+    void refresh(void);
+
+private slots:
+    void exportCsv(void);
+    void resetStats(void);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    LatencyStats *m_stats;
+    QTableWidget *m_table;
+};
+
+#endif // LATENCYDIALOG_H
@@ -0,0 +1,180 @@
+#include "LatencyStats.h"
+
+#include <QIODevice>
+#include <QTextStream>
+#include <QtAlgorithms>
+
+namespace {
+
+const int kSubCount = 1 << LATENCY_SUB_BITS;
+const int kHalfCount = kSubCount / 2;
+// 最大值 < 2^36: 精确区 kSubCount 格 + (36 - LATENCY_SUB_BITS) 段 * kHalfCount 格
+const int kBucketCount = kSubCount + (36 - LATENCY_SUB_BITS) * kHalfCount;
+
+QString usToMs(qint64 us)
+{
+    return QString::number(us / 1000.0, 'f', 2);
+}
+
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(kBucketCount, 0)
+{
+}
+
+int LatencyHistogram::bucketOf(qint64 us)
+{
+    if (us < kSubCount)
+        return us < 0 ? 0 : static_cast<int>(us);
+    if (us >= LATENCY_MAX_US)
+        return kBucketCount - 1;
+
+    const int msb = 63 - static_cast<int>(qCountLeadingZeroBits(static_cast<quint64>(us)));
+    const int e = msb - (LATENCY_SUB_BITS - 1);
+    return kSubCount + (e - 1) * kHalfCount + static_cast<int>(us >> e) - kHalfCount;
+}
+
+qint64 LatencyHistogram::bucketHigh(int bucket)
+{
+    if (bucket < kSubCount)
+        return bucket;
+    const int e = (bucket - kSubCount) / kHalfCount + 1;
+    const qint64 m = (bucket - kSubCount) % kHalfCount + kHalfCount;
+    return ((m + 1) << e) - 1;
+}
+
+void LatencyHistogram::record(qint64 us)
+{
+    if (us < 0)
+        us = 0;
+    m_buckets[bucketOf(us)]++;
+    if (m_count == 0 || us < m_min)
+        m_min = us;
+    if (us > m_max)
+        m_max = us;
+    m_sum += us;
+    m_count++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (other.m_count == 0)
+        return;
+    for (int i = 0; i < kBucketCount; i++)
+        m_buckets[i] += other.m_buckets.at(i);
+    if (m_count == 0 || other.m_min < m_min)
+        m_min = other.m_min;
+    if (other.m_max > m_max)
+        m_max = other.m_max;
+    m_sum += other.m_sum;
+    m_count += other.m_count;
+}
+
+void LatencyHistogram::reset(void)
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return 0;
+
+    quint64 rank = static_cast<quint64>(p * m_count + 0.5);
+    if (rank < 1)
+        rank = 1;
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += m_buckets.at(i);
+        if (seen >= rank)
+            return qBound(m_min, bucketHigh(i), m_max);
+    }
+    return m_max;
+}
+
+void LatencyStats::record(const QString &port, int item, qint64 us)
+{
+    m_ports[port].items[item].record(us);
+}
+
+void LatencyStats::recordMiss(const QString &port, int item)
+{
+    m_ports[port].misses[item]++;
+}
+
+void LatencyStats::reset(void)
+{
+    m_ports.clear();
+}
+
+const LatencyHistogram &LatencyStats::histogram(const QString &port, int item) const
+{
+    static const LatencyHistogram empty;
+    auto it = m_ports.constFind(port);
+    return it == m_ports.constEnd() ? empty : it->items[item];
+}
+
+quint64 LatencyStats::misses(const QString &port, int item) const
+{
+    auto it = m_ports.constFind(port);
+    return it == m_ports.constEnd() ? 0 : it->misses[item];
+}
+
+LatencyHistogram LatencyStats::merged(int item) const
+{
+    LatencyHistogram h;
+    for (const PortStats &stats : m_ports)
+        h.merge(stats.items[item]);
+    return h;
+}
+
+QStringList LatencyStats::csvHeader(void)
+{
+    return QStringList() << "port" << "item" << "count" << "miss"
+                         << "min_ms" << "p50_ms" << "p90_ms" << "p99_ms" << "max_ms" << "mean_ms";
+}
+
+QStringList LatencyStats::summaryRow(const QString &port, int item, const LatencyHistogram &h, quint64 misses)
+{
+    return QStringList() << port << ComTest::itemName(item)
+                         << QString::number(h.count()) << QString::number(misses)
+                         << usToMs(h.min()) << usToMs(h.percentile(0.50)) << usToMs(h.percentile(0.90))
+                         << usToMs(h.percentile(0.99)) << usToMs(h.max())
+                         << QString::number(h.mean() / 1000.0, 'f', 2);
+}
+
+QList<QStringList> LatencyStats::summaryRows(void) const
+{
+    QList<QStringList> rows;
+    for (auto it = m_ports.constBegin(); it != m_ports.constEnd(); ++it) {
+        for (int i = 0; i < TEST_ITEMS_NUM; i++)
+            rows.append(summaryRow(it.key(), i, it->items[i], it->misses[i]));
+    }
+    if (m_ports.size() > 1) {
+        for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+            quint64 miss = 0;
+            for (const PortStats &stats : m_ports)
+                miss += stats.misses[i];
+            rows.append(summaryRow("*", i, merged(i), miss));
+        }
+    }
+    return rows;
+}
+
+bool LatencyStats::exportCsv(QIODevice *device) const
+{
+    if (!device->isWritable())
+        return false;
+
+    QTextStream out(device);
+    out << csvHeader().join(',') << "\n";
+    for (const QStringList &row : summaryRows())
+        out << row.join(',') << "\n";
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,81 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "ComTest.h"
+
+class QIODevice;
+
+/*
+ * HDR 风格的对数-线性直方图, 单位 us.
+ * 小于 2^LATENCY_SUB_BITS 的值精确记录, 更大的值按 2 的幂分段, 每段再等分
+ * 2^(LATENCY_SUB_BITS-1) 份, 相对误差不超过 1/32; 记录为 O(1), 不分配内存.
+ */
+class LatencyHistogram
+{
+#define    LATENCY_SUB_BITS    6
+#define    LATENCY_MAX_US      (Q_INT64_C(1) << 36)  // 约 19 小时, 更大的值计入最后一格
+
+public:
+    LatencyHistogram();
+
+    void record(qint64 us);
+    void merge(const LatencyHistogram &other);
+    void reset(void);
+
+    quint64 count(void) const { return m_count; }
+    qint64 min(void) const { return m_count ? m_min : 0; }
+    qint64 max(void) const { return m_max; }
+    double mean(void) const { return m_count ? static_cast<double>(m_sum) / m_count : 0.0; }
+    // p 取 0~1, 返回所在格的上界(不超过实际最大值)
+    qint64 percentile(double p) const;
+
+private:
+    static int bucketOf(qint64 us);
+    static qint64 bucketHigh(int bucket);
+
+    QVector<quint64> m_buckets;
+    quint64 m_count = 0;
+    qint64 m_sum = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+};
+
+/*
+ * 按端口和测试项统计的往返延时: 命令交给端口 -> 解析出对应应答.
+ * 一个班次内所有工位共用一份, 结束时可导出为 CSV.
+ */
+class LatencyStats
+{
+public:
+    void record(const QString &port, int item, qint64 us);
+    // 发出命令后到测试结束都没有收到应答
+    void recordMiss(const QString &port, int item);
+    void reset(void);
+
+    QStringList ports(void) const { return m_ports.keys(); }
+    const LatencyHistogram &histogram(const QString &port, int item) const;
+    quint64 misses(const QString &port, int item) const;
+    // 所有端口合并后的单项直方图
+    LatencyHistogram merged(int item) const;
+
+    // 每个端口每个测试项一行, 最后是合并行; 单位 ms
+    static QStringList csvHeader(void);
+    QList<QStringList> summaryRows(void) const;
+    bool exportCsv(QIODevice *device) const;
+
+private:
+    struct PortStats {
+        LatencyHistogram items[TEST_ITEMS_NUM];
+        quint64 misses[TEST_ITEMS_NUM] = { 0 };
+    };
+
+    static QStringList summaryRow(const QString &port, int item, const LatencyHistogram &h, quint64 misses);
+
+    QMap<QString, PortStats> m_ports;
+};
+
+#endif // LATENCYSTATS_H
@@ -0,0 +1,107 @@
+#include "LogModel.h"
+
+#include <QDateTime>
+#include <QRegularExpression>
+
+LogModel::LogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_lines(qMax(1, capacity))
+    , m_timeFormat("[yyyy-MM-dd HH:mm:ss] ")
+{
+    m_pending.reserve(m_lines.size());
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(LOG_FLUSH_MS);
+    connect(&m_flushTimer, &QTimer::timeout, this, &LogModel::flush);
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= m_count)
+        return QVariant();
+
+    // 时间戳只在绘制可见行时格式化
+    const LogLine &line = lineAt(index.row());
+    if (line.timestamp == 0)
+        return QString("    ") + line.text;
+    return QDateTime::fromMSecsSinceEpoch(line.timestamp).toString(m_timeFormat)
+           + line.text;
+}
+
+void LogModel::append(const QString &message)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    static const QRegularExpression lineBreak("\\r\\n|\\r|\\n");
+
+    bool first = true;
+    for (const QString &text : message.split(lineBreak)) {
+        // 去掉结果信息里的空行, 但保留只有一行的空消息
+        if (!first && text.trimmed().isEmpty())
+            continue;
+        queueLine(first ? now : 0, text);
+        first = false;
+    }
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void LogModel::queueLine(qint64 timestamp, const QString &text)
+{
+    // 待刷新队列最多一个容量, 满了提前刷新, 保证队列本身也有界
+    if (m_pending.size() >= m_lines.size())
+        flush();
+    LogLine line;
+    line.timestamp = timestamp;
+    line.text = text;
+    m_pending.append(line);
+}
+
+void LogModel::flush(void)
+{
+    m_flushTimer.stop();
+    const int n = m_pending.size();
+    if (n == 0)
+        return;
+
+    const int capacity = m_lines.size();
+    const int overflow = m_count + n - capacity;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        for (int i = 0; i < overflow; i++)
+            m_lines[(m_first + i) % capacity].text.clear();
+        m_first = (m_first + overflow) % capacity;
+        m_count -= overflow;
+        m_dropped += static_cast<quint64>(overflow);
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count + n - 1);
+    for (int i = 0; i < n; i++)
+        m_lines[(m_first + m_count + i) % capacity] = m_pending.at(i);
+    m_count += n;
+    endInsertRows();
+
+    m_pending.clear();
+}
+
+void LogModel::clear(void)
+{
+    m_flushTimer.stop();
+    beginResetModel();
+    for (LogLine &line : m_lines)
+        line = LogLine();
+    m_first = 0;
+    m_count = 0;
+    m_pending.clear();
+    endResetModel();
+}
+
+const LogModel::LogLine &LogModel::lineAt(int row) const
+{
+    return m_lines.at((m_first + row) % m_lines.size());
+}
@@ -0,0 +1,57 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+/*
+ * 执行信息的定长环形日志模型, 配合 QListView 显示(只绘制可见行).
+ * append 只把消息放入待刷新队列, 定时批量插入模型; 超出容量时丢弃最旧的行,
+ * 内存占用恒定, 每行的界面开销与已运行时间无关.
+ */
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+#define    LOG_MODEL_CAPACITY    5000
+#define    LOG_FLUSH_MS          100
+
+public:
+    explicit LogModel(int capacity = LOG_MODEL_CAPACITY, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    int capacity(void) const { return m_lines.size(); }
+    // 因容量不足被丢弃的最旧行数
+    quint64 droppedLines(void) const { return m_dropped; }
+    // 行首时间戳格式(QDateTime::toString), 默认精确到秒
+    void setTimeFormat(const QString &format) { m_timeFormat = format; }
+
+public slots:
+    // 多行消息按行拆开, 只有第一行带时间戳
+    void append(const QString &message);
+    void flush(void);
+    void clear(void);
+
+private:
+    struct LogLine {
+        qint64 timestamp = 0;   // ms since epoch, 0 表示续行
+        QString text;
+    };
+
+    const LogLine &lineAt(int row) const;
+    void queueLine(qint64 timestamp, const QString &text);
+
+    QVector<LogLine> m_lines;   // 环形存储, 构造时按容量分配
+    int m_first = 0;
+    int m_count = 0;
+    QVector<LogLine> m_pending;
+    quint64 m_dropped = 0;
+    QString m_timeFormat;
+    QTimer m_flushTimer;
+};
+
+#endif // LOGMODEL_H
@@ -0,0 +1,158 @@
+#include "Logging.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QIODevice>
+#include <QTextStream>
+#include <cstdio>
+
+Q_LOGGING_CATEGORY(lcTransport, "gz.transport", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcParser, "gz.parser", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcSequencer, "gz.sequencer", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcUi, "gz.ui", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcStore, "gz.store", QtInfoMsg)
+
+namespace {
+
+const char *const kEventNames[TraceRing::TRACE_EVENT_NUM] = {
+    "open", "close", "tx", "rx", "ack", "bad_frame", "timeout", "retry", "finish", "protocol"
+};
+
+QElapsedTimer &traceClock(void)
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid())
+        clock.start();
+    return clock;
+}
+
+}
+
+TraceRing &TraceRing::instance(void)
+{
+    static TraceRing ring;
+    return ring;
+}
+
+TraceRing::TraceRing()
+{
+    traceClock();
+    clear();
+}
+
+void TraceRing::record(quint16 event, quint16 station, qint32 a, qint32 b)
+{
+    const quint64 index = m_next.fetch_add(1, std::memory_order_relaxed);
+    Record &r = m_records[index & (TRACE_RING_CAPACITY - 1)];
+    r.timeNs = traceClock().nsecsElapsed();
+    r.event = event;
+    r.station = station;
+    r.a = a;
+    r.b = b;
+}
+
+bool TraceRing::dump(QIODevice *device, quint16 station) const
+{
+    if (!device->isWritable())
+        return false;
+
+    const quint64 next = m_next.load(std::memory_order_acquire);
+    const quint64 first = next > TRACE_RING_CAPACITY ? next - TRACE_RING_CAPACITY : 0;
+
+    QTextStream out(device);
+    out << "# time_ms station event a b\n";
+    for (quint64 i = first; i < next; i++) {
+        const Record &r = m_records[i & (TRACE_RING_CAPACITY - 1)];
+        if (station != 0 && r.station != station)
+            continue;
+        out << QString::number(r.timeNs / 1e6, 'f', 3) << ' ' << r.station << ' '
+            << (r.event < TRACE_EVENT_NUM ? kEventNames[r.event] : "?") << ' ' << r.a << ' ' << r.b << '\n';
+    }
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+bool TraceRing::dumpToFile(const QString &fileName, quint16 station) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(lcUi) << "trace dump to" << fileName << "failed:" << file.errorString();
+        return false;
+    }
+    return dump(&file, station);
+}
+
+/* ---------------- StartupTrace ---------------- */
+
+namespace {
+
+struct StartupPhase {
+    const char *name;
+    qint64 endNs;
+};
+
+QElapsedTimer g_startupClock;
+StartupPhase g_phases[STARTUP_TRACE_PHASES];
+int g_phaseCnt = 0;
+
+}
+
+bool StartupTrace::s_enabled = false;
+
+void StartupTrace::begin(void)
+{
+    g_startupClock.start();
+    g_phaseCnt = 0;
+    s_enabled = !qgetenv("GZ_STARTUP_TRACE").isEmpty();
+}
+
+void StartupTrace::mark(const char *phase)
+{
+    if (!s_enabled || g_phaseCnt >= STARTUP_TRACE_PHASES)
+        return;
+    g_phases[g_phaseCnt].name = phase;
+    g_phases[g_phaseCnt].endNs = g_startupClock.nsecsElapsed();
+    g_phaseCnt++;
+}
+
+qint64 StartupTrace::elapsedMs(void)
+{
+    return g_startupClock.isValid() ? g_startupClock.elapsed() : 0;
+}
+
+QString StartupTrace::finish(const char *phase)
+{
+    if (!s_enabled)
+        return QString();
+    mark(phase);
+    s_enabled = false;
+
+    bool ok = false;
+    int targetMs = qgetenv("GZ_STARTUP_TARGET_MS").toInt(&ok);
+    if (!ok || targetMs <= 0)
+        targetMs = STARTUP_TARGET_MS;
+
+    QString report("startup phases (ms):\n");
+    qint64 prevNs = 0;
+    for (int i = 0; i < g_phaseCnt; i++) {
+        report += QString("  %1 %2\n").arg(g_phases[i].name, -24)
+                  .arg((g_phases[i].endNs - prevNs) / 1e6, 8, 'f', 1);
+        prevNs = g_phases[i].endNs;
+    }
+    const double totalMs = prevNs / 1e6;
+    report += QString("  %1 %2").arg("total", -24).arg(totalMs, 8, 'f', 1);
+    if (totalMs > targetMs)
+        report += QString("  (over target %1 ms)").arg(targetMs);
+
+    fprintf(stderr, "%s\n", qPrintable(report));
+    if (totalMs > targetMs)
+        qCWarning(lcUi) << "startup took" << totalMs << "ms, target" << targetMs << "ms";
+    return report;
+}
+
+void TraceRing::clear(void)
+{
+    m_next.store(0, std::memory_order_relaxed);
+    for (Record &r : m_records)
+        r = Record();
+}
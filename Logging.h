@@ -0,0 +1,108 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+#include <QtGlobal>
+#include <atomic>
+
+class QIODevice;
+
+/*
+ * 分模块日志. 各模块默认只输出 info 及以上, qCDebug 在判断级别之前不做任何格式化;
+ * release 构建定义了 QT_NO_DEBUG_OUTPUT, qCDebug 整体编译掉. 调试时打开某个模块:
+ *   QT_LOGGING_RULES="gz.transport.debug=true"
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcTransport)   // gz.transport: 端口收发
+Q_DECLARE_LOGGING_CATEGORY(lcParser)      // gz.parser: 分帧和应答解析
+Q_DECLARE_LOGGING_CATEGORY(lcSequencer)   // gz.sequencer: 测试序列、超时、重试
+Q_DECLARE_LOGGING_CATEGORY(lcUi)          // gz.ui: 界面和工具函数
+Q_DECLARE_LOGGING_CATEGORY(lcStore)       // gz.store: 测试结果库
+
+/*
+ * 二进制跟踪环: 固定大小的内存环, 每条记录是定长结构体, 不分配内存也不格式化,
+ * 默认关闭, 关闭时 GZ_TRACE 只有一次原子读. 测试失败时 dump 出最近的记录.
+ * 多个线程可以同时写(下标原子递增), dump 在测试结束后进行.
+ */
+class TraceRing
+{
+#define    TRACE_RING_CAPACITY    4096   // 2 的幂
+
+public:
+    enum Event : quint16 {
+        TRACE_OPEN,         // a: 是否成功
+        TRACE_CLOSE,
+        TRACE_TX,           // a: 测试项, b: 字节数
+        TRACE_RX,           // a: 字节数, b: 解析出的帧数
+        TRACE_ACK,          // a: 测试项, b: 是否通过
+        TRACE_BAD_FRAME,    // a: 帧长
+        TRACE_TIMEOUT,      // a: 测试项, b: 超时(ms)
+        TRACE_RETRY,        // a: 测试项, b: 已尝试次数
+        TRACE_FINISH,       // a: eTestEndResult, b: 用时(ms)
+        TRACE_PROTOCOL,     // a: 协商结果 eProtocolDef
+        TRACE_EVENT_NUM
+    };
+
+    struct Record {
+        qint64 timeNs;      // 单调时钟
+        quint16 event;
+        quint16 station;    // 工位编号, 区分多工位
+        qint32 a;
+        qint32 b;
+    };
+
+    static TraceRing &instance(void);
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled(void) const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void record(quint16 event, quint16 station, qint32 a = 0, qint32 b = 0);
+    // 按时间顺序输出最近的记录(文本), station 为 0 时输出全部工位
+    bool dump(QIODevice *device, quint16 station = 0) const;
+    bool dumpToFile(const QString &fileName, quint16 station = 0) const;
+    void clear(void);
+
+private:
+    TraceRing();
+
+    Record m_records[TRACE_RING_CAPACITY];
+    std::atomic<quint64> m_next{0};
+    std::atomic<bool> m_enabled{false};
+};
+
+/*
+ * 启动耗时: 环境变量 GZ_STARTUP_TRACE 非空时记录 main 开始到界面可用之间各阶段的用时,
+ * 结束时输出到 stderr; 超过 GZ_STARTUP_TARGET_MS(默认 STARTUP_TARGET_MS)时给出警告.
+ * 未开启时 mark 只判断一次标志.
+ */
+class StartupTrace
+{
+#define    STARTUP_TRACE_PHASES    32
+#define    STARTUP_TARGET_MS       500
+
+public:
+    // main 的第一行调用, 开始计时
+    static void begin(void);
+    static bool isEnabled(void) { return s_enabled; }
+    // 上一个阶段到此结束, phase 为该阶段名称(字符串常量)
+    static void mark(const char *phase);
+    // 记录最后一个阶段, 返回并输出报告; 未开启时返回空
+    static QString finish(const char *phase);
+    static qint64 elapsedMs(void);
+
+private:
+    static bool s_enabled;
+};
+
+#ifdef GZ_NO_TRACE
+#define GZ_TRACE(event, station, a, b) do { } while (0)
+#else
+#define GZ_TRACE(event, station, a, b)                                              \
+    do {                                                                            \
+        TraceRing &ring_ = TraceRing::instance();                                   \
+        if (ring_.isEnabled())                                                      \
+            ring_.record(TraceRing::event, static_cast<quint16>(station),           \
+                         static_cast<qint32>(a), static_cast<qint32>(b));           \
+    } while (0)
+#endif
+
+#endif // LOGGING_H
@@ -0,0 +1,40 @@
+#ifndef NETSETTINGS_H
+#define NETSETTINGS_H
+
+#include <QString>
+#include <QUrl>
+
+/*
+ * 网口工装板的连接参数. 端口名写成 "tcp://host:port" 或 "udp://host:port"
+ * 时走网络, 命令集与串口完全相同.
+ */
+struct NetSettings {
+    enum Protocol { Tcp, Udp };
+
+    Protocol protocol = Tcp;
+    QString host;
+    quint16 port = 0;
+    int connectTimeoutMs = 1000;
+
+    static bool isNetSpec(const QString &portName)
+    {
+        return portName.startsWith("tcp://", Qt::CaseInsensitive)
+               || portName.startsWith("udp://", Qt::CaseInsensitive);
+    }
+
+    // 解析失败(缺少主机或端口)时返回 false
+    static bool fromSpec(const QString &spec, NetSettings *settings)
+    {
+        const QUrl url(spec, QUrl::StrictMode);
+        const int port = url.port(-1);
+        if (!url.isValid() || url.host().isEmpty() || port <= 0)
+            return false;
+
+        settings->protocol = (url.scheme().compare("udp", Qt::CaseInsensitive) == 0) ? Udp : Tcp;
+        settings->host = url.host();
+        settings->port = static_cast<quint16>(port);
+        return true;
+    }
+};
+
+#endif // NETSETTINGS_H
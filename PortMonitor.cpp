@@ -0,0 +1,243 @@
+#include "PortMonitor.h"
+#include "AsyncReadWriter.h"
+#include "SerialReadWriter.h"
+#include "AckParser.h"
+#include "ComTest.h"
+#include "Logging.h"
+
+#include <QSerialPortInfo>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+/* ---------------- PortScanner ---------------- */
+
+void PortScanner::start(void)
+{
+    m_timer = new QTimer(this);
+    connect(m_timer, &QTimer::timeout, this, &PortScanner::scan);
+    if (openNetlink()) {
+        m_timer->setSingleShot(true);
+        m_timer->setInterval(PORT_RESCAN_DEBOUNCE_MS);
+    } else {
+        m_timer->setInterval(PORT_POLL_MS);
+        m_timer->start();
+    }
+    m_hotplug = m_netlinkFd >= 0;
+    qCInfo(lcTransport) << "port monitor:" << (m_hotplug ? "netlink hotplug" : "polling");
+    scan();
+}
+
+void PortScanner::stop(void)
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    delete m_timer;
+    m_timer = nullptr;
+#ifdef Q_OS_LINUX
+    if (m_netlinkFd >= 0)
+        ::close(m_netlinkFd);
+#endif
+    m_netlinkFd = -1;
+}
+
+void PortScanner::scan(void)
+{
+    QStringList ports;
+    for (const QSerialPortInfo &info : QSerialPortInfo::availablePorts())
+        ports << info.portName();
+    ports.sort();
+    emit scanned(ports);
+}
+
+bool PortScanner::openNetlink(void)
+{
+#ifdef Q_OS_LINUX
+    const int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0)
+        return false;
+    sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1;     // 内核 uevent 组, 不依赖 udevd
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return false;
+    }
+    m_netlinkFd = fd;
+    m_notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &PortScanner::onUevent);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PortScanner::onUevent(void)
+{
+#ifdef Q_OS_LINUX
+    // 消息为 "add@/devices/.../tty/ttyUSB0\0ACTION=add\0...SUBSYSTEM=tty\0...", 只关心 tty
+    char buf[4096];
+    bool ttyChanged = false;
+    ssize_t n;
+    while ((n = ::recv(m_netlinkFd, buf, sizeof(buf) - 1, 0)) > 0) {
+        buf[n] = '\0';
+        for (const char *field = buf; field < buf + n; field += strlen(field) + 1) {
+            if (strcmp(field, "SUBSYSTEM=tty") == 0) {
+                ttyChanged = true;
+                break;
+            }
+        }
+    }
+    if (ttyChanged)
+        m_timer->start();
+#endif
+}
+
+/* ---------------- PortProber ---------------- */
+
+PortProber::PortProber(const QString &portName, QObject *parent)
+    : QObject(parent)
+    , m_portName(portName)
+{
+    m_parser.setFrameHandler([this](const char *data, int len) {
+        AckParser::ParsedAck ack;
+        if (AckParser::parse(data, len, &ack))
+            m_found = true;
+    });
+    m_timeout.setSingleShot(true);
+    m_timeout.setInterval(PORT_PROBE_TIMEOUT_MS);
+    connect(&m_timeout, &QTimer::timeout, this, [this]() {
+        // 固件应答不带结束符时最后一帧还在解析器里
+        m_parser.flush();
+        finish(m_found);
+    });
+}
+
+PortProber::~PortProber()
+{
+    delete m_readWriter;
+}
+
+void PortProber::start(void)
+{
+    auto serialReadWriter = new SerialReadWriter();
+    serialReadWriter->setSerialSettings(SerialSettings::fixture(m_portName));
+    m_readWriter = new AsyncReadWriter(serialReadWriter, nullptr, 4 * 1024);
+    if (!m_readWriter->open()) {
+        finish(false);
+        return;
+    }
+    connect(m_readWriter, &AsyncReadWriter::readyRead, this, &PortProber::readData);
+    m_readWriter->write(ComTest::commandOf(TEST_IDX_DEBUG_COM));
+    m_timeout.start();
+}
+
+void PortProber::readData(void)
+{
+    m_parser.feed(m_readWriter->rxBuffer());
+    if (m_found)
+        finish(true);
+}
+
+void PortProber::finish(bool isDut)
+{
+    if (m_done)
+        return;
+    m_done = true;
+    m_timeout.stop();
+    if (m_readWriter != nullptr)
+        m_readWriter->close();
+    qCDebug(lcTransport) << m_portName << "probe:" << (isDut ? "fixture found" : "no answer");
+    emit finished(m_portName, isDut);
+}
+
+/* ---------------- PortMonitor ---------------- */
+
+PortMonitor::PortMonitor(QObject *parent)
+    : QObject(parent)
+    , m_scanner(new PortScanner)
+{
+    m_scanner->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::started, m_scanner, &PortScanner::start);
+    connect(m_scanner, &PortScanner::scanned, this, &PortMonitor::onScanned);
+    m_thread.setObjectName("portMonitor");
+}
+
+PortMonitor::~PortMonitor()
+{
+    if (m_thread.isRunning()) {
+        QMetaObject::invokeMethod(m_scanner, "stop", Qt::BlockingQueuedConnection);
+        m_thread.quit();
+        m_thread.wait();
+    }
+    delete m_scanner;
+    qDeleteAll(m_probers);
+}
+
+void PortMonitor::start(void)
+{
+    if (!m_thread.isRunning())
+        m_thread.start(QThread::LowPriority);
+}
+
+bool PortMonitor::isHotplug(void) const
+{
+    return m_scanner->isHotplug();
+}
+
+void PortMonitor::onScanned(const QStringList &ports)
+{
+    if (ports == m_ports)
+        return;
+
+    const QStringList previous = m_ports;
+    m_ports = ports;
+    emit portsChanged(m_ports);
+
+    for (const QString &port : previous) {
+        if (!ports.contains(port))
+            emit portRemoved(port);
+    }
+    if (!m_hasBaseline) {
+        m_hasBaseline = true;
+        return;
+    }
+    for (const QString &port : ports) {
+        if (previous.contains(port))
+            continue;
+        emit portAdded(port);
+        if (m_probeEnabled) {
+            QTimer::singleShot(PORT_PROBE_DELAY_MS, this, [this, port]() {
+                if (m_ports.contains(port))
+                    probe(port);
+            });
+        }
+    }
+}
+
+void PortMonitor::probe(const QString &portName)
+{
+    if (m_probers.contains(portName))
+        return;
+    // 每个端口一个探测者, 各自的IO线程并发收发
+    auto prober = new PortProber(portName, this);
+    m_probers.insert(portName, prober);
+    connect(prober, &PortProber::finished, this, &PortMonitor::onProbeFinished, Qt::QueuedConnection);
+    prober->start();
+}
+
+void PortMonitor::onProbeFinished(const QString &portName, bool isDut)
+{
+    PortProber *prober = m_probers.take(portName);
+    if (prober != nullptr)
+        prober->deleteLater();
+    emit probeFinished(portName);
+    if (isDut)
+        emit dutDetected(portName);
+}
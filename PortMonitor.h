@@ -0,0 +1,136 @@
+#ifndef PORTMONITOR_H
+#define PORTMONITOR_H
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include "FrameParser.h"
+
+class AsyncReadWriter;
+class QSocketNotifier;
+
+/*
+ * 在独立线程中枚举串口, 只被 PortMonitor 使用.
+ * Linux 上监听内核 uevent(netlink), tty 设备增删时重新枚举; 其他平台或 netlink 不可用时定时轮询.
+ */
+class PortScanner : public QObject
+{
+    Q_OBJECT
+
+#define    PORT_POLL_MS              1000
+#define    PORT_RESCAN_DEBOUNCE_MS   200   // uevent 先于设备节点就绪, 合并一串事件后再枚举
+
+public:
+    PortScanner() = default;
+
+    bool isHotplug(void) const { return m_hotplug; }
+
+public slots:
+    void start(void);
+    void stop(void);
+    void scan(void);
+
+signals:
+    void scanned(const QStringList &ports);
+
+private slots:
+    void onUevent(void);
+
+private:
+    bool openNetlink(void);
+
+private:
+    int m_netlinkFd = -1;
+    std::atomic<bool> m_hotplug{false};
+    QSocketNotifier *m_notifier = nullptr;
+    QTimer *m_timer = nullptr;
+};
+
+/*
+ * 一次探测: 打开端口发出调试串口测试命令, 在超时内收到任何可解析的应答即认为接了工装板.
+ * 只收发一条命令, 不影响后续正式测试.
+ */
+class PortProber : public QObject
+{
+    Q_OBJECT
+
+#define    PORT_PROBE_TIMEOUT_MS     500
+
+public:
+    explicit PortProber(const QString &portName, QObject *parent = nullptr);
+    ~PortProber();
+
+    const QString &portName(void) const { return m_portName; }
+    void start(void);
+
+signals:
+    void finished(const QString &portName, bool isDut);
+
+private:
+    void readData(void);
+    void finish(bool isDut);
+
+private:
+    QString m_portName;
+    AsyncReadWriter *m_readWriter = nullptr;
+    FrameParser m_parser;
+    QTimer m_timeout;
+    bool m_found = false;
+    bool m_done = false;
+};
+
+/*
+ * 串口热插拔监视: 端口列表在后台线程中保持最新, 新出现的端口延时片刻后并发探测,
+ * 探测到工装板时发出 dutDetected, 界面可以据此自动开始测试.
+ * 启动时已经存在的端口只作为基准, 不探测.
+ */
+class PortMonitor : public QObject
+{
+    Q_OBJECT
+
+#define    PORT_PROBE_DELAY_MS       300   // USB 转串口枚举后需要一点时间才能稳定收发
+
+public:
+    explicit PortMonitor(QObject *parent = nullptr);
+    ~PortMonitor();
+
+    void start(void);
+    const QStringList &ports(void) const { return m_ports; }
+    // 使用内核热插拔通知(否则为轮询)
+    bool isHotplug(void) const;
+
+    // 新端口出现时自动探测, 默认打开
+    void setProbeEnabled(bool enable) { m_probeEnabled = enable; }
+    bool isProbeEnabled(void) const { return m_probeEnabled; }
+    // 探测中的端口不能被测试打开: 开始测试前检查, 探测中时等 probeFinished 再开始
+    bool isProbing(const QString &portName) const { return m_probers.contains(portName); }
+
+public slots:
+    void probe(const QString &portName);
+
+signals:
+    void portsChanged(const QStringList &ports);
+    void portAdded(const QString &portName);
+    void portRemoved(const QString &portName);
+    void dutDetected(const QString &portName);
+    // 探测结束且端口已关闭, 先于 dutDetected 发出
+    void probeFinished(const QString &portName);
+
+private slots:
+    void onScanned(const QStringList &ports);
+    void onProbeFinished(const QString &portName, bool isDut);
+
+private:
+    QThread m_thread;
+    PortScanner *m_scanner = nullptr;
+    QStringList m_ports;
+    bool m_hasBaseline = false;
+    bool m_probeEnabled = true;
+    QMap<QString, PortProber *> m_probers;
+};
+
+#endif // PORTMONITOR_H
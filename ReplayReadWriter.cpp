@@ -0,0 +1,100 @@
+#include "ReplayReadWriter.h"
+#include "Logging.h"
+
+#include <QTimer>
+#include <cstring>
+
+ReplayReadWriter::ReplayReadWriter(const ReplaySettings &settings, QObject *parent)
+        : AbstractReadWriter(parent), settings(settings) {
+}
+
+QString ReplayReadWriter::settingsText() const {
+    return QString("replay %1 (%2, %3 records), speed %4")
+            .arg(settings.fileName, capture.portName()).arg(capture.records().size())
+            .arg(settings.speed > 0 ? QString::number(settings.speed) : QString("max"));
+}
+
+bool ReplayReadWriter::open() {
+    QString error;
+    if (!capture.load(settings.fileName, &error)) {
+        qCWarning(lcTransport) << "replay" << settings.fileName << error;
+        return false;
+    }
+    if (capture.isTruncated())
+        qCWarning(lcTransport) << "replay" << settings.fileName << "last record truncated";
+    opened = true;
+    session++;
+    cursor = 0;
+    replayUntilTx(0);
+    return true;
+}
+
+bool ReplayReadWriter::isOpen() {
+    return opened;
+}
+
+bool ReplayReadWriter::isConnected() {
+    return opened;
+}
+
+void ReplayReadWriter::close() {
+    opened = false;
+    session++;
+    rxBuff.clear();
+}
+
+QByteArray ReplayReadWriter::readAll() {
+    QByteArray data;
+    data.swap(rxBuff);
+    return data;
+}
+
+qint64 ReplayReadWriter::read(char *data, qint64 maxSize) {
+    const int n = static_cast<int>(qMin<qint64>(maxSize, rxBuff.size()));
+    memcpy(data, rxBuff.constData(), static_cast<size_t>(n));
+    rxBuff.remove(0, n);
+    return n;
+}
+
+qint64 ReplayReadWriter::write(const QByteArray &byteArray) const {
+    if (!opened) {
+        return 0;
+    }
+    // 接口要求 write 为 const, 回放进度在这里推进
+    auto self = const_cast<ReplayReadWriter *>(this);
+    const QVector<CaptureRecord> &records = capture.records();
+    while (self->cursor < records.size() && !records.at(self->cursor).isTx)
+        self->cursor++;
+    if (self->cursor == records.size()) {
+        // 抓包到此为止, 之后的命令都等不到应答
+        return byteArray.size();
+    }
+
+    const CaptureRecord &tx = records.at(self->cursor++);
+    if (tx.data != byteArray)
+        qCWarning(lcTransport) << "replay: command differs from capture:" << byteArray << "vs" << tx.data;
+    self->replayUntilTx(tx.timeUs);
+    return byteArray.size();
+}
+
+void ReplayReadWriter::replayUntilTx(qint64 fromUs) {
+    const QVector<CaptureRecord> &records = capture.records();
+    const quint64 current = session;
+    for (; cursor < records.size() && !records.at(cursor).isTx; cursor++) {
+        const CaptureRecord &rx = records.at(cursor);
+        const int delayMs = settings.speed > 0
+                ? static_cast<int>((rx.timeUs - fromUs) / 1000 / settings.speed) : 0;
+        const QByteArray data = rx.data;
+        QTimer::singleShot(qMax(0, delayMs), this, [this, current, data]() {
+            deliver(current, data);
+        });
+    }
+}
+
+void ReplayReadWriter::deliver(quint64 replaySession, const QByteArray &data) {
+    if (!opened || replaySession != session) {
+        return;
+    }
+    rxBuff.append(data);
+    emit readyRead();
+}
@@ -0,0 +1,81 @@
+#ifndef REPLAYREADWRITER_H
+#define REPLAYREADWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstring>
+#include "AbstractReadWriter.h"
+#include "TrafficCapture.h"
+
+/*
+ * 回放端口名: "replay:<抓包文件>" 按原始时间回放, "replay:<抓包文件>?speed=max" 不等待,
+ * "?speed=4" 为 4 倍速.
+ */
+struct ReplaySettings {
+    QString fileName;
+    double speed = 1.0;     // 0 表示不等待
+
+    static bool isReplaySpec(const QString &portName) {
+        return portName.startsWith("replay:", Qt::CaseInsensitive);
+    }
+
+    static ReplaySettings fromSpec(const QString &spec) {
+        ReplaySettings settings;
+        const QString rest = spec.mid(int(strlen("replay:")));
+        settings.fileName = rest.section('?', 0, 0);
+        const QString speed = rest.section('?', 1).section('=', 1).trimmed();
+        if (speed.compare("max", Qt::CaseInsensitive) == 0) {
+            settings.speed = 0;
+        } else if (!speed.isEmpty()) {
+            bool ok = false;
+            const double factor = speed.toDouble(&ok);
+            if (ok && factor > 0)
+                settings.speed = factor;
+        }
+        return settings;
+    }
+};
+
+/*
+ * 把抓包文件当作被测板回放, 复现现场失败: 每写入一条命令, 取抓包中下一条发送记录,
+ * 把它之后、再下一条发送之前收到的数据按原始间隔(或立即)送回,
+ * 经过与真实端口完全相同的分帧、应答解析和测试序列.
+ * 第一条发送之前收到的数据在打开时送回.
+ */
+class ReplayReadWriter : public AbstractReadWriter {
+Q_OBJECT
+public:
+    explicit ReplayReadWriter(const ReplaySettings &settings, QObject *parent = nullptr);
+
+    QString settingsText() const override;
+
+    bool open() override;
+
+    bool isOpen() override;
+
+    bool isConnected() override;
+
+    void close() override;
+
+    QByteArray readAll() override;
+
+    qint64 read(char *data, qint64 maxSize) override;
+
+    qint64 write(const QByteArray &byteArray) const override;
+
+private:
+    // 从 cursor 开始送回下一条发送记录之前的接收数据, 时间相对 fromUs
+    void replayUntilTx(qint64 fromUs);
+    void deliver(quint64 replaySession, const QByteArray &data);
+
+private:
+    ReplaySettings settings;
+    CaptureFile capture;
+    int cursor{0};
+    QByteArray rxBuff;
+    bool opened{false};
+    quint64 session{0};
+};
+
+
+#endif //REPLAYREADWRITER_H
@@ -0,0 +1,461 @@
+#include "ResultStore.h"
+#include "YieldStats.h"
+#include "Logging.h"
+
+#include <QMutexLocker>
+#include <QPointer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QThread>
+#include <QVariant>
+
+namespace {
+
+const char *const kSchema[] = {
+    "CREATE TABLE IF NOT EXISTS runs ("
+    " id INTEGER PRIMARY KEY,"
+    " serial TEXT NOT NULL DEFAULT '',"
+    " port TEXT NOT NULL,"
+    " started_at INTEGER NOT NULL,"
+    " result INTEGER NOT NULL,"
+    " pipelined INTEGER NOT NULL,"
+    " protocol INTEGER NOT NULL,"
+    " cycle_ms INTEGER,"
+    " mask_485 INTEGER NOT NULL,"
+    " capture TEXT)",
+    "CREATE TABLE IF NOT EXISTS items ("
+    " run_id INTEGER NOT NULL,"
+    " item INTEGER NOT NULL,"
+    " done INTEGER NOT NULL,"
+    " pass INTEGER NOT NULL,"
+    " attempts INTEGER NOT NULL,"
+    " rtt_us INTEGER,"
+    " PRIMARY KEY (run_id, item)) WITHOUT ROWID",
+    "CREATE INDEX IF NOT EXISTS runs_serial_time ON runs (serial, started_at)",
+    "CREATE INDEX IF NOT EXISTS runs_time ON runs (started_at)",
+};
+
+QVariant nullIfNegative(qint64 value)
+{
+    return value >= 0 ? QVariant(value) : QVariant(QVariant::LongLong);
+}
+
+// 先按索引取出最多 limit 个 runs, 再一次连接出它们的 items; 同一 run 的各行相邻
+QVector<RunRecord> selectRuns(const QSqlDatabase &db, const QString &serial, qint64 fromMs, qint64 toMs, int limit)
+{
+    QVector<RunRecord> runs;
+    // 带板号时走 runs_serial_time, 否则走 runs_time
+    QString sql = "SELECT r.id, r.serial, r.port, r.started_at, r.result, r.pipelined, r.protocol, r.cycle_ms,"
+                  " r.mask_485, r.capture, i.item, i.done, i.pass, i.attempts, i.rtt_us"
+                  " FROM (SELECT * FROM runs WHERE started_at >= ? AND started_at < ?";
+    if (!serial.isEmpty())
+        sql += " AND serial = ?";
+    sql += " ORDER BY started_at DESC, id DESC LIMIT ?) r"
+           " LEFT JOIN items i ON i.run_id = r.id"
+           " ORDER BY r.started_at DESC, r.id DESC";
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    int n = 0;
+    query.bindValue(n++, fromMs);
+    query.bindValue(n++, toMs);
+    if (!serial.isEmpty())
+        query.bindValue(n++, serial);
+    query.bindValue(n++, limit);
+    if (!query.exec()) {
+        qCWarning(lcStore) << "query failed:" << query.lastError().text();
+        return runs;
+    }
+    while (query.next()) {
+        const qint64 id = query.value(0).toLongLong();
+        if (runs.isEmpty() || runs.last().id != id) {
+            RunRecord run;
+            run.id = id;
+            run.serial = query.value(1).toString();
+            run.port = query.value(2).toString();
+            run.startedAt = query.value(3).toLongLong();
+            run.result = query.value(4).toInt();
+            run.pipelined = query.value(5).toInt() != 0;
+            run.protocol = query.value(6).toInt();
+            run.cycleMs = query.value(7).isNull() ? -1 : query.value(7).toLongLong();
+            run.mask485 = query.value(8).toUInt();
+            run.capture = query.value(9).toString();
+            for (int i = 0; i < TEST_ITEMS_NUM; i++)
+                run.rttUs[i] = -1;
+            runs.append(run);
+        }
+        if (query.value(10).isNull())
+            continue;
+        const int i = query.value(10).toInt();
+        if (i < 0 || i >= TEST_ITEMS_NUM)
+            continue;
+        RunRecord &run = runs.last();
+        run.done[i] = query.value(11).toInt() != 0;
+        run.pass[i] = query.value(12).toInt() != 0;
+        run.attempts[i] = query.value(13).toInt();
+        run.rttUs[i] = query.value(14).isNull() ? -1 : query.value(14).toLongLong();
+    }
+    return runs;
+}
+
+/*
+ * 内层每次测试一行, 把各项的失败/未测完/重试展开成列; 外层按分钟求和.
+ * 各列的判定与 YieldCounters::add 相同.
+ */
+QVector<QPair<qint64, YieldCounters>> selectYieldByMinute(const QSqlDatabase &db, qint64 fromMs, qint64 toMs)
+{
+    QVector<QPair<qint64, YieldCounters>> minutes;
+    QStringList perRun;
+    QStringList sums;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        perRun << QString("SUM(i.item = %1 AND i.done AND NOT i.pass) AS f%1").arg(i)
+               << QString("SUM(i.item = %1 AND NOT i.done) AS m%1").arg(i)
+               << QString("SUM(i.item = %1 AND i.attempts > 1) AS r%1").arg(i);
+        sums << QString("SUM(f%1), SUM(m%1), SUM(r%1)").arg(i);
+    }
+    for (int ch = 0; ch < YIELD_485_CHANNELS; ch++)
+        sums << QString("SUM(f%1 > 0 AND (mask_485 & %2) = 0)").arg(TEST_IDX_485).arg(1u << ch);
+    const QString sql = QString("SELECT minute, COUNT(*), SUM(result = %1), SUM(result = %1 AND retried = 0),"
+                                " SUM(result = %2), %3, SUM(cycle_ms), COUNT(cycle_ms)"
+                                " FROM (SELECT r.started_at / 60000 AS minute, r.result, r.cycle_ms, r.mask_485,"
+                                " MAX(i.attempts > 1) AS retried, %4"
+                                " FROM runs r JOIN items i ON i.run_id = r.id"
+                                " WHERE r.started_at >= ? AND r.started_at < ? GROUP BY r.id)"
+                                " GROUP BY minute ORDER BY minute")
+            .arg(ComTest::GZ_END_SUCCESS).arg(ComTest::GZ_END_COM_TIMEOUT)
+            .arg(sums.join(", ")).arg(perRun.join(", "));
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    query.bindValue(0, fromMs);
+    query.bindValue(1, toMs);
+    if (!query.exec()) {
+        qCWarning(lcStore) << "yield query failed:" << query.lastError().text();
+        return minutes;
+    }
+    while (query.next()) {
+        YieldCounters counters;
+        int col = 1;
+        counters.runs = query.value(col++).toUInt();
+        counters.passed = query.value(col++).toUInt();
+        counters.firstPass = query.value(col++).toUInt();
+        counters.timeouts = query.value(col++).toUInt();
+        for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+            counters.itemFailed[i] = query.value(col++).toUInt();
+            counters.itemMissing[i] = query.value(col++).toUInt();
+            counters.itemRetried[i] = query.value(col++).toUInt();
+        }
+        for (int ch = 0; ch < YIELD_485_CHANNELS; ch++)
+            counters.channel485Failed[ch] = query.value(col++).toUInt();
+        counters.cycleMsSum = query.value(col++).toLongLong();
+        counters.cycles = query.value(col++).toUInt();
+        minutes.append(qMakePair(query.value(0).toLongLong() * 60000, counters));
+    }
+    return minutes;
+}
+
+}
+
+class ResultStore::Thread : public QThread
+{
+public:
+    explicit Thread(ResultStore *store) : m_store(store) { setObjectName("resultStore"); }
+
+protected:
+    void run() override { m_store->run(); }
+
+private:
+    ResultStore *m_store;
+};
+
+ResultStore::ResultStore()
+    : m_receiver(new QObject)
+{
+}
+
+ResultStore::~ResultStore()
+{
+    close();
+}
+
+bool ResultStore::open(const QString &fileName)
+{
+    close();
+    if (fileName.isEmpty())
+        return false;
+
+    m_fileName = fileName;
+    m_pending.clear();
+    m_pending.reserve(RESULT_BATCH_RUNS);
+    m_tasks.clear();
+    m_queued = 0;
+    m_handled = 0;
+    m_stopping = false;
+    m_flushRequested = false;
+    m_failed = false;
+    m_error.clear();
+
+    m_thread.reset(new Thread(this));
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void ResultStore::close(void)
+{
+    if (m_thread == nullptr)
+        return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    m_thread->wait();
+    m_thread.reset();
+    if (droppedRuns() > 0)
+        qCWarning(lcStore) << m_fileName << "dropped" << droppedRuns() << "runs";
+}
+
+QString ResultStore::errorString(void) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_error;
+}
+
+void ResultStore::record(const RunRecord &run)
+{
+    if (m_thread == nullptr)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_failed || m_pending.size() >= RESULT_MAX_PENDING) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_pending.append(run);
+    m_queued++;
+    if (m_pending.size() >= RESULT_BATCH_RUNS)
+        m_wake.wakeOne();
+}
+
+void ResultStore::flush(void)
+{
+    if (m_thread == nullptr)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    const quint64 target = m_queued;
+    while (m_handled < target) {
+        m_flushRequested = true;
+        m_wake.wakeOne();
+        m_committed.wait(&m_mutex);
+    }
+}
+
+void ResultStore::post(Task task)
+{
+    QMutexLocker locker(&m_mutex);
+    m_tasks.append(std::move(task));
+    m_wake.wakeOne();
+}
+
+void ResultStore::queryAsync(const QString &serial, qint64 fromMs, qint64 toMs, int limit,
+                             QObject *context, QueryCallback done)
+{
+    if (m_thread == nullptr)
+        return;
+
+    // 后台线程只把结果交给 m_receiver(它比后台线程活得久), 在创建线程中再检查 context 是否还在
+    QObject *receiver = m_receiver.get();
+    QPointer<QObject> guard(context);
+    post([=](const QString &connection) {
+        const QVector<RunRecord> runs = selectRuns(QSqlDatabase::database(connection, false), serial, fromMs, toMs, limit);
+        QMetaObject::invokeMethod(receiver, [guard, done, runs]() {
+            if (guard)
+                done(runs);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ResultStore::yieldByMinuteAsync(qint64 fromMs, qint64 toMs, QObject *context, YieldCallback done)
+{
+    if (m_thread == nullptr)
+        return;
+
+    QObject *receiver = m_receiver.get();
+    QPointer<QObject> guard(context);
+    post([=](const QString &connection) {
+        const QVector<QPair<qint64, YieldCounters>> minutes = selectYieldByMinute(QSqlDatabase::database(connection, false), fromMs, toMs);
+        QMetaObject::invokeMethod(receiver, [guard, done, minutes]() {
+            if (guard)
+                done(minutes);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ResultStore::run(void)
+{
+    const QString connection = QString("gz_results_%1").arg(reinterpret_cast<quintptr>(this), 0, 16);
+    const bool opened = openDatabase(connection);
+    if (!opened) {
+        QMutexLocker locker(&m_mutex);
+        m_failed = true;
+    }
+
+    QVector<RunRecord> batch;
+    batch.reserve(RESULT_BATCH_RUNS);
+    QVector<Task> tasks;
+    bool stopping = false;
+    while (!stopping) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_pending.size() < RESULT_BATCH_RUNS && m_tasks.isEmpty() && !m_stopping && !m_flushRequested)
+                m_wake.wait(&m_mutex, RESULT_FLUSH_MS);
+            // 交换队列, 写库和查询时不持有锁
+            batch.swap(m_pending);
+            tasks.swap(m_tasks);
+            stopping = m_stopping;
+            m_flushRequested = false;
+        }
+
+        if (!batch.isEmpty()) {
+            const quint64 n = static_cast<quint64>(batch.size());
+            if (opened && writeBatch(connection, batch)) {
+                m_written.fetch_add(n, std::memory_order_relaxed);
+                m_batches.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                m_dropped.fetch_add(n, std::memory_order_relaxed);
+            }
+            batch.resize(0);
+
+            QMutexLocker locker(&m_mutex);
+            m_handled += n;
+            m_committed.wakeAll();
+        }
+
+        // 查询排在同时取出的记录之后, 能查到它们
+        for (const Task &task : tasks)
+            task(connection);
+        tasks.clear();
+    }
+
+    {
+        QSqlDatabase db = QSqlDatabase::database(connection, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+}
+
+bool ResultStore::openDatabase(const QString &connection)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+    db.setDatabaseName(m_fileName);
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=2000");
+    if (!db.open()) {
+        QMutexLocker locker(&m_mutex);
+        m_error = db.lastError().text();
+        qCWarning(lcStore) << "open" << m_fileName << "failed:" << m_error;
+        return false;
+    }
+
+    // WAL: 写入不阻塞查询; NORMAL 在 WAL 下只在检查点时 fsync, 掉电最多丢最后几批
+    QSqlQuery query(db);
+    QStringList statements;
+    statements << "PRAGMA journal_mode=WAL" << "PRAGMA synchronous=NORMAL";
+    for (const char *statement : kSchema)
+        statements << statement;
+    statements << QString("PRAGMA user_version=%1").arg(RESULT_SCHEMA_VERSION);
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            QMutexLocker locker(&m_mutex);
+            m_error = query.lastError().text();
+            qCWarning(lcStore) << m_fileName << statement << "failed:" << m_error;
+            return false;
+        }
+    }
+    qCInfo(lcStore) << "results database" << m_fileName;
+    return true;
+}
+
+bool ResultStore::writeBatch(const QString &connection, const QVector<RunRecord> &batch)
+{
+    QSqlDatabase db = QSqlDatabase::database(connection, false);
+    if (!db.transaction()) {
+        qCWarning(lcStore) << "begin failed:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery runInsert(db);
+    runInsert.prepare("INSERT INTO runs (serial, port, started_at, result, pipelined, protocol, cycle_ms, mask_485, capture)"
+                      " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    QSqlQuery itemInsert(db);
+    itemInsert.prepare("INSERT INTO items (run_id, item, done, pass, attempts, rtt_us) VALUES (?, ?, ?, ?, ?, ?)");
+
+    bool ok = true;
+    for (const RunRecord &run : batch) {
+        runInsert.bindValue(0, run.serial);
+        runInsert.bindValue(1, run.port);
+        runInsert.bindValue(2, run.startedAt);
+        runInsert.bindValue(3, run.result);
+        runInsert.bindValue(4, run.pipelined ? 1 : 0);
+        runInsert.bindValue(5, run.protocol);
+        runInsert.bindValue(6, nullIfNegative(run.cycleMs));
+        runInsert.bindValue(7, run.mask485);
+        runInsert.bindValue(8, run.capture.isEmpty() ? QVariant(QVariant::String) : QVariant(run.capture));
+        if (!runInsert.exec()) {
+            qCWarning(lcStore) << "insert run failed:" << runInsert.lastError().text();
+            ok = false;
+            break;
+        }
+        const qint64 runId = runInsert.lastInsertId().toLongLong();
+        for (int i = 0; i < TEST_ITEMS_NUM && ok; i++) {
+            itemInsert.bindValue(0, runId);
+            itemInsert.bindValue(1, i);
+            itemInsert.bindValue(2, run.done[i] ? 1 : 0);
+            itemInsert.bindValue(3, run.pass[i] ? 1 : 0);
+            itemInsert.bindValue(4, run.attempts[i]);
+            itemInsert.bindValue(5, nullIfNegative(run.rttUs[i]));
+            if (!itemInsert.exec()) {
+                qCWarning(lcStore) << "insert item failed:" << itemInsert.lastError().text();
+                ok = false;
+            }
+        }
+        if (!ok)
+            break;
+    }
+
+    if (!ok) {
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        qCWarning(lcStore) << "commit failed:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+QVector<RunRecord> ResultStore::query(const QString &serial, qint64 fromMs, qint64 toMs, int limit) const
+{
+    static std::atomic<quint32> s_connectionId{0};
+    const QString connection = QString("gz_results_query_%1").arg(s_connectionId.fetch_add(1));
+
+    QVector<RunRecord> runs;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(m_fileName);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=2000");
+        if (!db.open())
+            qCWarning(lcStore) << "query open" << m_fileName << "failed:" << db.lastError().text();
+        else
+            runs = selectRuns(db, serial, fromMs, toMs, limit);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return runs;
+}
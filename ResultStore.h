@@ -0,0 +1,115 @@
+#ifndef RESULTSTORE_H
+#define RESULTSTORE_H
+
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "ComTest.h"
+
+class QObject;
+struct YieldCounters;
+
+/*
+ * 一次测试的记录, 测试结束时由 TestStation 从 ComTest 拷贝出来(ComTest 下次开始时会 Reset)
+ */
+struct RunRecord {
+    qint64 id = 0;              // 数据库中的行号, 查询结果才有
+    QString serial;             // 板号, 未输入时为空
+    QString port;
+    qint64 startedAt = 0;       // 开始时间, 1970 以来的毫秒数(UTC)
+    int result = -1;            // eTestEndResult
+    bool pipelined = false;
+    int protocol = ComTest::GZ_PROTO_ASCII;
+    qint64 cycleMs = -1;
+    quint32 mask485 = 0;        // 485 未通过时各通道的结果, 位为 1 表示该通道正常
+    QString capture;            // 抓包文件, 未抓包时为空
+    bool done[TEST_ITEMS_NUM] = {};
+    bool pass[TEST_ITEMS_NUM] = {};
+    int attempts[TEST_ITEMS_NUM] = {};
+    qint64 rttUs[TEST_ITEMS_NUM] = {};  // 没收到应答时为 -1
+};
+
+/*
+ * 测试结果库: 嵌入式 SQLite(WAL), 每次测试一行 runs 和各测试项一行 items,
+ * 按板号+时间、时间建索引. record 只把记录放入内存队列, 由后台线程定时或攒够一批后
+ * 在一个事务中写入, 测试路径上没有磁盘IO. 后台来不及写时队列有上限, 超出的记录丢弃并计数.
+ * 数据库连接只在后台线程中使用; queryAsync 也在后台线程中执行, 结果回到调用线程.
+ * query 在调用线程中另开只读连接, WAL 下不阻塞写入, 但会阻塞调用线程, 不要在界面线程中使用.
+ */
+class ResultStore
+{
+#define    RESULT_FLUSH_MS        500
+#define    RESULT_BATCH_RUNS      64
+#define    RESULT_MAX_PENDING     10000
+#define    RESULT_SCHEMA_VERSION  1
+
+public:
+    typedef std::function<void(const QVector<RunRecord> &runs)> QueryCallback;
+    // first 为该分钟的开始时间
+    typedef std::function<void(const QVector<QPair<qint64, YieldCounters>> &minutes)> YieldCallback;
+
+    // 在创建它的线程(界面线程)中使用, queryAsync 的结果在该线程的事件循环中交回
+    ResultStore();
+    ~ResultStore();
+
+    ResultStore(const ResultStore &) = delete;
+    ResultStore &operator=(const ResultStore &) = delete;
+
+    // 启动后台线程, 在后台打开(不存在时创建)数据库, 不等待打开结果; 打开失败时之后的记录丢弃
+    bool open(const QString &fileName);
+    // 写完队列中剩余的记录后关闭
+    void close(void);
+    bool isOpen(void) const { return m_thread != nullptr; }
+    QString fileName(void) const { return m_fileName; }
+    QString errorString(void) const;
+
+    void record(const RunRecord &run);
+    // 阻塞到目前为止的记录都已提交
+    void flush(void);
+
+    // 按板号(为空时不限)和开始时间 [fromMs, toMs) 查询, 按时间倒序, 最多 limit 条
+    QVector<RunRecord> query(const QString &serial, qint64 fromMs, qint64 toMs, int limit = 1000) const;
+    // 同上, 在后台线程中排在已入队的记录之后执行, 完成后调用 done; context 先销毁或库已关闭时不调用
+    void queryAsync(const QString &serial, qint64 fromMs, qint64 toMs, int limit, QObject *context, QueryCallback done);
+    // 开始时间在 [fromMs, toMs) 内的记录在库中按分钟汇总成良率计数(由旧到新, 每分钟一行), 与逐条
+    // YieldCounters::add 的结果相同; 同样在后台线程中执行, 一天最多 1440 行, 不把记录逐条读出
+    void yieldByMinuteAsync(qint64 fromMs, qint64 toMs, QObject *context, YieldCallback done);
+
+    quint64 runsWritten(void) const { return m_written.load(std::memory_order_relaxed); }
+    quint64 droppedRuns(void) const { return m_dropped.load(std::memory_order_relaxed); }
+    quint64 batchesWritten(void) const { return m_batches.load(std::memory_order_relaxed); }
+
+private:
+    class Thread;
+    typedef std::function<void(const QString &connection)> Task;
+    void post(Task task);
+    void run(void);
+    bool openDatabase(const QString &connection);
+    bool writeBatch(const QString &connection, const QVector<RunRecord> &batch);
+
+private:
+    QString m_fileName;
+    std::unique_ptr<Thread> m_thread;
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QWaitCondition m_committed;
+    QVector<RunRecord> m_pending;
+    QVector<Task> m_tasks;      // 后台线程中执行的查询
+    std::unique_ptr<QObject> m_receiver;  // 属于创建线程, 后台查询的结果经它排队交回
+    quint64 m_queued = 0;       // 已入队的记录数, 不含丢弃的
+    quint64 m_handled = 0;      // 后台已处理(提交或丢弃)的记录数
+    bool m_stopping = false;
+    bool m_flushRequested = false;
+    bool m_failed = false;      // 数据库打不开, 之后的记录直接丢弃
+    QString m_error;
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_batches{0};
+};
+
+#endif // RESULTSTORE_H
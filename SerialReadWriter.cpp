@@ -3,7 +3,7 @@
 //
 
 #include "SerialReadWriter.h"
-#include <QDebug>
+#include "Logging.h"
 
 SerialReadWriter::SerialReadWriter(QObject *parent) : AbstractReadWriter(parent) {
 
@@ -12,19 +12,40 @@ SerialReadWriter::SerialReadWriter(QObject *parent) : AbstractReadWriter(parent)
 bool SerialReadWriter::open() {
     close();
 
-    serial = new QSerialPort(this);
+    // QSerialPort 对象在重新打开时复用
+    if (serial == nullptr) {
+        serial = new QSerialPort(this);
+        connect(serial, &QSerialPort::readyRead, this, &SerialReadWriter::readyRead);
+        connect(serial, &QSerialPort::errorOccurred, this, &SerialReadWriter::onError);
+    }
     serial->setPortName(settings.name);
+    applySettings();
+
+    return serial->open(QIODevice::ReadWrite);
+}
+
+void SerialReadWriter::applySettings() {
     serial->setBaudRate(settings.baudRate);
     serial->setDataBits(settings.dataBits);
     serial->setParity(settings.parity);
     serial->setStopBits(settings.stopBits);
     serial->setFlowControl(settings.flowControl);
+}
 
-    if (serial->open(QIODevice::ReadWrite)) {
-        connect(serial, &QSerialPort::readyRead, this, &SerialReadWriter::readyRead);
-        return true;
-    } else {
-        return false;
+void SerialReadWriter::onError(QSerialPort::SerialPortError error) {
+    if (error != QSerialPort::ResourceError || !serial->isOpen()) {
+        return;
+    }
+    // 设备被拔出, 之后的读写都会失败; 关闭后让上层重新打开
+    qCWarning(lcTransport) << settings.name << "resource error:" << serial->errorString();
+    serial->close();
+    emit connectionChanged(false);
+}
+
+void SerialReadWriter::discardBuffers() {
+    if (serial != nullptr && serial->isOpen()) {
+        serial->clear(QSerialPort::AllDirections);
+        serial->readAll();
     }
 }
 
@@ -36,27 +57,35 @@ QByteArray SerialReadWriter::readAll() {
     if (serial != nullptr && serial->isOpen()) {
         return serial->readAll();
     }
-    qDebug() << "SerialReadWriter readAll() _serial == nullptr or not open";
+    qCDebug(lcTransport) << "SerialReadWriter readAll() _serial == nullptr or not open";
     return QByteArray();
 }
 
+qint64 SerialReadWriter::read(char *data, qint64 maxSize) {
+    if (serial != nullptr && serial->isOpen()) {
+        return serial->read(data, maxSize);
+    }
+    return 0;
+}
+
 qint64 SerialReadWriter::write(const QByteArray &byteArray) const {
     if (serial != nullptr && serial->isOpen()) {
         return serial->write(byteArray);
     }
-    qDebug() << "SerialReadWriter readAll() _serial == nullptr or not open";
+    qCDebug(lcTransport) << "SerialReadWriter readAll() _serial == nullptr or not open";
     return 0;
 }
 
 void SerialReadWriter::setSerialSettings(SerialSettings serialSettings) {
     this->settings = std::move(serialSettings);
+    if (serial != nullptr && serial->isOpen()) {
+        applySettings();
+    }
 }
 
 void SerialReadWriter::close() {
     if (serial != nullptr) {
         serial->close();
-        delete serial;
-        serial = nullptr;
     }
 }
 
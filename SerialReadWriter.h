@@ -16,6 +16,19 @@ struct SerialSettings {
     QSerialPort::StopBits stopBits;
     QSerialPort::FlowControl flowControl;
     bool localEchoEnabled;
+
+    // 工装板固定使用 115200 8N1, 无流控
+    static SerialSettings fixture(const QString &portName) {
+        SerialSettings settings;
+        settings.name = portName;
+        settings.baudRate = QSerialPort::Baud115200;
+        settings.dataBits = QSerialPort::Data8;
+        settings.parity = QSerialPort::NoParity;
+        settings.stopBits = QSerialPort::OneStop;
+        settings.flowControl = QSerialPort::NoFlowControl;
+        settings.localEchoEnabled = false;
+        return settings;
+    }
 };
 
 
@@ -24,6 +37,7 @@ Q_OBJECT
 public:
     explicit SerialReadWriter(QObject *parent = nullptr);
 
+    // 端口已打开时直接修改波特率等参数, 不重新打开
     void setSerialSettings(SerialSettings serialSettings);
 
     QString settingsText() const override;
@@ -38,8 +52,17 @@ public:
 
     QByteArray readAll() override;
 
+    qint64 read(char *data, qint64 maxSize) override;
+
     qint64 write(const QByteArray &byteArray) const override;
 
+    void discardBuffers() override;
+
+private:
+    void applySettings();
+
+    void onError(QSerialPort::SerialPortError error);
+
 private:
     SerialSettings settings;
     QSerialPort *serial{nullptr};
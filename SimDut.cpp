@@ -0,0 +1,176 @@
+#include "SimDut.h"
+#include "AckParser.h"
+#include "BinaryProtocol.h"
+
+#include <QStringList>
+
+namespace {
+
+int itemIndex(const QString &name)
+{
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        if (name == ComTest::itemName(i))
+            return i;
+    }
+    return -1;
+}
+
+void setItems(bool *flags, const QString &value)
+{
+    for (const QString &name : value.split('+')) {
+        int id = itemIndex(name.trimmed());
+        if (id >= 0)
+            flags[id] = true;
+    }
+}
+
+}
+
+SimDutConfig::SimDutConfig()
+{
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        pass[i] = true;
+        drop[i] = false;
+        flaky[i] = false;
+    }
+}
+
+bool SimDutConfig::isSimSpec(const QString &portName)
+{
+    return portName.compare("sim", Qt::CaseInsensitive) == 0
+           || portName.startsWith("sim:", Qt::CaseInsensitive);
+}
+
+SimDutConfig SimDutConfig::fromSpec(const QString &spec)
+{
+    SimDutConfig config;
+    const int colon = spec.indexOf(':');
+    if (colon < 0)
+        return config;
+
+    for (const QString &option : spec.mid(colon + 1).split(',')) {
+        if (option.isEmpty())
+            continue;
+        const QString key = option.section('=', 0, 0).trimmed();
+        const QString value = option.section('=', 1).trimmed();
+        if (key == "nack") {
+            bool nack[TEST_ITEMS_NUM] = { false };
+            setItems(nack, value);
+            for (int i = 0; i < TEST_ITEMS_NUM; i++)
+                config.pass[i] = !nack[i];
+        } else if (key == "mask") {
+            config.mask485 = value.toUInt(nullptr, 16);
+        } else if (key == "delay") {
+            config.delayMs = value.toInt();
+        } else if (key == "jitter") {
+            config.jitterMs = value.toInt();
+        } else if (key == "split") {
+            config.splitChunks = qMax(1, value.toInt());
+        } else if (key == "gap") {
+            config.chunkGapMs = value.toInt();
+        } else if (key == "drop") {
+            setItems(config.drop, value);
+        } else if (key == "flaky") {
+            setItems(config.flaky, value);
+        } else if (key == "droprate") {
+            config.dropRate = value.toDouble();
+        } else if (key == "term") {
+            config.terminator = (value == "none") ? QByteArray() : QByteArray("\r\n");
+        } else if (key == "proto") {
+            config.binary = (value == "bin");
+        }
+    }
+    return config;
+}
+
+SimDut::SimDut(const SimDutConfig &config)
+    : m_config(config)
+    , m_rng(20191126)
+{
+    for (int i = 0; i < TEST_ITEMS_NUM; i++)
+        m_commandCnt[i] = 0;
+    m_clock.start();
+}
+
+bool SimDut::decide(int id, bool *pass)
+{
+    if (m_config.drop[id])
+        return false;
+    *pass = m_config.pass[id] && !(m_config.flaky[id] && (m_commandCnt[id]++ % 2) == 0);
+
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    return !(m_config.dropRate > 0.0 && uniform(m_rng) < m_config.dropRate);
+}
+
+QList<SimReply> SimDut::respond(const char *command, int len)
+{
+    if (BinaryProtocol::isFrame(command, len))
+        return respondBinary(command, len);
+
+    if (BinaryProtocol::isHello(command, len)) {
+        if (!m_config.binary)
+            return QList<SimReply>();
+        return schedule(QByteArray(BinaryProtocol::kHelloAck) + m_config.terminator);
+    }
+
+    /* eg. command: gz_test com uart_debug */
+    AckParser::Token tokens[3];
+    if (AckParser::tokenize(command, len, tokens, 3) < 3)
+        return QList<SimReply>();
+    const int id = itemIndex(QString::fromLatin1(tokens[2].data, tokens[2].len));
+    bool pass;
+    if (id < 0 || !decide(id, &pass))
+        return QList<SimReply>();
+
+    QByteArray reply("gz_test com ");
+    reply.append(pass ? "ack " : "nack ");
+    reply.append(ComTest::itemName(id));
+    if (!pass && id == TEST_IDX_485) {
+        reply.append(' ');
+        reply.append(QByteArray::number(m_config.mask485, 16));
+    }
+    reply.append(m_config.terminator);
+    return schedule(reply);
+}
+
+QList<SimReply> SimDut::respondBinary(const char *command, int len)
+{
+    // 没有协商过二进制协议的板子不认识二进制帧
+    const int id = BinaryProtocol::itemOfCommand(command, len);
+    bool pass;
+    if (!m_config.binary || id < 0 || !decide(id, &pass))
+        return QList<SimReply>();
+
+    char mask[4];
+    int maskLen = 0;
+    if (!pass && id == TEST_IDX_485) {
+        for (uint32_t v = m_config.mask485; maskLen == 0 || (v != 0 && maskLen < 4); v >>= 8)
+            mask[maskLen++] = static_cast<char>(v & 0xFF);
+    }
+    return schedule(BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, id,
+                                           pass ? BinaryProtocol::STATUS_ACK : BinaryProtocol::STATUS_NACK,
+                                           mask, maskLen));
+}
+
+QList<SimReply> SimDut::schedule(const QByteArray &reply)
+{
+    QList<SimReply> replies;
+    int delay = m_config.delayMs;
+    if (m_config.jitterMs > 0)
+        delay += static_cast<int>(m_rng() % static_cast<unsigned>(m_config.jitterMs + 1));
+    // 前一条回复还没发完时排在它后面: 发送时刻 = max(现在, 上一条发完) + 延时
+    const qint64 now = m_clock.elapsed();
+    delay += static_cast<int>(qMax<qint64>(0, m_busyUntilMs - now));
+
+    // 拆分成若干段, 模拟一条回复跨多次 readyRead 到达
+    const int chunks = qMin(m_config.splitChunks, reply.size());
+    const int chunkLen = (reply.size() + chunks - 1) / chunks;
+    for (int offset = 0, i = 0; offset < reply.size(); offset += chunkLen, i++) {
+        SimReply part;
+        part.delayMs = delay + i * m_config.chunkGapMs;
+        part.data = reply.mid(offset, chunkLen);
+        replies.append(part);
+    }
+    m_busyUntilMs = now + replies.last().delayMs;
+    return replies;
+}
@@ -0,0 +1,82 @@
+#ifndef SIMDUT_H
+#define SIMDUT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <cstdint>
+#include <random>
+#include "ComTest.h"
+
+/*
+ * 模拟被测板的行为配置. 端口名写成 "sim" 或 "sim:<选项>" 即使用模拟设备, 选项以逗号分隔:
+ *   nack=485+can    这些测试项回复 nack
+ *   mask=7f         nack 485 时携带的通道掩码(十六进制)
+ *   delay=20        回复延时(ms)
+ *   jitter=5        回复延时随机抖动上限(ms)
+ *   split=3         每条回复拆成3段分别到达
+ *   gap=2           拆分后各段的间隔(ms)
+ *   drop=can        这些测试项永不回复
+ *   flaky=485       这些测试项 nack/ack 交替回复, 第一次为 nack
+ *   droprate=0.05   每条回复随机丢弃的概率
+ *   term=none       回复不带结束符(默认 \r\n)
+ *   proto=bin       支持二进制协议协商(默认与旧固件一样不回复协商命令)
+ */
+struct SimDutConfig {
+    bool pass[TEST_ITEMS_NUM];
+    bool drop[TEST_ITEMS_NUM];
+    bool flaky[TEST_ITEMS_NUM];
+    uint32_t mask485 = 0;
+    int delayMs = 0;
+    int jitterMs = 0;
+    int splitChunks = 1;
+    int chunkGapMs = 0;
+    double dropRate = 0.0;
+    QByteArray terminator = "\r\n";
+    bool binary = false;
+
+    SimDutConfig();
+
+    static bool isSimSpec(const QString &portName);
+    static SimDutConfig fromSpec(const QString &spec);
+};
+
+// 一段待发送的回复, delayMs 为相对收到命令的时间
+struct SimReply {
+    int delayMs;
+    QByteArray data;
+};
+
+/*
+ * 模拟被测板的协议逻辑, 与传输方式无关:
+ * 收到 "gz_test com <item>" 或二进制命令帧后按配置生成 ack/nack 回复, 回复格式与命令相同.
+ * 与固件一样按收到的顺序逐条处理: 一条回复发完后才开始计下一条的延时, 抖动不会让回复乱序.
+ */
+class SimDut
+{
+public:
+    explicit SimDut(const SimDutConfig &config = SimDutConfig());
+
+    const SimDutConfig &config(void) const { return m_config; }
+
+    // 处理一条命令, 返回要发送的回复段; 不认识的命令或被丢弃时返回空
+    QList<SimReply> respond(const char *command, int len);
+    // 丢弃还没发出的回复后调用, 之后的命令不再排在它们后面
+    void reset(void) { m_busyUntilMs = 0; }
+
+private:
+    // 按配置决定该测试项是否回复及是否通过, 丢弃时返回 false
+    bool decide(int id, bool *pass);
+    QList<SimReply> schedule(const QByteArray &reply);
+    QList<SimReply> respondBinary(const char *command, int len);
+
+private:
+    SimDutConfig m_config;
+    std::mt19937 m_rng;
+    quint32 m_commandCnt[TEST_ITEMS_NUM];
+    QElapsedTimer m_clock;
+    qint64 m_busyUntilMs = 0;   // 已安排的最后一段回复的发送时刻
+};
+
+#endif // SIMDUT_H
@@ -0,0 +1,91 @@
+#include "SimDutServer.h"
+#include "FrameParser.h"
+
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+#include <memory>
+
+SimDutServer::SimDutServer(const SimDutConfig &config, QObject *parent)
+    : QObject(parent)
+    , m_dut(config)
+    , m_tcpServer(new QTcpServer(this))
+    , m_udpSocket(new QUdpSocket(this))
+{
+    connect(m_tcpServer, &QTcpServer::newConnection, this, &SimDutServer::onNewConnection);
+    connect(m_udpSocket, &QUdpSocket::readyRead, this, &SimDutServer::onDatagrams);
+}
+
+bool SimDutServer::listen(const QHostAddress &address, quint16 port)
+{
+    if (!m_tcpServer->listen(address, port)) {
+        m_errorString = m_tcpServer->errorString();
+        return false;
+    }
+    // UDP 使用与 TCP 相同的端口号
+    if (!m_udpSocket->bind(address, m_tcpServer->serverPort())) {
+        m_errorString = m_udpSocket->errorString();
+        m_tcpServer->close();
+        return false;
+    }
+    return true;
+}
+
+quint16 SimDutServer::port(void) const
+{
+    return m_tcpServer->serverPort();
+}
+
+void SimDutServer::onNewConnection(void)
+{
+    while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        serveTcp(socket);
+    }
+}
+
+void SimDutServer::serveTcp(QTcpSocket *socket)
+{
+    // 每个连接一个命令解析器, 随连接一起释放
+    std::shared_ptr<FrameParser> parser(new FrameParser);
+    QPointer<QTcpSocket> peer(socket);
+    parser->setFrameHandler([this, peer](const char *data, int len) {
+        for (const SimReply &reply : m_dut.respond(data, len)) {
+            const QByteArray chunk = reply.data;
+            QTimer::singleShot(reply.delayMs, this, [peer, chunk]() {
+                if (peer)
+                    peer->write(chunk);
+            });
+        }
+    });
+    connect(socket, &QTcpSocket::readyRead, this, [socket, parser]() {
+        // 命令不带结束符, 与 SimReadWriter 一样按到达的数据块交出最后一条
+        const QByteArray data = socket->readAll();
+        parser->feed(data.constData(), data.size());
+        parser->flush();
+    });
+}
+
+void SimDutServer::onDatagrams(void)
+{
+    // 每个数据报是一条完整命令, 回复发回来源地址
+    while (m_udpSocket->hasPendingDatagrams()) {
+        QByteArray command(static_cast<int>(m_udpSocket->pendingDatagramSize()), '\0');
+        QHostAddress sender;
+        quint16 senderPort = 0;
+        const qint64 n = m_udpSocket->readDatagram(command.data(), command.size(), &sender, &senderPort);
+        if (n < 0)
+            break;
+        command.resize(static_cast<int>(n));
+
+        for (const SimReply &reply : m_dut.respond(command.constData(), command.size())) {
+            const QByteArray chunk = reply.data;
+            QTimer::singleShot(reply.delayMs, this, [this, sender, senderPort, chunk]() {
+                m_udpSocket->writeDatagram(chunk, sender, senderPort);
+            });
+        }
+    }
+}
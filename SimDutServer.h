@@ -0,0 +1,42 @@
+#ifndef SIMDUTSERVER_H
+#define SIMDUTSERVER_H
+
+#include <QObject>
+#include <QHostAddress>
+#include "SimDut.h"
+
+class QTcpServer;
+class QTcpSocket;
+class QUdpSocket;
+
+/*
+ * 网口工装板的本地替身: 在同一端口号上同时监听 TCP 和 UDP, 用 SimDut 回复命令.
+ * 用于在没有网口板时联调 tcp:// / udp:// 端口, 以及网络传输的基准测试.
+ */
+class SimDutServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SimDutServer(const SimDutConfig &config = SimDutConfig(), QObject *parent = nullptr);
+
+    // port 为 0 时由系统分配, 用 port() 取实际端口
+    bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 0);
+    quint16 port(void) const;
+    QString errorString(void) const { return m_errorString; }
+
+private slots:
+    void onNewConnection(void);
+    void onDatagrams(void);
+
+private:
+    void serveTcp(QTcpSocket *socket);
+
+private:
+    SimDut m_dut;
+    QTcpServer *m_tcpServer;
+    QUdpSocket *m_udpSocket;
+    QString m_errorString;
+};
+
+#endif // SIMDUTSERVER_H
@@ -0,0 +1,89 @@
+#include "SimReadWriter.h"
+
+#include <QTimer>
+#include <cstring>
+
+SimReadWriter::SimReadWriter(const SimDutConfig &config, QObject *parent)
+        : AbstractReadWriter(parent), dut(config) {
+    commandParser.setFrameHandler([this](const char *data, int len) {
+        onCommand(data, len);
+    });
+}
+
+QString SimReadWriter::settingsText() const {
+    const SimDutConfig &config = dut.config();
+    return QString("simulated DUT, delay %1 ms, split %2, drop rate %3")
+            .arg(config.delayMs).arg(config.splitChunks).arg(config.dropRate);
+}
+
+bool SimReadWriter::open() {
+    opened = true;
+    session++;
+    return true;
+}
+
+bool SimReadWriter::isOpen() {
+    return opened;
+}
+
+bool SimReadWriter::isConnected() {
+    return opened;
+}
+
+void SimReadWriter::close() {
+    opened = false;
+    session++;
+    rxBuff.clear();
+    commandParser.reset();
+    dut.reset();
+}
+
+void SimReadWriter::discardBuffers() {
+    // 上一块板还没投递的回复也作废
+    session++;
+    rxBuff.clear();
+    commandParser.reset();
+    dut.reset();
+}
+
+QByteArray SimReadWriter::readAll() {
+    QByteArray data;
+    data.swap(rxBuff);
+    return data;
+}
+
+qint64 SimReadWriter::read(char *data, qint64 maxSize) {
+    const int n = static_cast<int>(qMin<qint64>(maxSize, rxBuff.size()));
+    memcpy(data, rxBuff.constData(), static_cast<size_t>(n));
+    rxBuff.remove(0, n);
+    return n;
+}
+
+qint64 SimReadWriter::write(const QByteArray &byteArray) const {
+    if (!opened) {
+        return 0;
+    }
+    // 接口要求 write 为 const, 模拟设备收到命令后的状态变化在这里完成
+    auto self = const_cast<SimReadWriter *>(this);
+    self->commandParser.feed(byteArray.constData(), byteArray.size());
+    self->commandParser.flush();
+    return byteArray.size();
+}
+
+void SimReadWriter::onCommand(const char *data, int len) {
+    const quint64 current = session;
+    for (const SimReply &reply : dut.respond(data, len)) {
+        const QByteArray chunk = reply.data;
+        QTimer::singleShot(reply.delayMs, this, [this, current, chunk]() {
+            deliver(current, chunk);
+        });
+    }
+}
+
+void SimReadWriter::deliver(quint64 replySession, const QByteArray &data) {
+    if (!opened || replySession != session) {
+        return;
+    }
+    rxBuff.append(data);
+    emit readyRead();
+}
@@ -0,0 +1,49 @@
+#ifndef SIMREADWRITER_H
+#define SIMREADWRITER_H
+
+#include <QByteArray>
+#include "AbstractReadWriter.h"
+#include "FrameParser.h"
+#include "SimDut.h"
+
+/*
+ * 不需要真实工装板的模拟端口: 写入的命令交给 SimDut, 回复按配置的延时、拆分和丢弃
+ * 通过 readyRead 返回, 用于回归测试和测试周期基准.
+ */
+class SimReadWriter : public AbstractReadWriter {
+Q_OBJECT
+public:
+    explicit SimReadWriter(const SimDutConfig &config, QObject *parent = nullptr);
+
+    QString settingsText() const override;
+
+    bool open() override;
+
+    bool isOpen() override;
+
+    bool isConnected() override;
+
+    void close() override;
+
+    QByteArray readAll() override;
+
+    qint64 read(char *data, qint64 maxSize) override;
+
+    qint64 write(const QByteArray &byteArray) const override;
+
+    void discardBuffers() override;
+
+private:
+    void onCommand(const char *data, int len);
+    void deliver(quint64 replySession, const QByteArray &data);
+
+private:
+    SimDut dut;
+    FrameParser commandParser;
+    QByteArray rxBuff;
+    bool opened{false};
+    quint64 session{0};  // close 之后不再投递上一会话的回复
+};
+
+
+#endif //SIMREADWRITER_H
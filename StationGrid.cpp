@@ -0,0 +1,156 @@
+#include "StationGrid.h"
+#include "ComTest.h"
+
+#include <QColor>
+#include <QHeaderView>
+
+StationGrid::StationGrid(QWidget *parent)
+    : QTableWidget(parent)
+{
+    setColumnCount(COL_NUM);
+    setHorizontalHeaderLabels(QStringList() << tr("端口") << tr("状态") << tr("进度") << tr("结果") << tr("通过/总数"));
+    verticalHeader()->setVisible(false);
+    verticalHeader()->setDefaultSectionSize(22);
+    horizontalHeader()->setStretchLastSection(true);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setSelectionMode(QAbstractItemView::NoSelection);
+    setFocusPolicy(Qt::NoFocus);
+}
+
+void StationGrid::setPorts(const QStringList &ports)
+{
+    // 保留已有端口的勾选状态
+    const QStringList checked = checkedPorts();
+
+    setRowCount(0);
+    setRowCount(ports.size());
+    m_passCnt.fill(0, ports.size());
+    m_totalCnt.fill(0, ports.size());
+    for (int row = 0; row < ports.size(); row++) {
+        auto portItem = new QTableWidgetItem(ports.at(row));
+        portItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+        portItem->setCheckState(checked.contains(ports.at(row)) ? Qt::Checked : Qt::Unchecked);
+        setItem(row, COL_PORT, portItem);
+        cell(row, COL_STATE)->setText(tr("空闲"));
+        cell(row, COL_COUNT)->setText("0/0");
+    }
+}
+
+void StationGrid::addPort(const QString &port, bool checked)
+{
+    if (rowOf(port) >= 0) {
+        if (checked)
+            setChecked(port, true);
+        return;
+    }
+    const int row = rowCount();
+    insertRow(row);
+    m_passCnt.append(0);
+    m_totalCnt.append(0);
+    auto portItem = new QTableWidgetItem(port);
+    portItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+    portItem->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+    setItem(row, COL_PORT, portItem);
+    cell(row, COL_STATE)->setText(tr("空闲"));
+    cell(row, COL_COUNT)->setText("0/0");
+}
+
+void StationGrid::removePort(const QString &port)
+{
+    const int row = rowOf(port);
+    if (row < 0)
+        return;
+    removeRow(row);
+    m_passCnt.remove(row);
+    m_totalCnt.remove(row);
+}
+
+void StationGrid::setChecked(const QString &port, bool checked)
+{
+    const int row = rowOf(port);
+    if (row >= 0)
+        item(row, COL_PORT)->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+}
+
+QStringList StationGrid::checkedPorts(void) const
+{
+    QStringList ports;
+    for (int row = 0; row < rowCount(); row++) {
+        auto portItem = item(row, COL_PORT);
+        if (portItem != nullptr && portItem->checkState() == Qt::Checked)
+            ports << portItem->text();
+    }
+    return ports;
+}
+
+int StationGrid::rowOf(const QString &port) const
+{
+    for (int row = 0; row < rowCount(); row++) {
+        auto portItem = item(row, COL_PORT);
+        if (portItem != nullptr && portItem->text() == port)
+            return row;
+    }
+    return -1;
+}
+
+QTableWidgetItem *StationGrid::cell(int row, int column)
+{
+    auto cellItem = item(row, column);
+    if (cellItem == nullptr) {
+        cellItem = new QTableWidgetItem;
+        cellItem->setFlags(Qt::ItemIsEnabled);
+        setItem(row, column, cellItem);
+    }
+    return cellItem;
+}
+
+void StationGrid::setState(const QString &port, const QString &state)
+{
+    int row = rowOf(port);
+    if (row < 0)
+        return;
+    cell(row, COL_STATE)->setText(state);
+}
+
+void StationGrid::setProgress(const QString &port, int part, int cnt)
+{
+    int row = rowOf(port);
+    if (row < 0)
+        return;
+    int percent = (100 / TEST_ITEMS_NUM) * part + cnt;
+    if (percent > 100)
+        percent = 100;
+    cell(row, COL_PROGRESS)->setText(QString("%1%").arg(percent));
+}
+
+void StationGrid::setResult(const QString &port, int result)
+{
+    int row = rowOf(port);
+    if (row < 0)
+        return;
+
+    QString text;
+    QColor color;
+    switch (result) {
+    case ComTest::GZ_END_SUCCESS:
+        text = tr("通过");
+        color = QColor(0xc8, 0xf0, 0xc8);
+        m_passCnt[row]++;
+        break;
+    case ComTest::GZ_END_FAILED:
+        text = tr("未通过");
+        color = QColor(0xf8, 0xc8, 0xc8);
+        break;
+    default:
+        text = tr("通信失败");
+        color = QColor(0xf8, 0xe0, 0xa0);
+        break;
+    }
+    m_totalCnt[row]++;
+
+    auto resultItem = cell(row, COL_RESULT);
+    resultItem->setText(text);
+    resultItem->setBackground(color);
+    cell(row, COL_STATE)->setText(tr("空闲"));
+    cell(row, COL_COUNT)->setText(QString("%1/%2").arg(m_passCnt[row]).arg(m_totalCnt[row]));
+}
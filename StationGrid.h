@@ -0,0 +1,49 @@
+#ifndef STATIONGRID_H
+#define STATIONGRID_H
+
+#include <QTableWidget>
+#include <QStringList>
+#include <QVector>
+
+/*
+ * 多工位模式下的状态表, 每行一个端口: 勾选参与测试, 显示进度、结果和累计通过数.
+ * 代替单工位模式的模态进度对话框, 各工位互不阻塞.
+ */
+class StationGrid : public QTableWidget
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        COL_PORT,
+        COL_STATE,
+        COL_PROGRESS,
+        COL_RESULT,
+        COL_COUNT,
+        COL_NUM
+    };
+
+    explicit StationGrid(QWidget *parent = nullptr);
+
+    void setPorts(const QStringList &ports);
+    // 热插拔时增删单个端口, 其余行的计数保持不变; 已有的端口只会被勾选, 不会取消勾选
+    void addPort(const QString &port, bool checked = false);
+    void removePort(const QString &port);
+    void setChecked(const QString &port, bool checked);
+    QStringList checkedPorts(void) const;
+
+public slots:
+    void setState(const QString &port, const QString &state);
+    void setProgress(const QString &port, int part, int cnt);
+    // result 为 ComTest::eTestEndResult
+    void setResult(const QString &port, int result);
+
+private:
+    int rowOf(const QString &port) const;
+    QTableWidgetItem *cell(int row, int column);
+
+    QVector<int> m_passCnt;
+    QVector<int> m_totalCnt;
+};
+
+#endif // STATIONGRID_H
@@ -0,0 +1,118 @@
+#include "TcpReadWriter.h"
+#include "Logging.h"
+
+#define    TCP_RECONNECT_MIN_MS    100
+#define    TCP_RECONNECT_MAX_MS    2000
+
+TcpReadWriter::TcpReadWriter(QObject *parent) : AbstractReadWriter(parent) {
+
+}
+
+void TcpReadWriter::setNetSettings(const NetSettings &netSettings) {
+    this->settings = netSettings;
+}
+
+bool TcpReadWriter::open() {
+    close();
+
+    // socket 和定时器在 open 中创建, 保证与读写者处于同一线程(IO线程)
+    socket = new QTcpSocket(this);
+    reconnectTimer = new QTimer(this);
+    reconnectTimer->setSingleShot(true);
+    connect(reconnectTimer, &QTimer::timeout, this, &TcpReadWriter::reconnect);
+    connect(socket, &QTcpSocket::readyRead, this, &TcpReadWriter::readyRead);
+    connect(socket, &QTcpSocket::stateChanged, this, &TcpReadWriter::onStateChanged);
+
+    // 不等待连接结果: 主机名解析和握手都在后台进行, 连上后发出 connectionChanged(true),
+    // 连不上按退避间隔重试, 由上层决定等多久
+    reconnectDelayMs = TCP_RECONNECT_MIN_MS;
+    linkUp = false;
+    opened = true;
+    socket->connectToHost(settings.host, settings.port);
+    return true;
+}
+
+bool TcpReadWriter::isOpen() {
+    return opened;
+}
+
+bool TcpReadWriter::isConnected() {
+    return socket != nullptr && socket->state() == QAbstractSocket::ConnectedState;
+}
+
+void TcpReadWriter::close() {
+    opened = false;
+    if (reconnectTimer != nullptr) {
+        delete reconnectTimer;
+        reconnectTimer = nullptr;
+    }
+    if (socket != nullptr) {
+        socket->disconnect(this);
+        socket->abort();
+        delete socket;
+        socket = nullptr;
+    }
+}
+
+QByteArray TcpReadWriter::readAll() {
+    if (socket != nullptr) {
+        return socket->readAll();
+    }
+    return QByteArray();
+}
+
+qint64 TcpReadWriter::read(char *data, qint64 maxSize) {
+    if (socket != nullptr) {
+        return socket->read(data, maxSize);
+    }
+    return 0;
+}
+
+qint64 TcpReadWriter::write(const QByteArray &byteArray) const {
+    if (socket != nullptr && socket->state() == QAbstractSocket::ConnectedState) {
+        return socket->write(byteArray);
+    }
+    qCDebug(lcTransport) << "TcpReadWriter write() not connected";
+    return 0;
+}
+
+QString TcpReadWriter::settingsText() const {
+    return QString("tcp %1:%2 nodelay").arg(settings.host).arg(settings.port);
+}
+
+void TcpReadWriter::applySocketOptions() {
+    // 命令都很短, Nagle 会把它们攒到上一条的 ACK 回来才发
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+}
+
+void TcpReadWriter::onStateChanged(QAbstractSocket::SocketState state) {
+    if (!opened) {
+        return;
+    }
+    if (state == QAbstractSocket::ConnectedState) {
+        applySocketOptions();
+        reconnectDelayMs = TCP_RECONNECT_MIN_MS;
+        linkUp = true;
+        qCInfo(lcTransport) << "TcpReadWriter connected" << settings.host << settings.port;
+        emit connectionChanged(true);
+    } else if (state == QAbstractSocket::UnconnectedState) {
+        // 连接失败或断线, 退避后再试
+        if (!reconnectTimer->isActive()) {
+            qCInfo(lcTransport) << "TcpReadWriter" << settings.host << settings.port << socket->errorString()
+                                << ", retry in" << reconnectDelayMs << "ms";
+            reconnectTimer->start(reconnectDelayMs);
+            reconnectDelayMs = qMin(reconnectDelayMs * 2, TCP_RECONNECT_MAX_MS);
+        }
+        if (linkUp) {
+            linkUp = false;
+            emit connectionChanged(false);
+        }
+    }
+}
+
+void TcpReadWriter::reconnect() {
+    if (opened && socket->state() == QAbstractSocket::UnconnectedState) {
+        socket->connectToHost(settings.host, settings.port);
+    }
+}
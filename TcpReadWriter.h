@@ -0,0 +1,55 @@
+#ifndef TCPREADWRITER_H
+#define TCPREADWRITER_H
+
+#include <QtNetwork/QTcpSocket>
+#include <QtCore/QTimer>
+#include "AbstractReadWriter.h"
+#include "NetSettings.h"
+
+/*
+ * 网口工装板的 TCP 读写者. 关闭 Nagle, 命令立即发出.
+ * open 只发起连接就返回, 连上后发出 connectionChanged(true); 连接失败或意外断开
+ * 会按退避间隔自动重连, 期间 isConnected() 为 false.
+ */
+class TcpReadWriter : public AbstractReadWriter {
+Q_OBJECT
+public:
+    explicit TcpReadWriter(QObject *parent = nullptr);
+
+    void setNetSettings(const NetSettings &netSettings);
+
+    QString settingsText() const override;
+
+    bool open() override;
+
+    bool isOpen() override;
+
+    bool isConnected() override;
+
+    void close() override;
+
+    QByteArray readAll() override;
+
+    qint64 read(char *data, qint64 maxSize) override;
+
+    qint64 write(const QByteArray &byteArray) const override;
+
+private slots:
+    void onStateChanged(QAbstractSocket::SocketState state);
+
+    void reconnect();
+
+private:
+    void applySocketOptions();
+
+private:
+    NetSettings settings;
+    QTcpSocket *socket{nullptr};
+    QTimer *reconnectTimer{nullptr};
+    int reconnectDelayMs{0};
+    bool opened{false};
+    bool linkUp{false};  // 只在连接状态真正变化时发出 connectionChanged
+};
+
+
+#endif //TCPREADWRITER_H
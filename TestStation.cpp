@@ -0,0 +1,483 @@
+#include "TestStation.h"
+#include "AsyncReadWriter.h"
+#include "SerialReadWriter.h"
+#include "SimReadWriter.h"
+#include "TcpReadWriter.h"
+#include "UdpReadWriter.h"
+#include "ReplayReadWriter.h"
+#include "TrafficCapture.h"
+#include "ComTest.h"
+#include "FrameParser.h"
+#include "LatencyStats.h"
+#include "ResultStore.h"
+#include "Logging.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QRegularExpression>
+
+TestStation::TestStation(const QString &portName, QObject *parent)
+    : QObject(parent)
+    , m_portName(portName)
+    , m_comTest(new ComTest(this))
+    , m_frameParser(new FrameParser)
+{
+    static quint16 traceIdCnt = 0;
+    m_traceId = ++traceIdCnt;
+    m_comTest->setTraceId(m_traceId);
+
+    // 应答帧直接交给测试对象; 固件应答不带结束符时, 总线空闲后交出最后一帧
+    m_frameParser->setFrameHandler([this](const char *data, int len) {
+        const qint64 now = m_latencyClock.nsecsElapsed();
+        const int item = m_comTest->DealWithFrame(data, len);
+        if (item >= 0)
+            GZ_TRACE(TRACE_ACK, m_traceId, item, m_comTest->itemResult(item).isPass);
+        else if (item != FRAME_PROTOCOL)
+            GZ_TRACE(TRACE_BAD_FRAME, m_traceId, len, 0);
+        if (item >= 0 && m_sentAtNs[item] >= 0) {
+            // 只统计命令后的第一条应答, 重复应答不计
+            m_lastRttUs[item] = (now - m_sentAtNs[item]) / 1000;
+            if (m_latencyStats != nullptr)
+                m_latencyStats->record(m_portName, item, m_lastRttUs[item]);
+            m_sentAtNs[item] = -1;
+        }
+    });
+    m_latencyClock.start();
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        m_sentAtNs[i] = -1;
+        m_lastRttUs[i] = -1;
+        m_itemTimeoutMs[i] = ComTest::defaultItemTimeout(i);
+    }
+    m_frameIdleTimer.setSingleShot(true);
+    m_frameIdleTimer.setInterval(FRAME_IDLE_FLUSH_MS);
+    connect(&m_frameIdleTimer, &QTimer::timeout, [this]() {
+        m_frameParser->flush();
+    });
+    m_linkTimer.setSingleShot(true);
+    connect(&m_linkTimer, &QTimer::timeout, this, &TestStation::onLinkTimeout);
+
+    connect(m_comTest, &ComTest::sendData, this, &TestStation::readToSend);
+    connect(m_comTest, &ComTest::progress, this, &TestStation::progress);
+    // 进度只更新快照, 由界面按自己的帧率取
+    connect(m_comTest, &ComTest::progress, this, [this](int part, int cnt) {
+        publish(StationSnapshot::RUNNING, part, cnt);
+    });
+    connect(m_comTest, &ComTest::logInfo, this, &TestStation::logInfo);
+    // 排队连接: 结束处理会关闭串口, 不能在串口的readyRead调用栈内执行
+    connect(m_comTest, &ComTest::finished, this, &TestStation::onTestFinished, Qt::QueuedConnection);
+}
+
+TestStation::~TestStation()
+{
+    m_comTest->Abort();
+    closeReadWriter();
+    delete m_capture;
+    delete m_frameParser;
+}
+
+bool TestStation::isRunning(void) const
+{
+    return m_busy;
+}
+
+bool TestStation::start(void)
+{
+    if (isRunning())
+        return false;
+
+    if (!canReuseSession())
+        closeReadWriter();
+    if (m_readWriter == nullptr) {
+        if (!openReadWriter()) {
+            closeReadWriter();
+            return false;
+        }
+    } else {
+        resyncReadWriter();
+    }
+    startCapture();
+
+    m_busy = true;
+    applyItemTimeouts();
+    m_startedAt = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < TEST_ITEMS_NUM; i++)
+        m_lastRttUs[i] = -1;
+    publish(StationSnapshot::RUNNING, 0, 0);
+    if (m_readWriter->isConnected()) {
+        m_comTest->Test();
+    } else {
+        // 网口还在后台连接, 不阻塞界面; 连上后在 connectionChanged 中开始
+        m_linkPending = true;
+        m_linkTimer.start(m_connectTimeoutMs);
+        emit logInfo(QString("正在连接，%1").arg(m_readWriter->settingsText()));
+    }
+    return true;
+}
+
+void TestStation::onLinkTimeout(void)
+{
+    if (!m_linkPending)
+        return;
+    m_linkPending = false;
+    emit logInfo(QString("连接超时(%1 ms)").arg(m_connectTimeoutMs));
+    m_comTest->Fail(ComTest::GZ_END_COM_TIMEOUT);
+}
+
+void TestStation::publish(int state, int part, int cnt)
+{
+    const quint64 old = m_snapshot.load(std::memory_order_relaxed);
+    const quint64 version = ((old >> 32) + 1) & 0xFFFFFFFFu;
+    const quint64 result = static_cast<quint64>(m_lastResult + 1) & 0xF;
+    m_snapshot.store((version << 32) | (static_cast<quint64>(state & 0xF) << 28) | (result << 24)
+                     | (static_cast<quint64>(qBound(0, part, 0xFF)) << 16) | static_cast<quint64>(qBound(0, cnt, 0xFFFF)),
+                     std::memory_order_release);
+}
+
+QJsonObject TestStation::resultJson(void) const
+{
+    static const char *const resultNames[] = { "success", "failed", "timeout" };
+
+    QJsonArray items;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        QJsonObject item;
+        item["name"] = ComTest::itemName(i);
+        item["done"] = m_comTest->isItemDone(i);
+        item["pass"] = m_comTest->itemResult(i).isPass;
+        item["result"] = static_cast<qint64>(m_comTest->itemResult(i).result);
+        QJsonArray attempts;
+        for (int attempt : m_comTest->itemAttempts(i))
+            attempts.append(ComTest::attemptName(attempt));
+        item["attempts"] = attempts;
+        // 没收到应答时为 null
+        item["rtt_ms"] = m_lastRttUs[i] >= 0 ? QJsonValue(m_lastRttUs[i] / 1000.0) : QJsonValue();
+        items.append(item);
+    }
+
+    QJsonObject json;
+    json["port"] = m_portName;
+    if (!m_boardSerial.isEmpty())
+        json["serial"] = m_boardSerial;
+    if (m_lastResult >= 0) {
+        json["result"] = resultNames[m_lastResult];
+        json["code"] = m_lastResult;
+    }
+    json["pipelined"] = m_comTest->isPipelined();
+    json["protocol"] = ComTest::protocolName(m_comTest->protocol());
+    json["cycle_ms"] = m_comTest->cycleTime();
+    json["items"] = items;
+    if (!m_captureFile.isEmpty())
+        json["capture"] = m_captureFile;
+    return json;
+}
+
+RunRecord TestStation::runRecord(void) const
+{
+    RunRecord run;
+    run.serial = m_boardSerial;
+    run.port = m_portName;
+    run.startedAt = m_startedAt;
+    run.result = m_lastResult;
+    run.pipelined = m_comTest->isPipelined();
+    run.protocol = m_comTest->protocol();
+    run.cycleMs = m_comTest->cycleTime();
+    run.mask485 = m_comTest->itemResult(TEST_IDX_485).result;
+    run.capture = m_captureFile;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        run.done[i] = m_comTest->isItemDone(i);
+        run.pass[i] = m_comTest->itemResult(i).isPass;
+        run.attempts[i] = m_comTest->itemAttempts(i).size();
+        run.rttUs[i] = m_lastRttUs[i];
+    }
+    return run;
+}
+
+StationSnapshot TestStation::snapshot(void) const
+{
+    const quint64 v = m_snapshot.load(std::memory_order_acquire);
+    StationSnapshot snapshot;
+    snapshot.version = static_cast<quint32>(v >> 32);
+    snapshot.state = static_cast<int>((v >> 28) & 0xF);
+    snapshot.result = static_cast<int>((v >> 24) & 0xF) - 1;
+    snapshot.part = static_cast<int>((v >> 16) & 0xFF);
+    snapshot.cnt = static_cast<int>(v & 0xFFFF);
+    return snapshot;
+}
+
+void TestStation::applyItemTimeouts(void)
+{
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        int timeout = m_itemTimeoutMs[i];
+        if (m_adaptiveTimeout && m_latencyStats != nullptr) {
+            const LatencyHistogram &rtt = m_latencyStats->histogram(m_portName, i);
+            if (rtt.count() >= ADAPTIVE_MIN_SAMPLES) {
+                const qint64 p99Ms = (rtt.percentile(0.99) + 999) / 1000;
+                timeout = static_cast<int>(qMin<qint64>(timeout, p99Ms * 3 / 2 + ADAPTIVE_MARGIN_MS));
+            }
+        }
+        m_comTest->setItemTimeout(i, timeout);
+    }
+    qCDebug(lcSequencer) << m_portName << "item timeouts:" << m_comTest->itemTimeout(0) << m_comTest->itemTimeout(1)
+             << m_comTest->itemTimeout(2) << m_comTest->itemTimeout(3) << m_comTest->itemTimeout(4);
+}
+
+void TestStation::abort(void)
+{
+    if (m_linkPending) {
+        m_linkPending = false;
+        m_linkTimer.stop();
+        m_comTest->Fail(ComTest::GZ_END_COM_TIMEOUT);
+        return;
+    }
+    m_comTest->Abort();
+}
+
+void TestStation::setPersistentSession(bool persistent)
+{
+    m_persistentSession = persistent;
+    if (!persistent && !isRunning())
+        closeReadWriter();
+}
+
+void TestStation::closeSession(void)
+{
+    if (!isRunning())
+        closeReadWriter();
+}
+
+bool TestStation::canReuseSession(void) const
+{
+    // 回放文件每次都要从头开始
+    return m_readWriter != nullptr && m_persistentSession && m_openPortName == m_portName
+            && m_readWriter->isConnected() && !ReplaySettings::isReplaySpec(m_portName);
+}
+
+void TestStation::resyncReadWriter(void)
+{
+    // 上一块板的半帧、迟到的应答和驱动缓冲区里的数据都不能算到这一块板上
+    m_frameIdleTimer.stop();
+    m_frameParser->reset();
+    const size_t stale = m_readWriter->resync();
+    qCDebug(lcTransport) << m_portName << "resync, discarded" << stale << "stale bytes";
+    emit logInfo(QString("端口保持打开，%1").arg(m_readWriter->settingsText()));
+}
+
+AbstractReadWriter *TestStation::createReadWriter()
+{
+    if (SimDutConfig::isSimSpec(m_portName)) {
+        // 模拟设备, 不需要真实工装板
+        return new SimReadWriter(SimDutConfig::fromSpec(m_portName));
+    }
+
+    if (ReplaySettings::isReplaySpec(m_portName)) {
+        // 回放抓包文件, 复现现场
+        return new ReplayReadWriter(ReplaySettings::fromSpec(m_portName));
+    }
+
+    if (NetSettings::isNetSpec(m_portName)) {
+        // 网口工装板, 命令集与串口相同
+        NetSettings netSettings;
+        if (!NetSettings::fromSpec(m_portName, &netSettings))
+            return nullptr;
+        m_connectTimeoutMs = netSettings.connectTimeoutMs;
+        if (netSettings.protocol == NetSettings::Udp) {
+            auto udpReadWriter = new UdpReadWriter();
+            udpReadWriter->setNetSettings(netSettings);
+            return udpReadWriter;
+        }
+        auto tcpReadWriter = new TcpReadWriter();
+        tcpReadWriter->setNetSettings(netSettings);
+        return tcpReadWriter;
+    }
+
+    const SerialSettings settings = SerialSettings::fixture(m_portName);
+    auto serialReadWriter = new SerialReadWriter();
+    serialReadWriter->setSerialSettings(settings);
+    qCDebug(lcTransport) << settings.name << settings.baudRate << settings.dataBits << settings.stopBits << settings.parity;
+    return serialReadWriter;
+}
+
+bool TestStation::openReadWriter()
+{
+    bool result;
+
+    auto transport = createReadWriter();
+    if (transport == nullptr) {
+        emit logInfo(QString("端口名无效: %1").arg(m_portName));
+        return false;
+    }
+
+    // 端口在独立的IO线程中读写, 界面卡顿不影响接收
+    auto readWriter = new AsyncReadWriter(transport, this);
+    result = readWriter->open();
+    GZ_TRACE(TRACE_OPEN, m_traceId, result, 0);
+    if (!result) {
+        delete readWriter;
+        return result;
+    }
+    m_readWriter = readWriter;
+    m_openPortName = m_portName;
+    connect(m_readWriter, &AsyncReadWriter::readyRead,
+            this, &TestStation::readData);
+    m_linkSeen = false;
+    connect(m_readWriter, &AsyncReadWriter::connectionChanged, this, [this](bool isConnected) {
+        if (isConnected) {
+            emit logInfo(QString(m_linkSeen ? "连接已恢复" : "连接成功"));
+            m_linkSeen = true;
+            if (m_linkPending) {
+                m_linkPending = false;
+                m_linkTimer.stop();
+                m_comTest->Test();
+            }
+        } else if (NetSettings::isNetSpec(m_openPortName)) {
+            emit logInfo(QString("连接断开，正在重连"));
+        } else {
+            emit logInfo(QString("连接断开"));  // 串口被拔出, 下次开始时重新打开
+        }
+    });
+
+    emit serialStateChanged(result);
+    emit logInfo(QString("端口打开成功，%1").arg(m_readWriter->settingsText()));
+
+    return result;
+}
+
+void TestStation::closeReadWriter()
+{
+    m_frameIdleTimer.stop();
+    m_frameParser->reset();
+    stopCapture();
+    if (m_readWriter != nullptr) {
+        m_readWriter->close();
+        GZ_TRACE(TRACE_CLOSE, m_traceId, 0, 0);
+        qCDebug(lcTransport) << m_portName << "close, rx queue high water mark:" << m_readWriter->highWaterMark()
+                 << "/" << m_readWriter->rxBuffer().capacity()
+                 << "dropped:" << m_readWriter->droppedBytes();
+        delete m_readWriter;
+        m_readWriter = nullptr;
+        emit serialStateChanged(false);
+        emit logInfo(QString("端口关闭\r\n"));
+    }
+}
+
+void TestStation::readData()
+{
+    auto &ring = m_readWriter->rxBuffer();
+    auto receiveCount = ring.size();
+    if (receiveCount > 0) {
+        // 直接在环形缓冲区上解析, 半帧/粘帧由解析器处理
+        int frames = 0;
+        const bool capturing = m_capture != nullptr && m_capture->isOpen();
+        if (m_trafficTap || capturing) {
+            // 监视或抓包时先把每段原始字节交出去再解析
+            QByteArray raw;
+            if (m_trafficTap)
+                raw.reserve(int(receiveCount));
+            const char *span;
+            size_t avail;
+            while ((avail = ring.readableSpan(&span)) > 0) {
+                if (capturing)
+                    m_capture->record(false, span, int(avail));
+                if (m_trafficTap)
+                    raw.append(span, int(avail));
+                frames += m_frameParser->feed(span, int(avail));
+                ring.consume(avail);
+            }
+            if (m_trafficTap)
+                emit rawTraffic(false, raw);
+        } else {
+            frames = m_frameParser->feed(ring);
+        }
+        if (m_frameParser->hasPending())
+            m_frameIdleTimer.start();
+        else
+            m_frameIdleTimer.stop();
+
+        GZ_TRACE(TRACE_RX, m_traceId, receiveCount, frames);
+        qCDebug(lcTransport) << m_portName << "rx" << receiveCount << "bytes," << frames << "frames, queue high water mark:" << m_readWriter->highWaterMark();
+    }
+}
+
+qint64 TestStation::writeData(const QByteArray &data)
+{
+    if (!data.isEmpty() && m_readWriter != nullptr && m_readWriter->isConnected()) {
+        return m_readWriter->write(data);
+    }
+    return 0;
+}
+
+void TestStation::readToSend(QByteArray data)
+{
+    auto count = writeData(data);
+    if (m_capture != nullptr && count > 0)
+        m_capture->record(true, data.constData(), data.size());
+    if (m_trafficTap && count > 0)
+        emit rawTraffic(true, data);
+    const int item = ComTest::itemOfCommand(data.constData(), data.size());
+    if (count > 0 && item >= 0) {
+        // 重发时上一次命令仍未收到应答
+        if (m_sentAtNs[item] >= 0 && m_latencyStats != nullptr)
+            m_latencyStats->recordMiss(m_portName, item);
+        m_sentAtNs[item] = m_latencyClock.nsecsElapsed();
+    }
+    GZ_TRACE(TRACE_TX, m_traceId, item, count);
+    qCDebug(lcTransport) << m_portName << "send data len: " << data.length() << "actual send data len:" << count;
+}
+
+void TestStation::startCapture(void)
+{
+    m_captureFile.clear();
+    if (m_captureDir.isEmpty())
+        return;
+
+    QString name = m_portName;
+    name.replace(QRegularExpression("[^A-Za-z0-9_.-]"), "_");
+    const QString fileName = QString("%1/%2_%3%4").arg(m_captureDir, name,
+            QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz"), CAPTURE_SUFFIX);
+    // 写线程随工位一直保留, 打开文件和写文件头都排队给它, 测试路径上不等待磁盘
+    if (m_capture == nullptr) {
+        m_capture = new CaptureWriter;
+        // 写线程关闭文件后才知道是否写成功, 经事件循环交回
+        connect(m_capture, &CaptureWriter::fileFinished, this, [this](const QString &file, const QString &error) {
+            if (error.isEmpty())
+                emit logInfo(QString("报文已保存: %1").arg(file));
+            else
+                emit logInfo(QString("抓包文件 %1 写入失败: %2").arg(file, error));
+        }, Qt::QueuedConnection);
+    }
+    m_capture->open(fileName, m_portName);
+    m_captureFile = fileName;
+}
+
+void TestStation::stopCapture(void)
+{
+    if (m_capture == nullptr || !m_capture->isOpen())
+        return;
+    // 排队关闭, 剩余记录由写线程写完, 结果由 fileFinished 报告
+    m_capture->close();
+}
+
+void TestStation::onTestFinished(int result)
+{
+    m_lastResult = result;
+    m_resultInfo = m_comTest->resultInfo();
+    publish(StationSnapshot::DONE, TEST_ITEMS_NUM, 0);
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        // 超时或中止时还在等待应答的命令
+        if (m_sentAtNs[i] >= 0 && m_latencyStats != nullptr)
+            m_latencyStats->recordMiss(m_portName, i);
+        m_sentAtNs[i] = -1;
+    }
+    stopCapture();
+    // 只入队, 由结果库的后台线程写盘
+    if (m_resultStore != nullptr)
+        m_resultStore->record(runRecord());
+    if (m_persistentSession) {
+        m_frameIdleTimer.stop();
+        m_frameParser->reset();
+    } else {
+        closeReadWriter();
+    }
+    // 结果处理完才算空闲: ComTest 结束到这里之间 finished 还在队列中, 此时不能开始下一块板
+    m_busy = false;
+    emit finished(result);
+}
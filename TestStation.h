@@ -0,0 +1,180 @@
+#ifndef TESTSTATION_H
+#define TESTSTATION_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <atomic>
+#include "ComTest.h"
+
+class AbstractReadWriter;
+class AsyncReadWriter;
+class CaptureWriter;
+class FrameParser;
+class LatencyStats;
+class ResultStore;
+struct RunRecord;
+
+/*
+ * 工位状态的一份拷贝, 供界面按固定帧率拉取(见 UiRefresher), 测试路径上不做任何界面操作.
+ */
+struct StationSnapshot {
+    enum State {
+        IDLE,
+        RUNNING,
+        DONE
+    };
+
+    quint32 version = 0;    // 每次变化加一, 视图据此跳过没有变化的工位
+    int state = IDLE;
+    int result = -1;        // DONE 时为 eTestEndResult
+    int part = 0;           // 与 ComTest::progress 相同
+    int cnt = 0;
+};
+
+/*
+ * 一个工位的完整测试会话: 端口(独立IO线程) + 应答解析 + 测试序列.
+ * 各工位之间不共享任何缓冲区、结果或定时器, 可以在同一进程中并行运行.
+ */
+class TestStation : public QObject
+{
+    Q_OBJECT
+
+#define    ADAPTIVE_MIN_SAMPLES      30   // 样本不足时仍用配置的超时
+#define    ADAPTIVE_MARGIN_MS        50
+#define    CONNECT_TIMEOUT_MS        1000 // 网口连接超时的默认值, 其他端口打开即连接
+
+
+public:
+    explicit TestStation(const QString &portName = QString(), QObject *parent = nullptr);
+    ~TestStation();
+
+    void setPortName(const QString &portName) { m_portName = portName; }
+    const QString &portName(void) const { return m_portName; }
+
+    ComTest *comTest(void) const { return m_comTest; }
+    // start 成功到 finished 发出之前为 true, 包括 ComTest 已结束但结束处理还在排队的时间
+    bool isRunning(void) const;
+
+    // 上一次测试的 eTestEndResult 和结果描述, 未测试时为 -1
+    int lastResult(void) const { return m_lastResult; }
+    const QString &resultInfo(void) const { return m_resultInfo; }
+    // 上一次测试各项的往返延时(us), 没收到应答时为 -1
+    qint64 lastRtt(int item) const { return m_lastRttUs[item]; }
+    // 上一次测试的结果和各项详情, 无界面模式和控制接口输出的 JSON 格式
+    QJsonObject resultJson(void) const;
+    // 跟踪环中本工位的编号, 用于 TraceRing::dump
+    quint16 traceId(void) const { return m_traceId; }
+    // 当前进度和结果, 任意线程可读
+    StationSnapshot snapshot(void) const;
+
+    // 每条命令的往返延时记入 stats(可多个工位共用), 为 nullptr 时不统计
+    void setLatencyStats(LatencyStats *stats) { m_latencyStats = stats; }
+
+    // 配置的单项超时(ms), 每次 start 时交给 ComTest
+    void setItemTimeout(int item, int ms) { m_itemTimeoutMs[item] = ms; }
+    int itemTimeout(int item) const { return m_itemTimeoutMs[item]; }
+    // 自适应超时: 样本足够时取本端口该项延时 p99 * 1.5 + 余量, 且不超过配置值;
+    // 死板子或断线能在远小于配置超时的时间内判定. 需要 setLatencyStats
+    void setAdaptiveTimeout(bool adaptive) { m_adaptiveTimeout = adaptive; }
+    bool isAdaptiveTimeout(void) const { return m_adaptiveTimeout; }
+
+    // 打开后每次收发的原始字节都以 rawTraffic 发出, 供报文监视; 关闭时不拷贝
+    void setTrafficTap(bool enable) { m_trafficTap = enable; }
+    bool isTrafficTap(void) const { return m_trafficTap; }
+
+    // 目录非空时每次测试把收发的原始字节写入该目录下的抓包文件, 可用 "replay:<文件>" 回放
+    void setCaptureDir(const QString &dir) { m_captureDir = dir; }
+    const QString &captureDir(void) const { return m_captureDir; }
+    // 最近一次测试的抓包文件, 未抓包时为空
+    const QString &captureFile(void) const { return m_captureFile; }
+
+    // 板号(扫码或手工输入), 随结果一起保存; 每块板开始前设置
+    void setBoardSerial(const QString &serial) { m_boardSerial = serial; }
+    const QString &boardSerial(void) const { return m_boardSerial; }
+    // 每次测试结束时把结果记入 store(可多个工位共用), 为 nullptr 时不保存
+    void setResultStore(ResultStore *store) { m_resultStore = store; }
+    // 上一次测试的记录, 与写入结果库的相同
+    RunRecord runRecord(void) const;
+
+    // 持久会话: 测试结束后不关闭端口, 同一端口的下一块板直接复用, 开始前丢弃上一块板的残留数据.
+    // 换了端口、连接已断开或回放抓包时仍重新打开; 关闭该选项时空闲的端口立即关闭
+    void setPersistentSession(bool persistent);
+    bool isPersistentSession(void) const { return m_persistentSession; }
+    bool isSessionOpen(void) const { return m_readWriter != nullptr; }
+
+public slots:
+    // 打开端口(或复用持久会话)并启动测试, 端口打开失败返回 false. 网口在后台连接, 连上后才发命令,
+    // 超过连接超时(NetSettings::connectTimeoutMs)仍未连上时按通信超时结束
+    bool start(void);
+    void abort(void);
+    // 关闭端口, 持久会话也关闭; 测试中调用无效
+    void closeSession(void);
+
+signals:
+    void serialStateChanged(bool isOpen);
+    void progress(int part, int cnt);
+    void logInfo(const QString &message);
+    void finished(int result);
+    void rawTraffic(bool isTx, const QByteArray &data);
+
+private slots:
+    void readData();
+    void readToSend(QByteArray data);
+    void onTestFinished(int result);
+
+private:
+    // 按端口名创建读写者: "sim[:选项]" 为模拟设备, "tcp://主机:端口" / "udp://主机:端口"
+    // 为网口工装板, "replay:<文件>" 回放抓包, 其余为串口; 端口名无法解析时返回 nullptr
+    AbstractReadWriter *createReadWriter();
+    bool openReadWriter();
+    void closeReadWriter();
+    bool canReuseSession(void) const;
+    void resyncReadWriter(void);
+    qint64 writeData(const QByteArray &data);
+    void applyItemTimeouts(void);
+    void onLinkTimeout(void);
+    void startCapture(void);
+    void stopCapture(void);
+    void publish(int state, int part, int cnt);
+
+private:
+    QString m_portName;
+    AsyncReadWriter *m_readWriter = nullptr;
+    QString m_openPortName;  // m_readWriter 打开的端口
+    bool m_persistentSession = false;
+    ComTest *m_comTest = nullptr;
+    FrameParser *m_frameParser = nullptr;
+    QTimer m_frameIdleTimer;
+    // 开始测试时还没连上, 等 connectionChanged(true) 或超时
+    QTimer m_linkTimer;
+    bool m_linkPending = false;
+    bool m_linkSeen = false;    // 本次打开后连上过
+    int m_connectTimeoutMs = CONNECT_TIMEOUT_MS;
+    // 单调时钟, 记录各测试项命令交给端口的时间, -1 表示没有等待中的命令
+    QElapsedTimer m_latencyClock;
+    qint64 m_sentAtNs[TEST_ITEMS_NUM];
+    qint64 m_lastRttUs[TEST_ITEMS_NUM];
+    LatencyStats *m_latencyStats = nullptr;
+    int m_itemTimeoutMs[TEST_ITEMS_NUM];
+    bool m_adaptiveTimeout = false;
+    bool m_trafficTap = false;
+    QString m_captureDir;
+    QString m_captureFile;
+    CaptureWriter *m_capture = nullptr;
+    quint16 m_traceId = 0;
+    // 快照打包在一个原子量中, 读者一次读出一致的值:
+    // version(32) | state(4) | result + 1(4) | part(8) | cnt(16)
+    std::atomic<quint64> m_snapshot{0};
+    bool m_busy = false;
+    int m_lastResult = -1;
+    QString m_boardSerial;
+    qint64 m_startedAt = 0;  // 1970 以来的毫秒数
+    ResultStore *m_resultStore = nullptr;
+    QString m_resultInfo;
+};
+
+#endif // TESTSTATION_H
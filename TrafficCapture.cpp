@@ -0,0 +1,290 @@
+#include "TrafficCapture.h"
+#include "Logging.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <cstring>
+
+namespace {
+
+const char kMagic[] = "GZCAP";
+const int kMagicLen = 5;
+
+void putVarint(QByteArray *out, quint64 v)
+{
+    char buf[10];
+    int n = 0;
+    while (v >= 0x80) {
+        buf[n++] = static_cast<char>((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = static_cast<char>(v);
+    out->append(buf, n);
+}
+
+bool getVarint(const char *&p, const char *end, quint64 *v)
+{
+    quint64 result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const unsigned char c = static_cast<unsigned char>(*p++);
+        result |= static_cast<quint64>(c & 0x7F) << shift;
+        if ((c & 0x80) == 0) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void putLe(QByteArray *out, quint64 v, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out->append(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+quint64 getLe(const char *p, int bytes)
+{
+    quint64 v = 0;
+    for (int i = 0; i < bytes; i++)
+        v |= static_cast<quint64>(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+}
+
+/* ---------------- CaptureFile ---------------- */
+
+QByteArray CaptureFile::header(const QString &portName, qint64 startMs)
+{
+    const QByteArray name = portName.toUtf8().left(0xFFFF);
+    QByteArray out(kMagic, kMagicLen);
+    out.append(static_cast<char>(CAPTURE_VERSION));
+    putLe(&out, static_cast<quint64>(startMs), 8);
+    putLe(&out, static_cast<quint64>(name.size()), 2);
+    out.append(name);
+    return out;
+}
+
+void CaptureFile::appendRecord(QByteArray *out, qint64 deltaUs, bool isTx, const char *data, int len)
+{
+    putVarint(out, static_cast<quint64>(qMax<qint64>(0, deltaUs)));
+    putVarint(out, (static_cast<quint64>(len) << 1) | (isTx ? 1 : 0));
+    out->append(data, len);
+}
+
+bool CaptureFile::load(const QString &fileName, QString *error)
+{
+    m_records.clear();
+    m_truncated = false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error != nullptr)
+            *error = file.errorString();
+        return false;
+    }
+    const QByteArray content = file.readAll();
+    const char *p = content.constData();
+    const char *end = p + content.size();
+
+    if (content.size() < kMagicLen + 11 || memcmp(p, kMagic, kMagicLen) != 0
+            || p[kMagicLen] != CAPTURE_VERSION) {
+        if (error != nullptr)
+            *error = QString("不是抓包文件或版本不支持");
+        return false;
+    }
+    p += kMagicLen + 1;
+    m_startMs = static_cast<qint64>(getLe(p, 8));
+    const int nameLen = static_cast<int>(getLe(p + 8, 2));
+    p += 10;
+    if (end - p < nameLen) {
+        if (error != nullptr)
+            *error = QString("文件头不完整");
+        return false;
+    }
+    m_portName = QString::fromUtf8(p, nameLen);
+    p += nameLen;
+
+    qint64 timeUs = 0;
+    while (p < end) {
+        quint64 deltaUs, lenDir;
+        if (!getVarint(p, end, &deltaUs) || !getVarint(p, end, &lenDir)
+                || static_cast<quint64>(end - p) < (lenDir >> 1)) {
+            m_truncated = true;
+            break;
+        }
+        timeUs += static_cast<qint64>(deltaUs);
+        CaptureRecord record;
+        record.timeUs = timeUs;
+        record.isTx = (lenDir & 1) != 0;
+        record.data = QByteArray(p, static_cast<int>(lenDir >> 1));
+        p += lenDir >> 1;
+        m_records.append(record);
+    }
+    return true;
+}
+
+/* ---------------- CaptureWriter ---------------- */
+
+class CaptureWriter::Thread : public QThread
+{
+public:
+    explicit Thread(CaptureWriter *writer) : m_writer(writer) { setObjectName("captureWriter"); }
+
+protected:
+    void run() override { m_writer->run(); }
+
+private:
+    CaptureWriter *m_writer;
+};
+
+CaptureWriter::CaptureWriter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    if (m_thread == nullptr)
+        return;
+
+    close();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    m_thread->wait();
+}
+
+void CaptureWriter::open(const QString &fileName, const QString &portName)
+{
+    close();
+    if (m_thread == nullptr) {
+        m_thread.reset(new Thread(this));
+        m_thread->start(QThread::LowPriority);
+    }
+
+    m_fileName = fileName;
+    m_open = true;
+    m_dropped = 0;
+    m_lastUs = 0;
+    m_clock.start();
+    enqueue(Command::Open, fileName, CaptureFile::header(portName, QDateTime::currentMSecsSinceEpoch()));
+}
+
+void CaptureWriter::close(void)
+{
+    if (!m_open)
+        return;
+
+    m_open = false;
+    enqueue(Command::Close, QString(), QByteArray());
+    if (m_dropped > 0)
+        qCWarning(lcTransport) << m_fileName << "capture dropped" << m_dropped << "records";
+}
+
+void CaptureWriter::enqueue(Command::Type type, const QString &fileName, const QByteArray &data)
+{
+    Command command;
+    command.type = type;
+    command.fileName = fileName;
+    command.data = data;
+    QMutexLocker locker(&m_mutex);
+    m_queue.append(command);
+    m_wake.wakeOne();
+}
+
+void CaptureWriter::record(bool isTx, const char *data, int len)
+{
+    if (!m_open || len <= 0)
+        return;
+
+    const qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+    QMutexLocker locker(&m_mutex);
+    if (m_pendingBytes + len > CAPTURE_MAX_PENDING) {
+        // 丢弃的记录不计时间, 下一条的间隔从上一条写入的记录算起
+        m_dropped++;
+        return;
+    }
+    if (m_queue.isEmpty() || m_queue.last().type != Command::Write) {
+        Command command;
+        command.type = Command::Write;
+        command.data.reserve(CAPTURE_FLUSH_BYTES);
+        m_queue.append(command);
+        // 后台空闲时不定时唤醒, 有了待写的记录才开始计时
+        m_wake.wakeOne();
+    }
+    QByteArray &out = m_queue.last().data;
+    const int before = out.size();
+    CaptureFile::appendRecord(&out, nowUs - m_lastUs, isTx, data, len);
+    m_pendingBytes += out.size() - before;
+    m_lastUs = nowUs;
+    if (m_pendingBytes >= CAPTURE_FLUSH_BYTES)
+        m_wake.wakeOne();
+}
+
+void CaptureWriter::run(void)
+{
+    QFile file;
+    QString fileName;   // 当前文件, 打开失败时也保留到 Close
+    QString fileError;
+    QVector<Command> batch;
+    bool stopping = false;
+    while (!stopping) {
+        {
+            QMutexLocker locker(&m_mutex);
+            // 没有待写的记录时一直等到有命令, 不定时唤醒
+            if (m_queue.isEmpty() && !m_stopping)
+                m_wake.wait(&m_mutex);
+            // 只有记录时攒够一批或到时间再写, 打开和关闭立即处理
+            const bool commands = !m_queue.isEmpty() && (m_queue.size() > 1 || m_queue.first().type != Command::Write);
+            if (!m_queue.isEmpty() && m_pendingBytes < CAPTURE_FLUSH_BYTES && !commands && !m_stopping)
+                m_wake.wait(&m_mutex, CAPTURE_FLUSH_MS);
+            // 交换队列, 写盘时不持有锁
+            batch.swap(m_queue);
+            m_pendingBytes = 0;
+            stopping = m_stopping;
+        }
+
+        for (const Command &command : batch) {
+            if (command.type == Command::Open || command.type == Command::Close) {
+                if (!fileName.isEmpty()) {
+                    file.close();
+                    emit fileFinished(fileName, fileError);
+                }
+                fileName.clear();
+                fileError.clear();
+                if (command.type == Command::Close)
+                    continue;
+
+                fileName = command.fileName;
+                file.setFileName(fileName);
+                m_bytesWritten.store(0, std::memory_order_relaxed);
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                    // 之后到 Close 为止的记录都丢弃
+                    fileError = file.errorString();
+                    qCWarning(lcTransport) << "capture open" << fileName << "failed:" << fileError;
+                    continue;
+                }
+            }
+            // 文件头或记录
+            if (!file.isOpen())
+                continue;
+            const qint64 n = file.write(command.data);
+            if (n > 0)
+                m_bytesWritten.fetch_add(static_cast<quint64>(n), std::memory_order_relaxed);
+            else if (n < 0 && fileError.isEmpty())
+                fileError = file.errorString();
+        }
+        if (file.isOpen())
+            file.flush();
+        batch.clear();
+    }
+    if (!fileName.isEmpty()) {
+        file.close();
+        emit fileFinished(fileName, fileError);
+    }
+}
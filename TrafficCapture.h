@@ -0,0 +1,116 @@
+#ifndef TRAFFICCAPTURE_H
+#define TRAFFICCAPTURE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+
+/*
+ * 原始报文抓包文件(*.gzcap), 只追加, 小端:
+ *   文件头: "GZCAP" 版本(1字节) | 开始时间 ms since epoch(8字节) | 端口名长度(2字节) | 端口名(UTF-8)
+ *   记录:   距上一条的微秒数(varint) | 长度 << 1 | 方向(varint, 1 为发送) | 数据
+ * 时间取单调时钟; 进程中途退出时最后一条记录可能不完整, 读取时忽略.
+ */
+#define    CAPTURE_VERSION          1
+#define    CAPTURE_SUFFIX           ".gzcap"
+
+struct CaptureRecord {
+    qint64 timeUs = 0;      // 距抓包开始
+    bool isTx = false;
+    QByteArray data;
+};
+
+class CaptureFile
+{
+public:
+    // 读入整个抓包文件, 失败时 error 为原因
+    bool load(const QString &fileName, QString *error = nullptr);
+
+    const QString &portName(void) const { return m_portName; }
+    qint64 startMs(void) const { return m_startMs; }
+    const QVector<CaptureRecord> &records(void) const { return m_records; }
+    bool isTruncated(void) const { return m_truncated; }
+
+    static QByteArray header(const QString &portName, qint64 startMs);
+    static void appendRecord(QByteArray *out, qint64 deltaUs, bool isTx, const char *data, int len);
+
+private:
+    QString m_portName;
+    qint64 m_startMs = 0;
+    QVector<CaptureRecord> m_records;
+    bool m_truncated = false;
+};
+
+/*
+ * 抓包写入: record 在调用线程(一般是GUI线程)中只编码进内存缓冲区,
+ * 由后台线程定时或攒够一批后写盘, 收发路径上没有文件IO.
+ * 后台线程在第一次 open 时启动, 之后一直复用到对象销毁; open/close 只排队给后台线程,
+ * 建文件、写文件头和关闭都在后台按顺序完成, 调用线程不等待; 每个文件写完或失败时发出 fileFinished.
+ * 后台来不及写时缓冲区有上限, 超出的记录丢弃并计数. 没有待写的记录时后台线程不定时唤醒.
+ */
+class CaptureWriter : public QObject
+{
+    Q_OBJECT
+
+#define    CAPTURE_FLUSH_MS         200
+#define    CAPTURE_FLUSH_BYTES      (64 * 1024)
+#define    CAPTURE_MAX_PENDING      (4 * 1024 * 1024)
+
+public:
+    explicit CaptureWriter(QObject *parent = nullptr);
+    // 写完已排队的记录, 关闭文件后结束后台线程
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+    // 关闭上一个文件并排队打开 fileName, 不等待; 打开失败时该文件的记录丢弃, 由 fileFinished 报告
+    void open(const QString &fileName, const QString &portName);
+    // 排队: 写完之前的记录后关闭
+    void close(void);
+    bool isOpen(void) const { return m_open; }
+    const QString &fileName(void) const { return m_fileName; }
+    void record(bool isTx, const char *data, int len);
+
+    quint64 bytesWritten(void) const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    quint64 droppedRecords(void) const { return m_dropped; }
+
+signals:
+    // 后台线程关闭文件后发出, error 为空表示已保存, 否则为打开或写入失败的原因
+    void fileFinished(const QString &fileName, const QString &error);
+
+private:
+    class Thread;
+    // 后台线程按顺序执行的命令; 同一文件相邻的记录合并在一条 Write 中
+    struct Command {
+        enum Type { Open, Write, Close };
+        Type type;
+        QString fileName;   // Open
+        QByteArray data;    // Open 的文件头或 Write 的记录
+    };
+    void enqueue(Command::Type type, const QString &fileName, const QByteArray &data);
+    void run(void);
+
+private:
+    std::unique_ptr<Thread> m_thread;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QVector<Command> m_queue;
+    int m_pendingBytes = 0;     // 队列中记录的字节数
+    bool m_stopping = false;
+    // 以下只在调用线程中使用
+    bool m_open = false;
+    QString m_fileName;
+    QElapsedTimer m_clock;
+    qint64 m_lastUs = 0;
+    quint64 m_dropped = 0;
+    std::atomic<quint64> m_bytesWritten{0};
+};
+
+#endif // TRAFFICCAPTURE_H
@@ -0,0 +1,97 @@
+#include "UdpReadWriter.h"
+#include "Logging.h"
+#include <cstring>
+
+UdpReadWriter::UdpReadWriter(QObject *parent) : AbstractReadWriter(parent) {
+
+}
+
+void UdpReadWriter::setNetSettings(const NetSettings &netSettings) {
+    this->settings = netSettings;
+}
+
+bool UdpReadWriter::open() {
+    close();
+
+    socket = new QUdpSocket(this);
+    connect(socket, &QUdpSocket::readyRead, this, &UdpReadWriter::onDatagrams);
+    connect(socket, &QUdpSocket::stateChanged, this, &UdpReadWriter::onStateChanged);
+    // 已连接的 UDP socket 只收工装板地址发来的数据报. 主机名由 socket 在后台解析,
+    // 不等待结果, 解析完成(地址直接给出时立即)进入连接状态后发出 connectionChanged(true)
+    socket->connectToHost(settings.host, settings.port);
+    return true;
+}
+
+bool UdpReadWriter::isOpen() {
+    return socket != nullptr;
+}
+
+bool UdpReadWriter::isConnected() {
+    return socket != nullptr && socket->state() == QAbstractSocket::ConnectedState;
+}
+
+void UdpReadWriter::close() {
+    rxBuff.clear();
+    linkUp = false;
+    if (socket != nullptr) {
+        socket->disconnect(this);
+        socket->abort();
+        delete socket;
+        socket = nullptr;
+    }
+}
+
+QByteArray UdpReadWriter::readAll() {
+    QByteArray data;
+    data.swap(rxBuff);
+    return data;
+}
+
+qint64 UdpReadWriter::read(char *data, qint64 maxSize) {
+    const int n = static_cast<int>(qMin<qint64>(maxSize, rxBuff.size()));
+    memcpy(data, rxBuff.constData(), static_cast<size_t>(n));
+    rxBuff.remove(0, n);
+    return n;
+}
+
+qint64 UdpReadWriter::write(const QByteArray &byteArray) const {
+    if (socket != nullptr && socket->state() == QAbstractSocket::ConnectedState) {
+        return socket->write(byteArray);
+    }
+    qCDebug(lcTransport) << "UdpReadWriter write() not connected";
+    return 0;
+}
+
+QString UdpReadWriter::settingsText() const {
+    return QString("udp %1:%2").arg(settings.host).arg(settings.port);
+}
+
+void UdpReadWriter::onStateChanged(QAbstractSocket::SocketState state) {
+    if (state == QAbstractSocket::ConnectedState && !linkUp) {
+        linkUp = true;
+        emit connectionChanged(true);
+    } else if (state == QAbstractSocket::UnconnectedState) {
+        // 主机名解析失败; UDP 没有重连, 下次打开时重试
+        qCWarning(lcTransport) << "UdpReadWriter connect" << settings.host << settings.port << "failed:" << socket->errorString();
+        if (linkUp) {
+            linkUp = false;
+            emit connectionChanged(false);
+        }
+    }
+}
+
+void UdpReadWriter::onDatagrams() {
+    while (socket->hasPendingDatagrams()) {
+        const qint64 size = socket->pendingDatagramSize();
+        if (size < 0) {
+            break;
+        }
+        const int offset = rxBuff.size();
+        rxBuff.resize(offset + static_cast<int>(size));
+        const qint64 n = socket->readDatagram(rxBuff.data() + offset, size);
+        rxBuff.resize(offset + static_cast<int>(qMax<qint64>(n, 0)));
+    }
+    if (!rxBuff.isEmpty()) {
+        emit readyRead();
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef UDPREADWRITER_H
+#define UDPREADWRITER_H
+
+#include <QtNetwork/QUdpSocket>
+#include <QtCore/QByteArray>
+#include "AbstractReadWriter.h"
+#include "NetSettings.h"
+
+/*
+ * 网口工装板的 UDP 读写者. 每条命令一个数据报, 只接收来自工装板地址的数据报.
+ * 数据报先整包取出再按字节流交给上层, 避免上层分段读取时截断数据报.
+ * open 不等待主机名解析, 可以发送时发出 connectionChanged(true).
+ */
+class UdpReadWriter : public AbstractReadWriter {
+Q_OBJECT
+public:
+    explicit UdpReadWriter(QObject *parent = nullptr);
+
+    void setNetSettings(const NetSettings &netSettings);
+
+    QString settingsText() const override;
+
+    bool open() override;
+
+    bool isOpen() override;
+
+    bool isConnected() override;
+
+    void close() override;
+
+    QByteArray readAll() override;
+
+    qint64 read(char *data, qint64 maxSize) override;
+
+    qint64 write(const QByteArray &byteArray) const override;
+
+private slots:
+    void onStateChanged(QAbstractSocket::SocketState state);
+
+    void onDatagrams();
+
+private:
+    NetSettings settings;
+    QUdpSocket *socket{nullptr};
+    QByteArray rxBuff;
+    bool linkUp{false};
+};
+
+
+#endif //UDPREADWRITER_H
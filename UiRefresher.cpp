@@ -0,0 +1,53 @@
+#include "UiRefresher.h"
+
+UiRefresher::UiRefresher(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setInterval(UI_REFRESH_MS);
+    connect(&m_timer, &QTimer::timeout, this, &UiRefresher::refresh);
+}
+
+void UiRefresher::watch(const TestStation *station, View view)
+{
+    unwatch(station);
+    Entry entry;
+    entry.station = station;
+    entry.view = std::move(view);
+    entry.version = station->snapshot().version;
+    m_entries.append(entry);
+}
+
+void UiRefresher::unwatch(const TestStation *station)
+{
+    for (int i = 0; i < m_entries.size(); i++) {
+        if (m_entries.at(i).station == station) {
+            m_entries.remove(i);
+            return;
+        }
+    }
+}
+
+void UiRefresher::wake(void)
+{
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void UiRefresher::refresh(void)
+{
+    m_frames++;
+    bool running = false;
+    for (Entry &entry : m_entries) {
+        const StationSnapshot snapshot = entry.station->snapshot();
+        if (snapshot.state == StationSnapshot::RUNNING)
+            running = true;
+        if (snapshot.version == entry.version)
+            continue;
+        entry.version = snapshot.version;
+        m_repaints++;
+        entry.view(snapshot);
+    }
+    // 最后一帧已经画出结束状态
+    if (!running)
+        m_timer.stop();
+}
@@ -0,0 +1,53 @@
+#ifndef UIREFRESHER_H
+#define UIREFRESHER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+#include "TestStation.h"
+
+/*
+ * 界面刷新层: 测试只更新工位的原子快照, 这里按 UI_REFRESH_MS 的帧率拉取,
+ * 两帧之间的多次进度变化合并为一次重绘. 所有工位共用一个定时器,
+ * 界面开销只与工位数和帧率有关, 与事件数量无关; 没有工位在测试时定时器停止.
+ */
+class UiRefresher : public QObject
+{
+    Q_OBJECT
+
+#define    UI_REFRESH_MS    50   // 最高 20 帧/秒
+
+public:
+    typedef std::function<void(const StationSnapshot &snapshot)> View;
+
+    explicit UiRefresher(QObject *parent = nullptr);
+
+    // 工位快照变化后, 在下一帧以最新快照调用 view; 每个工位一个视图
+    void watch(const TestStation *station, View view);
+    void unwatch(const TestStation *station);
+
+    // 有工位开始测试后调用, 启动刷新
+    void wake(void);
+    bool isActive(void) const { return m_timer.isActive(); }
+
+    quint64 frameCount(void) const { return m_frames; }
+    quint64 repaintCount(void) const { return m_repaints; }
+
+public slots:
+    void refresh(void);
+
+private:
+    struct Entry {
+        const TestStation *station;
+        View view;
+        quint32 version;
+    };
+
+    QVector<Entry> m_entries;
+    QTimer m_timer;
+    quint64 m_frames = 0;
+    quint64 m_repaints = 0;
+};
+
+#endif // UIREFRESHER_H
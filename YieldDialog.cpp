@@ -0,0 +1,179 @@
+#include "YieldDialog.h"
+#include "YieldStats.h"
+#include "ResultStore.h"
+#include "ComTest.h"
+#include "uiglobal.h"
+
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+QString percent(double ratio)
+{
+    return QString::number(ratio * 100.0, 'f', 1) + "%";
+}
+
+QTableWidget *createTable(const QStringList &headers, QWidget *parent)
+{
+    auto table = new QTableWidget(parent);
+    table->setColumnCount(headers.size());
+    table->setHorizontalHeaderLabels(headers);
+    table->verticalHeader()->setVisible(false);
+    table->verticalHeader()->setDefaultSectionSize(22);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setStretchLastSection(true);
+    return table;
+}
+
+}
+
+YieldDialog::YieldDialog(YieldStats *stats, ResultStore *store, qint64 startedAt, QWidget *parent)
+    : QDialog(parent)
+    , m_stats(stats)
+    , m_store(store)
+    , m_startedAt(startedAt)
+    , m_summary(new QLabel(this))
+{
+    setWindowTitle(tr("良率统计"));
+    resize(640, 560);
+
+    m_itemTable = createTable(QStringList() << tr("测试项") << tr("本班失败") << tr("本班失败率")
+                              << tr("本班未测完") << tr("本班重试") << tr("累计失败率"), this);
+    m_itemTable->setRowCount(TEST_ITEMS_NUM + YIELD_485_CHANNELS);
+    m_hourTable = createTable(QStringList() << tr("时段") << tr("板数") << tr("一次通过率")
+                              << tr("通过率") << tr("平均周期(ms)"), this);
+    m_hourTable->setRowCount(YIELD_HOURS);
+
+    auto refreshBtn = new QPushButton(tr("刷新"), this);
+    auto resetBtn = new QPushButton(tr("清零"), this);
+    connect(refreshBtn, &QPushButton::clicked, this, &YieldDialog::refresh);
+    connect(resetBtn, &QPushButton::clicked, this, &YieldDialog::resetStats);
+
+    auto buttons = new QHBoxLayout;
+    buttons->addStretch();
+    buttons->addWidget(refreshBtn);
+    buttons->addWidget(resetBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_summary);
+    layout->addWidget(m_itemTable, 1);
+    layout->addWidget(m_hourTable, 1);
+    layout->addLayout(buttons);
+
+    m_timer.setInterval(YIELD_REFRESH_MS);
+    connect(&m_timer, &QTimer::timeout, this, &YieldDialog::refresh);
+}
+
+void YieldDialog::showEvent(QShowEvent *event)
+{
+    if (!m_stats->isSeeded())
+        seedFromStore();
+    refresh();
+    m_timer.start();
+    QDialog::showEvent(event);
+}
+
+void YieldDialog::hideEvent(QHideEvent *event)
+{
+    m_timer.stop();
+    QDialog::hideEvent(event);
+}
+
+// 只在第一次打开时导入一次结果库, 之后全部由测试结束时的增量更新.
+// 库中按分钟汇总(一天最多 1440 行), 在结果库的后台线程中执行, 不阻塞界面
+void YieldDialog::seedFromStore(void)
+{
+    m_stats->setSeeded(true);
+    if (m_store == nullptr || !m_store->isOpen())
+        return;
+
+    const qint64 from = m_startedAt - YIELD_SEED_HOURS * 3600 * 1000LL;
+    m_seeding = true;
+    m_store->yieldByMinuteAsync(from, m_startedAt, this, [this](const QVector<QPair<qint64, YieldCounters>> &minutes) {
+        // 导入完成前清零过的不再导入
+        if (!m_seeding)
+            return;
+        m_seeding = false;
+        for (const QPair<qint64, YieldCounters> &minute : minutes)
+            m_stats->record(minute.first, minute.second);
+        refresh();
+    });
+}
+
+QString YieldDialog::summaryLine(const QString &title, const YieldCounters &counters)
+{
+    return tr("%1: 板数 %2, 一次通过率 %3, 通过率 %4, 通信超时 %5, 平均周期 %6 ms")
+            .arg(title).arg(counters.runs).arg(percent(counters.firstPassYield())).arg(percent(counters.yield()))
+            .arg(counters.timeouts).arg(counters.meanCycleMs(), 0, 'f', 0);
+}
+
+void YieldDialog::setCell(QTableWidget *table, int row, int col, const QString &text)
+{
+    QTableWidgetItem *item = table->item(row, col);
+    if (item == nullptr) {
+        item = new QTableWidgetItem;
+        table->setItem(row, col, item);
+    }
+    item->setText(text);
+}
+
+void YieldDialog::refresh(void)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 shiftStart = 0;
+    qint64 prevShiftStart = 0;
+    const YieldCounters shift = m_stats->currentShift(now, &shiftStart);
+    const YieldCounters prevShift = m_stats->previousShift(now, &prevShiftStart);
+    const YieldCounters lastHour = m_stats->lastHour(now);
+    const YieldCounters &total = m_stats->total();
+
+    // 本班已过的时间不足一小时时按一小时算
+    const double shiftHours = qMax(1.0, (now - shiftStart) / 3600000.0);
+    QStringList lines;
+    lines << summaryLine(tr("当前班次(%1 起)").arg(QDateTime::fromMSecsSinceEpoch(shiftStart).toString("MM-dd HH:mm")), shift)
+             + tr(", 每小时 %1 块").arg(shift.runs / shiftHours, 0, 'f', 1);
+    lines << summaryLine(tr("上一班次(%1 起)").arg(QDateTime::fromMSecsSinceEpoch(prevShiftStart).toString("MM-dd HH:mm")), prevShift);
+    lines << summaryLine(tr("最近 60 分钟"), lastHour) + tr(", 即每小时 %1 块").arg(lastHour.runs);
+    lines << summaryLine(tr("累计"), total);
+    m_summary->setText(lines.join("\n"));
+
+    for (int i = 0; i < TEST_ITEMS_NUM + YIELD_485_CHANNELS; i++) {
+        const bool isItem = i < TEST_ITEMS_NUM;
+        const int ch = i - TEST_ITEMS_NUM;
+        const quint32 failed = isItem ? shift.itemFailed[i] : shift.channel485Failed[ch];
+        setCell(m_itemTable, i, 0, isItem ? QString(ComTest::itemName(i)) : tr("485 通道%1").arg(ch + 1));
+        setCell(m_itemTable, i, 1, QString::number(failed));
+        setCell(m_itemTable, i, 2, percent(isItem ? shift.itemFailRate(i) : shift.channelFailRate(ch)));
+        // 未测完: 前面的项失败后没有测到、超时或中止, 不计入失败率
+        setCell(m_itemTable, i, 3, isItem ? QString::number(shift.itemMissing[i]) : QString());
+        setCell(m_itemTable, i, 4, isItem ? QString::number(shift.itemRetried[i]) : QString());
+        setCell(m_itemTable, i, 5, percent(isItem ? total.itemFailRate(i) : total.channelFailRate(ch)));
+    }
+
+    // 新的小时在上
+    const QList<QPair<qint64, YieldCounters>> hours = m_stats->hours(now);
+    for (int row = 0; row < hours.size(); row++) {
+        const QPair<qint64, YieldCounters> &hour = hours.at(hours.size() - 1 - row);
+        const YieldCounters &counters = hour.second;
+        setCell(m_hourTable, row, 0, QDateTime::fromMSecsSinceEpoch(hour.first).toString("MM-dd HH:00"));
+        setCell(m_hourTable, row, 1, QString::number(counters.runs));
+        setCell(m_hourTable, row, 2, counters.runs ? percent(counters.firstPassYield()) : QString());
+        setCell(m_hourTable, row, 3, counters.runs ? percent(counters.yield()) : QString());
+        setCell(m_hourTable, row, 4, counters.cycles ? QString::number(counters.meanCycleMs(), 'f', 0) : QString());
+    }
+}
+
+void YieldDialog::resetStats(void)
+{
+    if (!showQuestion(tr("清零"), tr("确定清除全部良率统计?"), this))
+        return;
+    m_stats->reset();
+    m_seeding = false;
+    refresh();
+}
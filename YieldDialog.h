@@ -0,0 +1,55 @@
+#ifndef YIELDDIALOG_H
+#define YIELDDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+class QLabel;
+class QTableWidget;
+class ResultStore;
+class YieldStats;
+struct YieldCounters;
+
+/*
+ * 良率看板: 当前/上一班次、最近 60 分钟和累计的板数、一次通过率、平均周期,
+ * 本班各测试项和 485 各通道的失败率, 最近 24 小时逐小时产能. 可见时每秒刷新,
+ * 每次刷新只读取 YieldStats 的定长计数.
+ */
+class YieldDialog : public QDialog
+{
+    Q_OBJECT
+
+#define    YIELD_REFRESH_MS    1000
+#define    YIELD_SEED_HOURS    24   // 第一次打开时从结果库导入的时长
+
+public:
+    // startedAt 之后的测试已实时计入 stats, 结果库中只导入之前的; store 可为 nullptr
+    YieldDialog(YieldStats *stats, ResultStore *store, qint64 startedAt, QWidget *parent = nullptr);
+
+public slots:
+    void refresh(void);
+
+private slots:
+    void resetStats(void);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void seedFromStore(void);
+    static QString summaryLine(const QString &title, const YieldCounters &counters);
+    static void setCell(QTableWidget *table, int row, int col, const QString &text);
+
+private:
+    YieldStats *m_stats;
+    ResultStore *m_store;
+    qint64 m_startedAt;
+    bool m_seeding = false;     // 正在从结果库导入
+    QLabel *m_summary;
+    QTableWidget *m_itemTable;
+    QTableWidget *m_hourTable;
+    QTimer m_timer;
+};
+
+#endif // YIELDDIALOG_H
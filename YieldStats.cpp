@@ -0,0 +1,248 @@
+#include "YieldStats.h"
+#include "ResultStore.h"
+
+#include <QDateTime>
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+
+const qint64 kMinuteMs = 60 * 1000;
+const qint64 kHourMs = 60 * kMinuteMs;
+
+qint64 localMs(const QDate &date, int minuteOfDay)
+{
+    return QDateTime(date, QTime(minuteOfDay / 60, minuteOfDay % 60)).toMSecsSinceEpoch();
+}
+
+}
+
+void YieldCounters::add(const RunRecord &run)
+{
+    runs++;
+    if (run.result == ComTest::GZ_END_COM_TIMEOUT)
+        timeouts++;
+
+    bool retried = false;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        // 没有测到的项不算该项的失败, 否则一项失败后后面各项的失败率都被抬高
+        if (!run.done[i])
+            itemMissing[i]++;
+        else if (!run.pass[i])
+            itemFailed[i]++;
+        if (run.attempts[i] > 1) {
+            itemRetried[i]++;
+            retried = true;
+        }
+    }
+    if (run.result == ComTest::GZ_END_SUCCESS) {
+        passed++;
+        if (!retried)
+            firstPass++;
+    }
+    // 485 收到了失败应答才有通道结果, 超时时不计
+    if (run.done[TEST_IDX_485] && !run.pass[TEST_IDX_485]) {
+        for (int ch = 0; ch < YIELD_485_CHANNELS; ch++) {
+            if ((run.mask485 & (1u << ch)) == 0)
+                channel485Failed[ch]++;
+        }
+    }
+    if (run.cycleMs >= 0) {
+        cycleMsSum += run.cycleMs;
+        cycles++;
+    }
+}
+
+void YieldCounters::merge(const YieldCounters &other)
+{
+    runs += other.runs;
+    passed += other.passed;
+    firstPass += other.firstPass;
+    timeouts += other.timeouts;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        itemFailed[i] += other.itemFailed[i];
+        itemMissing[i] += other.itemMissing[i];
+        itemRetried[i] += other.itemRetried[i];
+    }
+    for (int ch = 0; ch < YIELD_485_CHANNELS; ch++)
+        channel485Failed[ch] += other.channel485Failed[ch];
+    cycleMsSum += other.cycleMsSum;
+    cycles += other.cycles;
+}
+
+YieldStats::YieldStats()
+{
+    m_shiftStarts << 8 * 60 << 20 * 60;
+}
+
+void YieldStats::setShiftStarts(const QList<int> &minutesOfDay)
+{
+    QList<int> starts;
+    for (int minute : minutesOfDay) {
+        if (minute >= 0 && minute < 24 * 60 && !starts.contains(minute))
+            starts << minute;
+    }
+    if (starts.isEmpty())
+        starts << 0;
+    std::sort(starts.begin(), starts.end());
+    m_shiftStarts = starts;
+    restartShift();
+}
+
+bool YieldStats::setShiftStarts(const QString &spec)
+{
+    QList<int> starts;
+    for (const QString &item : spec.split(',')) {
+        if (item.trimmed().isEmpty())
+            continue;
+        const QTime time = QTime::fromString(item.trimmed(), "H:mm");
+        if (!time.isValid())
+            return false;
+        starts << time.hour() * 60 + time.minute();
+    }
+    if (starts.isEmpty())
+        return false;
+    setShiftStarts(starts);
+    return true;
+}
+
+void YieldStats::restartShift(void)
+{
+    m_shiftStart = -1;
+    m_shiftEnd = -1;
+    m_shift = YieldCounters();
+    m_prevShiftStart = -1;
+    m_prevShift = YieldCounters();
+}
+
+void YieldStats::reset(void)
+{
+    for (Slot &slot : m_minutes)
+        slot = Slot();
+    for (Slot &slot : m_hours)
+        slot = Slot();
+    m_total = YieldCounters();
+    restartShift();
+}
+
+void YieldStats::addToRing(Slot *ring, int size, qint64 id, const YieldCounters &counters)
+{
+    Slot &slot = ring[id % size];
+    if (slot.id != id) {
+        // 格子里是更新的数据, 这条记录已经不在窗口内
+        if (slot.id > id)
+            return;
+        slot.id = id;
+        slot.counters = YieldCounters();
+    }
+    slot.counters.merge(counters);
+}
+
+// ms 所在班次的开始和结束时间, 只在换班时调用
+void YieldStats::shiftBounds(qint64 ms, qint64 *start, qint64 *end) const
+{
+    const QDateTime dt = QDateTime::fromMSecsSinceEpoch(ms);
+    const QDate date = dt.date();
+    const int minute = dt.time().hour() * 60 + dt.time().minute();
+
+    int idx = -1;
+    while (idx + 1 < m_shiftStarts.size() && m_shiftStarts.at(idx + 1) <= minute)
+        idx++;
+    if (idx < 0) {
+        // 当天第一次交班之前, 属于前一天的最后一班
+        *start = localMs(date.addDays(-1), m_shiftStarts.last());
+        *end = localMs(date, m_shiftStarts.first());
+    } else if (idx + 1 < m_shiftStarts.size()) {
+        *start = localMs(date, m_shiftStarts.at(idx));
+        *end = localMs(date, m_shiftStarts.at(idx + 1));
+    } else {
+        *start = localMs(date, m_shiftStarts.at(idx));
+        *end = localMs(date.addDays(1), m_shiftStarts.first());
+    }
+}
+
+void YieldStats::record(const RunRecord &run)
+{
+    YieldCounters counters;
+    counters.add(run);
+    record(run.startedAt, counters);
+}
+
+void YieldStats::record(qint64 t, const YieldCounters &counters)
+{
+    m_total.merge(counters);
+    addToRing(m_minutes, YIELD_MINUTES, t / kMinuteMs, counters);
+    addToRing(m_hours, YIELD_HOURS, t / kHourMs, counters);
+
+    if (m_shiftStart < 0 || t >= m_shiftEnd) {
+        // 换班: 紧接着的一班成为上一班, 中间隔了整班没有测试时上一班为空
+        qint64 start, end;
+        shiftBounds(t, &start, &end);
+        if (m_shiftStart >= 0 && start == m_shiftEnd) {
+            m_prevShiftStart = m_shiftStart;
+            m_prevShift = m_shift;
+        } else {
+            m_prevShiftStart = -1;
+            m_prevShift = YieldCounters();
+        }
+        m_shiftStart = start;
+        m_shiftEnd = end;
+        m_shift = YieldCounters();
+    } else if (t < m_shiftStart) {
+        // 导入的旧记录: 只保留上一班的
+        if (m_prevShiftStart < 0) {
+            qint64 start, end;
+            shiftBounds(t, &start, &end);
+            if (end != m_shiftStart)
+                return;
+            m_prevShiftStart = start;
+        }
+        if (t >= m_prevShiftStart)
+            m_prevShift.merge(counters);
+        return;
+    }
+    m_shift.merge(counters);
+}
+
+YieldCounters YieldStats::lastHour(qint64 nowMs) const
+{
+    const qint64 now = nowMs / kMinuteMs;
+    YieldCounters counters;
+    for (const Slot &slot : m_minutes) {
+        if (slot.id > now - YIELD_MINUTES && slot.id <= now)
+            counters.merge(slot.counters);
+    }
+    return counters;
+}
+
+QList<QPair<qint64, YieldCounters>> YieldStats::hours(qint64 nowMs) const
+{
+    const qint64 now = nowMs / kHourMs;
+    QList<QPair<qint64, YieldCounters>> hours;
+    for (qint64 id = now - YIELD_HOURS + 1; id <= now; id++) {
+        const Slot &slot = m_hours[id % YIELD_HOURS];
+        hours.append(qMakePair(id * kHourMs, slot.id == id ? slot.counters : YieldCounters()));
+    }
+    return hours;
+}
+
+YieldCounters YieldStats::currentShift(qint64 nowMs, qint64 *startMs) const
+{
+    qint64 start, end;
+    shiftBounds(nowMs, &start, &end);
+    if (startMs != nullptr)
+        *startMs = start;
+    return start == m_shiftStart ? m_shift : YieldCounters();
+}
+
+YieldCounters YieldStats::previousShift(qint64 nowMs, qint64 *startMs) const
+{
+    qint64 start, end;
+    shiftBounds(nowMs, &start, &end);
+    shiftBounds(start - 1, &start, &end);
+    if (startMs != nullptr)
+        *startMs = start;
+    if (start == m_shiftStart)
+        return m_shift;
+    return start == m_prevShiftStart ? m_prevShift : YieldCounters();
+}
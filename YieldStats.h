@@ -0,0 +1,102 @@
+#ifndef YIELDSTATS_H
+#define YIELDSTATS_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include "ComTest.h"
+
+struct RunRecord;
+
+/*
+ * 一段时间内的良率和产能计数, 每次测试加一次, 只做定长的加法
+ */
+struct YieldCounters {
+#define    YIELD_485_CHANNELS    8
+
+    quint32 runs = 0;
+    quint32 passed = 0;         // 最终通过
+    quint32 firstPass = 0;      // 通过且没有任何一项重试
+    quint32 timeouts = 0;       // 通信超时
+    quint32 itemFailed[TEST_ITEMS_NUM] = {};   // 该项收到了应答且最终未通过
+    quint32 itemMissing[TEST_ITEMS_NUM] = {};  // 该项没有测完(前面的项失败后没有测到、超时或中止)
+    quint32 itemRetried[TEST_ITEMS_NUM] = {};  // 该项尝试了不止一次
+    quint32 channel485Failed[YIELD_485_CHANNELS] = {};
+    qint64 cycleMsSum = 0;
+    quint32 cycles = 0;         // 有周期时间的测试数
+
+    void add(const RunRecord &run);
+    void merge(const YieldCounters &other);
+
+    double firstPassYield(void) const { return runs ? static_cast<double>(firstPass) / runs : 0.0; }
+    double yield(void) const { return runs ? static_cast<double>(passed) / runs : 0.0; }
+    double itemFailRate(int item) const { return runs ? static_cast<double>(itemFailed[item]) / runs : 0.0; }
+    double itemMissRate(int item) const { return runs ? static_cast<double>(itemMissing[item]) / runs : 0.0; }
+    double channelFailRate(int ch) const { return runs ? static_cast<double>(channel485Failed[ch]) / runs : 0.0; }
+    double meanCycleMs(void) const { return cycles ? static_cast<double>(cycleMsSum) / cycles : 0.0; }
+};
+
+/*
+ * 良率与产能统计: 一次通过率、各测试项(含 485 各通道)失败率、每小时板数、平均周期.
+ * record 为 O(1): 分别加到最近 60 分钟的分钟环、最近 24 小时的小时环、当前班次和累计计数中,
+ * 过期的格子在下次写入时整格清零; 读取只合并定长的格子, 不扫描历史记录.
+ * 时间取测试开始时间, 班次按本地时间的交班时刻划分. 只在一个线程(界面线程)中使用.
+ */
+class YieldStats
+{
+#define    YIELD_MINUTES    60
+#define    YIELD_HOURS      24
+
+public:
+    YieldStats();
+
+    // 交班时刻, 当天 0 点起的分钟数, 默认 08:00 和 20:00 两班; 设置后当前班次重新开始
+    void setShiftStarts(const QList<int> &minutesOfDay);
+    // "08:00,20:00" 格式, 无法解析时返回 false 且不修改
+    bool setShiftStarts(const QString &spec);
+    const QList<int> &shiftStarts(void) const { return m_shiftStarts; }
+
+    void record(const RunRecord &run);
+    // 计入同一分钟内多次测试的汇总计数(结果库按分钟汇总的历史), ms 取该分钟的开始, 与逐条 record 等价
+    void record(qint64 ms, const YieldCounters &counters);
+    void reset(void);
+
+    // 累计(上次清零以来)
+    const YieldCounters &total(void) const { return m_total; }
+    // now 之前的 60 分钟, 板数即每小时产能
+    YieldCounters lastHour(qint64 nowMs) const;
+    // 最近 24 个整点小时, 由旧到新, first 为该小时的开始时间
+    QList<QPair<qint64, YieldCounters>> hours(qint64 nowMs) const;
+    // now 所在的班次和上一班次, startMs 返回班次开始时间
+    YieldCounters currentShift(qint64 nowMs, qint64 *startMs = nullptr) const;
+    YieldCounters previousShift(qint64 nowMs, qint64 *startMs = nullptr) const;
+
+    // 结果库中本次启动之前的记录, 第一次打开统计时导入一次; 导入的比已计入的旧, 照样按时间归入各窗口
+    bool isSeeded(void) const { return m_seeded; }
+    void setSeeded(bool seeded) { m_seeded = seeded; }
+
+private:
+    struct Slot {
+        qint64 id = -1;     // 分钟或小时序号(1970 以来)
+        YieldCounters counters;
+    };
+
+    static void addToRing(Slot *ring, int size, qint64 id, const YieldCounters &counters);
+    void shiftBounds(qint64 ms, qint64 *start, qint64 *end) const;
+    void restartShift(void);
+
+private:
+    QList<int> m_shiftStarts;
+    Slot m_minutes[YIELD_MINUTES];
+    Slot m_hours[YIELD_HOURS];
+    YieldCounters m_total;
+    // 有记录以来最新的班次和它的上一班
+    qint64 m_shiftStart = -1;
+    qint64 m_shiftEnd = -1;
+    YieldCounters m_shift;
+    qint64 m_prevShiftStart = -1;
+    YieldCounters m_prevShift;
+    bool m_seeded = false;
+};
+
+#endif // YIELDSTATS_H
@@ -0,0 +1,41 @@
+# 界面程序(含无界面模式), 测试逻辑都在核心库中
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = bw_agv_gz_test
+TEMPLATE = app
+
+include(../gz_common.pri)
+include(../core/core.pri)
+
+SRC_DIR = $$PWD/..
+
+SOURCES += \
+    $$SRC_DIR/HeadlessRunner.cpp \
+    $$SRC_DIR/HexMonitorDialog.cpp \
+    $$SRC_DIR/LatencyDialog.cpp \
+    $$SRC_DIR/StationGrid.cpp \
+    $$SRC_DIR/main.cpp \
+    $$SRC_DIR/uiglobal.cpp \
+    $$SRC_DIR/widget.cpp \
+    $$SRC_DIR/YieldDialog.cpp
+
+HEADERS += \
+    $$SRC_DIR/HeadlessRunner.h \
+    $$SRC_DIR/HexMonitorDialog.h \
+    $$SRC_DIR/LatencyDialog.h \
+    $$SRC_DIR/StationGrid.h \
+    $$SRC_DIR/uiglobal.h \
+    $$SRC_DIR/widget.h \
+    $$SRC_DIR/YieldDialog.h
+
+FORMS += \
+    $$SRC_DIR/widget.ui
+
+RC_ICONS = $$SRC_DIR/res/logo.ico
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
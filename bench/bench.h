@@ -0,0 +1,27 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+// 各基准测试入口, 在 main.cpp 的 kBenchmarks 中登记
+void benchFrameParser();
+void benchAckParse();
+void benchCycle();
+void benchLogModel();
+void benchLogging();
+void benchHex();
+void benchReplay();
+void benchCodec();
+void benchUiRefresh();
+void benchControl();
+void benchResults();
+void benchYield();
+
+// 统一的结果输出格式: "<name>  <value> <unit>"
+void benchReport(const QString &name, double value, const char *unit);
+
+// sorted 已升序排列, p 取 0~1
+double percentile(const QVector<qint64> &sorted, double p);
+
+#endif // BENCH_H
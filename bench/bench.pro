@@ -0,0 +1,28 @@
+QT       -= gui
+QT       += core network serialport sql
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = gz_bench
+
+include(../gz_common.pri)
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp \
+    bench_frameparser.cpp \
+    bench_ackparse.cpp \
+    bench_cycle.cpp \
+    bench_logmodel.cpp \
+    bench_logging.cpp \
+    bench_hex.cpp \
+    bench_replay.cpp \
+    bench_codec.cpp \
+    bench_uirefresh.cpp \
+    bench_control.cpp \
+    bench_results.cpp \
+    bench_yield.cpp
+
+HEADERS += \
+    bench.h
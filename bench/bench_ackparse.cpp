@@ -0,0 +1,147 @@
+#include "bench.h"
+#include "AckParser.h"
+#include "BinaryProtocol.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMap>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace {
+
+const char *const kAcks[] = {
+    "gz_test com ack uart_debug",
+    "gz_test com nack ethernet",
+    "gz_test com nack 485 7f",
+    "gz_test com ack can",
+    "gz_test com ack pmbus",
+};
+const int kAckNum = sizeof(kAcks) / sizeof(kAcks[0]);
+
+/*
+ * 旧实现的原样拷贝(DealWithAck + SaveResult): 两次 QString::split、
+ * 两次 QMap<QString,...> 查找和一次字符串拼接, 作为对照.
+ */
+class LegacyAckParser
+{
+public:
+    LegacyAckParser()
+    {
+        m_ackMap.insert("uart_debug", TEST_IDX_DEBUG_COM);
+        m_ackMap.insert("ethernet",   TEST_IDX_ETHERNET);
+        m_ackMap.insert("485",        TEST_IDX_485);
+        m_ackMap.insert("can",        TEST_IDX_CAN);
+        m_ackMap.insert("pmbus",      TEST_IDX_PMBUS);
+
+        m_stepMap.insert("ack uart_debug",  ComTest::GZ_ACK_DEBUG_COM_SUCCESS);
+        m_stepMap.insert("nack uart_debug", ComTest::GZ_ACK_DEBUG_COM_FAILED);
+        m_stepMap.insert("ack ethernet",    ComTest::GZ_ACK_ETHERNET_SUCCESS);
+        m_stepMap.insert("nack ethernet",   ComTest::GZ_ACK_ETHERNET_FAILED);
+        m_stepMap.insert("ack 485",         ComTest::GZ_ACK_485_SUCCESS);
+        m_stepMap.insert("nack 485",        ComTest::GZ_ACK_485_FAILED);
+        m_stepMap.insert("ack can",         ComTest::GZ_ACK_CAN_SUCCESS);
+        m_stepMap.insert("nack can",        ComTest::GZ_ACK_CAN_FAILED);
+        m_stepMap.insert("ack pmbus",       ComTest::GZ_ACK_PMBUS_SUCCESS);
+        m_stepMap.insert("nack pmbus",      ComTest::GZ_ACK_PMBUS_FAILED);
+    }
+
+    int dealWithAck(const QString &ackBuff)
+    {
+        QStringList ack = ackBuff.split(' ');
+        if (ack.size() < 4)
+            return ComTest::GZ_ACK_NONE;
+
+        QMap<QString, int>::const_iterator it = m_ackMap.find(ack.at(3));
+        if (it == m_ackMap.end())
+            return ComTest::GZ_ACK_NONE;
+        saveResult(ackBuff, it.value());
+
+        QString toVerifyStep;
+        toVerifyStep.append(ack.at(2));
+        toVerifyStep.append(" ");
+        toVerifyStep.append(ack.at(3));
+        QMap<QString, ComTest::eTestAckDef>::const_iterator it2 = m_stepMap.find(toVerifyStep);
+        if (it2 == m_stepMap.end())
+            return ComTest::GZ_ACK_NONE;
+        return it2.value();
+    }
+
+    uint32_t result = 0;
+
+private:
+    void saveResult(const QString &ackBuff, int id)
+    {
+        QStringList ack = ackBuff.split(' ');
+        if (0 == ack[2].compare("nack") && 0 == ack[3].compare("485") && ack.size() > 4 && id == TEST_IDX_485)
+            result = static_cast<uint32_t>(ack[4].toULong(nullptr, 16));
+    }
+
+    QMap<QString, int> m_ackMap;
+    QMap<QString, ComTest::eTestAckDef> m_stepMap;
+};
+
+}
+
+void benchAckParse()
+{
+    const int rounds = 2 * 1000 * 1000;
+
+    // 旧路径的输入是逐字符拼出的 QString, 这里预先构造好, 只计解析本身
+    QVector<QString> strings;
+    QVector<QByteArray> frames;
+    for (int i = 0; i < kAckNum; i++) {
+        strings.append(QString::fromLatin1(kAcks[i]));
+        frames.append(QByteArray(kAcks[i]));
+    }
+
+    LegacyAckParser legacy;
+    long long checksum = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < rounds; i++)
+        checksum += legacy.dealWithAck(strings.at(i % kAckNum));
+    const double legacyNs = static_cast<double>(timer.nsecsElapsed()) / rounds;
+
+    long long checksum2 = 0;
+    timer.restart();
+    for (int i = 0; i < rounds; i++) {
+        const QByteArray &f = frames.at(i % kAckNum);
+        AckParser::ParsedAck ack;
+        if (AckParser::parse(f.constData(), f.size(), &ack))
+            checksum2 += ack.ack;
+    }
+    const double newNs = static_cast<double>(timer.nsecsElapsed()) / rounds;
+
+    // 同样的应答用二进制帧表示: 固定偏移取字段, 与帧内容无关
+    QVector<QByteArray> binFrames;
+    long long wireAscii = 0;
+    long long wireBinary = 0;
+    for (int i = 0; i < kAckNum; i++) {
+        AckParser::ParsedAck ack;
+        AckParser::parse(frames.at(i).constData(), frames.at(i).size(), &ack);
+        const char mask = static_cast<char>(ack.result);
+        binFrames.append(BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, ack.id,
+                                                ack.isPass ? BinaryProtocol::STATUS_ACK : BinaryProtocol::STATUS_NACK,
+                                                &mask, ack.result != 0 ? 1 : 0));
+        wireAscii += frames.at(i).size() + 2;  // 含 \r\n
+        wireBinary += binFrames.at(i).size();
+    }
+    long long checksum3 = 0;
+    timer.restart();
+    for (int i = 0; i < rounds; i++) {
+        const QByteArray &f = binFrames.at(i % kAckNum);
+        AckParser::ParsedAck ack;
+        if (AckParser::parse(f.constData(), f.size(), &ack))
+            checksum3 += ack.ack;
+    }
+    const double binNs = static_cast<double>(timer.nsecsElapsed()) / rounds;
+
+    benchReport("ack parse legacy (split + QMap)", legacyNs, "ns/ack");
+    benchReport("ack parse tokenizer + hash switch", newNs, "ns/ack");
+    benchReport("ack parse speedup", legacyNs / newNs, "x");
+    benchReport("ack parse binary frame", binNs, "ns/ack");
+    benchReport("ack wire bytes ascii", static_cast<double>(wireAscii) / kAckNum, "B/ack");
+    benchReport("ack wire bytes binary", static_cast<double>(wireBinary) / kAckNum, "B/ack");
+    if (checksum != checksum2 || checksum != checksum3)
+        benchReport("ack parse MISMATCH", static_cast<double>(checksum - checksum2 + checksum - checksum3), "");
+}
@@ -0,0 +1,44 @@
+#include "bench.h"
+#include "global.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+
+namespace {
+
+const int kIterations = 200000;
+
+// global.h 中界面和日志实际调用的转换函数, 输入取一条典型的结果描述
+template <typename Fn>
+void runCase(const char *name, int bytes, Fn fn)
+{
+    qint64 sink = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kIterations; i++)
+        sink += fn();
+    const double ns = static_cast<double>(timer.nsecsElapsed());
+    benchReport(QString("codec %1").arg(name), ns / kIterations, "ns/call");
+    benchReport(QString("codec %1 throughput").arg(name), double(bytes) * kIterations * 1e3 / ns, "MB/s");
+    if (sink == 0)
+        benchReport(QString("codec %1 EMPTY OUTPUT").arg(name), 0, "");
+}
+
+}
+
+void benchCodec()
+{
+    const QString text = QString::fromUtf8("测试项: 485 通信失败, 通道掩码 7f; gz_test com nack 485 7f");
+    const QByteArray utf8 = toUtf8ByteArray(text);
+    const QByteArray gbk = toGbkByteArray(text);
+    const QByteArray frame("gz_test com ack uart_debug\r\ngz_test com nack 485 7f\r\n");
+    const QByteArray hex = dataToHex(frame);
+
+    runCase("dataToHex", frame.size(), [&]() { return dataToHex(frame).size(); });
+    runCase("dataFromHex", hex.size(), [&]() { return dataFromHex(QString::fromLatin1(hex)).size(); });
+    runCase("fromUtf8", utf8.size(), [&]() { return fromUtf8(utf8).size(); });
+    runCase("toUtf8ByteArray", utf8.size(), [&]() { return toUtf8ByteArray(text).size(); });
+    runCase("fromGbk", gbk.size(), [&]() { return fromGbk(gbk).size(); });
+    runCase("toGbkByteArray", gbk.size(), [&]() { return toGbkByteArray(text).size(); });
+    runCase("utf82Gbk", utf8.size(), [&]() { return utf82Gbk(text).size(); });
+}
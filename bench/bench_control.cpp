@@ -0,0 +1,152 @@
+#include "bench.h"
+#include "ControlServer.h"
+#include "ComTest.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTimer>
+#include <QtNetwork/QTcpSocket>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/*
+ * 控制接口端到端: 本机 TCP 上的多个客户端各自对一个模拟工位反复 test.run,
+ * 另一个客户端不停 test.status. 统计 test.run 的往返延时、吞吐和结果是否与模拟板设定一致,
+ * 以及测试进行中 status 请求的应答延时(不应被测试阻塞).
+ */
+struct RpcClient {
+    QTcpSocket socket;
+    QByteArray buffer;
+    QString port;
+    int expected = ComTest::GZ_END_SUCCESS;
+    int nextId = 1;
+    QElapsedTimer timer;
+
+    void call(const char *method, const QJsonObject &params)
+    {
+        QJsonObject request;
+        request["jsonrpc"] = "2.0";
+        request["id"] = nextId++;
+        request["method"] = method;
+        request["params"] = params;
+        timer.start();
+        socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+    }
+
+    // 取出一条应答, 跳过服务端通知
+    bool takeReply(QJsonObject *reply)
+    {
+        buffer.append(socket.readAll());
+        int end;
+        while ((end = buffer.indexOf('\n')) >= 0) {
+            const QJsonObject message = QJsonDocument::fromJson(buffer.left(end)).object();
+            buffer.remove(0, end + 1);
+            if (message.contains("id")) {
+                *reply = message;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+void runClients(int clientCnt, int runsPerClient)
+{
+    ControlServer server;
+    if (!server.listenTcp(0)) {
+        benchReport("control LISTEN FAILED", 0, "");
+        return;
+    }
+
+    QEventLoop loop;
+    std::vector<std::unique_ptr<RpcClient>> clients;
+    QVector<qint64> runLatency;
+    QVector<qint64> statusLatency;
+    int unexpected = 0;
+    int running = clientCnt;
+
+    for (int i = 0; i < clientCnt; i++) {
+        std::unique_ptr<RpcClient> client(new RpcClient);
+        RpcClient *c = client.get();
+        // 端口名互不相同, 每个客户端一个工位; 第一个工位设定为 can 失败
+        c->port = (i == 0) ? QString("sim:delay=1,nack=can,id=%1").arg(i) : QString("sim:delay=1,id=%1").arg(i);
+        c->expected = (i == 0) ? ComTest::GZ_END_FAILED : ComTest::GZ_END_SUCCESS;
+        QObject::connect(&c->socket, &QTcpSocket::readyRead, [c, &runLatency, &unexpected, &running,
+                                                              &loop, runsPerClient]() {
+            QJsonObject reply;
+            while (c->takeReply(&reply)) {
+                runLatency.append(c->timer.nsecsElapsed());
+                const QJsonObject result = reply.value("result").toObject();
+                if (result.value("code").toInt(-1) != c->expected)
+                    unexpected++;
+                if (c->nextId <= runsPerClient) {
+                    QJsonObject params;
+                    params["port"] = c->port;
+                    params["pipelined"] = true;
+                    c->call("test.run", params);
+                } else if (--running == 0) {
+                    loop.quit();
+                }
+            }
+        });
+        c->socket.connectToHost(QHostAddress::LocalHost, server.tcpPort());
+        clients.push_back(std::move(client));
+    }
+
+    // 状态查询客户端: 收到应答后立即发下一个
+    RpcClient poller;
+    poller.port = clients.front()->port;
+    QObject::connect(&poller.socket, &QTcpSocket::readyRead, [&poller, &statusLatency]() {
+        QJsonObject reply;
+        while (poller.takeReply(&reply)) {
+            statusLatency.append(poller.timer.nsecsElapsed());
+            QJsonObject params;
+            params["port"] = poller.port;
+            poller.call("test.status", params);
+        }
+    });
+    poller.socket.connectToHost(QHostAddress::LocalHost, server.tcpPort());
+
+    QElapsedTimer timer;
+    timer.start();
+    for (auto &client : clients) {
+        QJsonObject params;
+        params["port"] = client->port;
+        params["pipelined"] = true;
+        client->call("test.run", params);
+    }
+    QJsonObject statusParams;
+    statusParams["port"] = poller.port;
+    poller.call("test.status", statusParams);
+
+    QTimer::singleShot(60000, &loop, &QEventLoop::quit);
+    loop.exec();
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    poller.socket.disconnectFromHost();
+
+    std::sort(runLatency.begin(), runLatency.end());
+    std::sort(statusLatency.begin(), statusLatency.end());
+    const QString name = QString("control %1 clients").arg(clientCnt);
+    benchReport(name + " test.run p50", percentile(runLatency, 0.50) / 1e6, "ms");
+    benchReport(name + " test.run p99", percentile(runLatency, 0.99) / 1e6, "ms");
+    benchReport(name + " throughput", runLatency.size() / seconds, "tests/s");
+    benchReport(name + " test.status p50", percentile(statusLatency, 0.50) / 1e3, "us");
+    benchReport(name + " test.status p99", percentile(statusLatency, 0.99) / 1e3, "us");
+    if (runLatency.size() != clientCnt * runsPerClient)
+        benchReport(name + " MISSING RESULTS", clientCnt * runsPerClient - runLatency.size(), "");
+    if (unexpected > 0)
+        benchReport(name + " UNEXPECTED RESULTS", unexpected, "");
+}
+
+}
+
+void benchControl()
+{
+    runClients(1, 200);
+    runClients(8, 100);
+}
@@ -0,0 +1,108 @@
+#include "bench.h"
+#include "TestStation.h"
+#include "ComTest.h"
+#include "SimDutServer.h"
+#include "LatencyStats.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QVector>
+#include <algorithm>
+#include <ctime>
+
+namespace {
+
+/*
+ * 用模拟设备连续跑完整测试周期(含端口打开/关闭), 统计每周期的延时分布和CPU时间.
+ * persistent 时端口只在第一个周期打开, 之后每周期只做 resync.
+ * CPU 时间取 std::clock(), 包含IO线程.
+ */
+void runCycles(const QString &spec, bool pipelined, int cycles, int expected,
+               LatencyStats *stats = nullptr, const QString &label = QString(), bool persistent = false)
+{
+    TestStation station(spec);
+    station.comTest()->setPipelined(pipelined);
+    station.setPersistentSession(persistent);
+    // 模拟板支持二进制协议时主机也开启协商
+    station.comTest()->setBinaryProtocol(spec.contains("proto=bin"));
+    station.setLatencyStats(stats);
+    station.setAdaptiveTimeout(stats != nullptr);
+    QEventLoop loop;
+    QObject::connect(&station, &TestStation::finished, &loop, &QEventLoop::quit);
+
+    QVector<qint64> latency;
+    latency.reserve(cycles);
+    int unexpected = 0;
+
+    const std::clock_t cpuStart = std::clock();
+    QElapsedTimer timer;
+    for (int i = 0; i < cycles; i++) {
+        timer.start();
+        if (!station.start()) {
+            unexpected++;
+            continue;
+        }
+        loop.exec();
+        latency.append(timer.nsecsElapsed());
+        if (station.lastResult() != expected)
+            unexpected++;
+    }
+    const double cpuMs = 1000.0 * static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    std::sort(latency.begin(), latency.end());
+    const QString name = QString("cycle %1 %2%3").arg(spec, pipelined ? "pipelined" : "sequential", label);
+    benchReport(name + " p50", percentile(latency, 0.50) / 1e6, "ms");
+    benchReport(name + " p99", percentile(latency, 0.99) / 1e6, "ms");
+    benchReport(name + " cpu", cpuMs / cycles, "ms/cycle");
+    if (unexpected > 0)
+        benchReport(name + " UNEXPECTED RESULTS", unexpected, "");
+}
+
+}
+
+void benchCycle()
+{
+    const int cycles = 2000;
+
+    runCycles("sim", false, cycles, ComTest::GZ_END_SUCCESS);
+    runCycles("sim", true, cycles, ComTest::GZ_END_SUCCESS);
+    // 持久会话: 省掉每周期创建IO线程和打开/关闭端口
+    runCycles("sim", false, cycles, ComTest::GZ_END_SUCCESS, nullptr, " persistent", true);
+    runCycles("sim", true, cycles, ComTest::GZ_END_SUCCESS, nullptr, " persistent", true);
+    runCycles("sim:split=4,gap=1", false, cycles / 4, ComTest::GZ_END_SUCCESS);
+    // 二进制协议: 每周期多一次协商往返, 换来更短的帧和 O(1) 解码
+    runCycles("sim:proto=bin", false, cycles, ComTest::GZ_END_SUCCESS);
+    runCycles("sim:proto=bin", true, cycles, ComTest::GZ_END_SUCCESS);
+    runCycles("sim:proto=bin,nack=485,mask=7f,split=4,gap=1", true, cycles / 4, ComTest::GZ_END_FAILED);
+    // 不带结束符时每帧要等空闲超时, 周期明显变长
+    runCycles("sim:term=none", false, cycles / 20, ComTest::GZ_END_SUCCESS);
+    runCycles("sim:nack=485,mask=7f", true, cycles, ComTest::GZ_END_FAILED);
+    runCycles("sim:delay=2,jitter=2", true, cycles / 4, ComTest::GZ_END_SUCCESS);
+    // 485 第一次 nack, 只重发这一项
+    runCycles("sim:flaky=485", false, cycles / 4, ComTest::GZ_END_SUCCESS);
+    runCycles("sim:flaky=485", true, cycles / 4, ComTest::GZ_END_SUCCESS);
+
+    // 不在线的板子: 配置超时 vs 按历史延时(每项约 2 ms)收紧后的自适应超时
+    const QString dead("sim:drop=uart_debug+ethernet+485+can+pmbus");
+    LatencyStats history;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        for (int n = 0; n < 100; n++)
+            history.record(dead, i, 2000);
+    }
+    runCycles(dead, false, 3, ComTest::GZ_END_COM_TIMEOUT);
+    runCycles(dead, false, 20, ComTest::GZ_END_COM_TIMEOUT, &history, " adaptive");
+
+    // 本机回环上的网口替身, 包含 socket 收发和每周期的建连/断开
+    SimDutServer server;
+    if (!server.listen()) {
+        benchReport("loopback server UNAVAILABLE", 0, "");
+        return;
+    }
+    const QString tcp = QString("tcp://127.0.0.1:%1").arg(server.port());
+    const QString udp = QString("udp://127.0.0.1:%1").arg(server.port());
+    runCycles(tcp, false, cycles / 4, ComTest::GZ_END_SUCCESS);
+    runCycles(tcp, true, cycles / 4, ComTest::GZ_END_SUCCESS);
+    runCycles(tcp, true, cycles / 4, ComTest::GZ_END_SUCCESS, nullptr, " persistent", true);
+    runCycles(udp, false, cycles / 4, ComTest::GZ_END_SUCCESS);
+    runCycles(udp, true, cycles / 4, ComTest::GZ_END_SUCCESS);
+}
@@ -0,0 +1,86 @@
+#include "bench.h"
+#include "FrameParser.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QVector>
+#include <random>
+
+namespace {
+
+// 合成应答流: 带/不带结束符的帧混合, 模拟粘帧
+QByteArray makeStream(int frames)
+{
+    static const char *const acks[] = {
+        "gz_test com ack uart_debug",
+        "gz_test com ack ethernet",
+        "gz_test com nack 485 7f",
+        "gz_test com ack can",
+        "gz_test com nack pmbus",
+    };
+    static const char *const tails[] = { "\r\n", "\n", "" };
+
+    std::mt19937 rng(20191126);
+    QByteArray stream;
+    stream.reserve(frames * 32);
+    for (int i = 0; i < frames; i++) {
+        stream.append(acks[i % 5]);
+        stream.append(tails[rng() % 3]);
+    }
+    return stream;
+}
+
+// 按随机长度切块, 模拟 readyRead 每次到达的数据量, 保证帧被拆开
+QVector<int> makeChunks(int total, int maxChunk)
+{
+    std::mt19937 rng(7);
+    QVector<int> chunks;
+    while (total > 0) {
+        int n = 1 + static_cast<int>(rng() % static_cast<unsigned>(maxChunk));
+        if (n > total)
+            n = total;
+        chunks.append(n);
+        total -= n;
+    }
+    return chunks;
+}
+
+void runOnce(const QByteArray &stream, int maxChunk, int expected)
+{
+    const QVector<int> chunks = makeChunks(stream.size(), maxChunk);
+
+    unsigned long long bytes = 0;
+    FrameParser parser;
+    parser.setFrameHandler([&bytes](const char *, int len) {
+        bytes += static_cast<unsigned long long>(len);
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    const char *p = stream.constData();
+    for (int n : chunks) {
+        parser.feed(p, n);
+        p += n;
+    }
+    parser.flush();
+    const qint64 ns = timer.nsecsElapsed();
+
+    const double seconds = ns / 1e9;
+    const QString name = QString("frameparser chunk<=%1").arg(maxChunk);
+    benchReport(name + " frames/s", parser.frameCount() / seconds, "");
+    benchReport(name + " throughput", stream.size() / seconds / (1024.0 * 1024.0), "MB/s");
+    if (static_cast<int>(parser.frameCount()) != expected)
+        benchReport(name + " LOST FRAMES", expected - static_cast<double>(parser.frameCount()), "");
+}
+
+}
+
+void benchFrameParser()
+{
+    const int frames = 1000 * 1000;
+    const QByteArray stream = makeStream(frames);
+
+    runOnce(stream, 8, frames);
+    runOnce(stream, 64, frames);
+    runOnce(stream, 4096, frames);
+}
@@ -0,0 +1,102 @@
+#include "bench.h"
+#include "HexCodec.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <cstdio>
+
+namespace {
+
+// 改为 HexCodec 之前 global.cpp 中的实现, 作为对照
+QByteArray legacyToHex(const QByteArray &data)
+{
+    QByteArray result = data.toHex().toUpper();
+    for (int i = 2; i < result.size(); i += 3)
+        result.insert(i, ' ');
+    return result;
+}
+
+QByteArray legacyFromHex(const QByteArray &hex)
+{
+    QByteArray line = hex;
+    line.replace(' ', QByteArray());
+    return QByteArray::fromHex(line);
+}
+
+QByteArray encodeWith(const QByteArray &data, HexCodec::Impl impl)
+{
+    QByteArray result;
+    result.resize(int(HexCodec::encodedSize(size_t(data.size()))));
+    HexCodec::encode(reinterpret_cast<const unsigned char *>(data.constData()), size_t(data.size()),
+                     result.data(), impl);
+    return result;
+}
+
+QByteArray decodeWith(const QByteArray &hex, HexCodec::Impl impl)
+{
+    QByteArray result;
+    result.resize(hex.size() / 2);
+    result.resize(int(HexCodec::decode(hex.constData(), size_t(hex.size()),
+                                       reinterpret_cast<unsigned char *>(result.data()), impl)));
+    return result;
+}
+
+// 每种实现各跑约 totalBytes 的输入, 以原始报文字节计 MB/s
+template <typename Fn>
+void runCase(const QString &name, int size, qint64 totalBytes, Fn fn)
+{
+    const int rounds = int(qMax<qint64>(1, totalBytes / size));
+    int sink = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < rounds; i++)
+        sink += fn().size();
+    const double ns = static_cast<double>(timer.nsecsElapsed());
+    if (sink == 0)
+        fprintf(stderr, "%s: empty output\n", qPrintable(name));
+    benchReport(QString("hex %1 %2B").arg(name).arg(size), double(size) * rounds * 1e3 / ns, "MB/s");
+}
+
+}
+
+void benchHex()
+{
+    const int sizes[] = { 16, 256, 4096, 1 << 20 };
+    const qint64 totalBytes = 64 << 20;
+
+    for (int size : sizes) {
+        QByteArray data(size, Qt::Uninitialized);
+        quint32 seed = 0x9E3779B9u;
+        for (int i = 0; i < size; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            data[i] = char(seed >> 24);
+        }
+        const QByteArray hex = legacyToHex(data);
+
+        // 各实现的结果必须与旧实现一致
+        for (int impl = 0; impl < HexCodec::IMPL_NUM; impl++) {
+            if (!HexCodec::isSupported(HexCodec::Impl(impl)))
+                continue;
+            if (encodeWith(data, HexCodec::Impl(impl)) != hex || decodeWith(hex, HexCodec::Impl(impl)) != data)
+                fprintf(stderr, "hex %s mismatch at %d bytes\n", HexCodec::implName(HexCodec::Impl(impl)), size);
+        }
+
+        // 旧实现逐个 insert, 报文越大越慢(平方级), 大报文跑不完不测
+        if (size <= 4096)
+            runCase("encode legacy", size, totalBytes, [&]() { return legacyToHex(data); });
+        for (int impl = 0; impl < HexCodec::IMPL_NUM; impl++) {
+            if (!HexCodec::isSupported(HexCodec::Impl(impl)))
+                continue;
+            runCase(QString("encode %1").arg(HexCodec::implName(HexCodec::Impl(impl))), size, totalBytes,
+                    [&]() { return encodeWith(data, HexCodec::Impl(impl)); });
+        }
+
+        runCase("decode legacy", size, totalBytes, [&]() { return legacyFromHex(hex); });
+        for (int impl = 0; impl < HexCodec::IMPL_NUM; impl++) {
+            if (!HexCodec::isSupported(HexCodec::Impl(impl)))
+                continue;
+            runCase(QString("decode %1").arg(HexCodec::implName(HexCodec::Impl(impl))), size, totalBytes,
+                    [&]() { return decodeWith(hex, HexCodec::Impl(impl)); });
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#include "bench.h"
+#include "Logging.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+
+namespace {
+
+const int kIterations = 1000000;
+
+/*
+ * 关闭的分类日志和跟踪环的单次开销; 对照为旧代码每个数据块都做的 toHex 格式化.
+ */
+void benchDisabledDebug()
+{
+    const QByteArray chunk("gz_test com ack uart_debug\r\n");
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kIterations; i++)
+        qCDebug(lcTransport) << "rx" << chunk.size() << "bytes" << chunk.toHex();
+    benchReport("qCDebug disabled", static_cast<double>(timer.nsecsElapsed()) / kIterations, "ns/call");
+
+    qint64 sink = 0;
+    timer.start();
+    for (int i = 0; i < kIterations; i++)
+        sink += chunk.toHex().size();
+    benchReport("toHex formatting only (old hot path)", static_cast<double>(timer.nsecsElapsed()) / kIterations, "ns/call");
+    if (sink == 0)
+        benchReport("unexpected empty hex", 0, "");
+}
+
+void benchTrace(bool enabled)
+{
+    TraceRing &ring = TraceRing::instance();
+    ring.setEnabled(enabled);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kIterations; i++)
+        GZ_TRACE(TRACE_RX, 1, i, 0);
+    benchReport(enabled ? "GZ_TRACE enabled" : "GZ_TRACE disabled",
+                static_cast<double>(timer.nsecsElapsed()) / kIterations, "ns/call");
+    ring.setEnabled(false);
+    ring.clear();
+}
+
+}
+
+void benchLogging()
+{
+    benchDisabledDebug();
+    benchTrace(false);
+    benchTrace(true);
+}
@@ -0,0 +1,39 @@
+#include "bench.h"
+#include "LogModel.h"
+
+#include <QtCore/QElapsedTimer>
+
+namespace {
+
+/*
+ * 模拟长时间浸泡测试的日志量: 行数远超容量时, 每行的追加+批量刷新耗时
+ * 应与已写入的行数无关, 模型行数停在容量上.
+ */
+void runAppend(int lines, int batch)
+{
+    LogModel model;
+    const QString message("[COM3] gz_test com ack uart_debug");
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < lines; i++) {
+        model.append(message);
+        if ((i + 1) % batch == 0)
+            model.flush();
+    }
+    model.flush();
+    const double ns = static_cast<double>(timer.nsecsElapsed());
+
+    const QString name = QString("logmodel %1 lines batch %2").arg(lines).arg(batch);
+    benchReport(name, ns / lines, "ns/line");
+    benchReport(name + " rows", model.rowCount(), "rows");
+}
+
+}
+
+void benchLogModel()
+{
+    runAppend(LOG_MODEL_CAPACITY, 50);
+    runAppend(100 * LOG_MODEL_CAPACITY, 50);
+    runAppend(100 * LOG_MODEL_CAPACITY, 1);
+}
@@ -0,0 +1,131 @@
+#include "bench.h"
+#include "TestStation.h"
+#include "ComTest.h"
+#include "FrameParser.h"
+#include "AckParser.h"
+#include "TrafficCapture.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QVector>
+#include <algorithm>
+
+namespace {
+
+// 用模拟设备跑 cycles 次并抓包, 返回各次的抓包文件
+QStringList captureCycles(const QString &spec, const QString &dir, int cycles)
+{
+    TestStation station(spec);
+    station.comTest()->setPipelined(true);
+    station.setCaptureDir(dir);
+    QEventLoop loop;
+    QObject::connect(&station, &TestStation::finished, &loop, &QEventLoop::quit);
+
+    QStringList files;
+    for (int i = 0; i < cycles; i++) {
+        if (!station.start())
+            continue;
+        loop.exec();
+        files.append(station.captureFile());
+    }
+    return files;
+}
+
+/*
+ * 只测分帧 + 应答解析: 抓包中所有接收记录按原始分段喂给 FrameParser,
+ * 与真实端口上 readData 的调用方式相同.
+ */
+void runParser(const QStringList &files, int rounds)
+{
+    QVector<QByteArray> chunks;
+    qint64 bytes = 0;
+    for (const QString &fileName : files) {
+        CaptureFile capture;
+        if (!capture.load(fileName))
+            continue;
+        for (const CaptureRecord &record : capture.records()) {
+            if (!record.isTx) {
+                chunks.append(record.data);
+                bytes += record.data.size();
+            }
+        }
+    }
+
+    FrameParser parser;
+    qint64 frames = 0, acks = 0;
+    parser.setFrameHandler([&frames, &acks](const char *data, int len) {
+        AckParser::ParsedAck ack;
+        frames++;
+        if (AckParser::parse(data, len, &ack))
+            acks++;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; r++) {
+        for (const QByteArray &chunk : chunks)
+            parser.feed(chunk.constData(), chunk.size());
+        parser.flush();
+    }
+    const double ns = static_cast<double>(timer.nsecsElapsed());
+
+    benchReport(QString("replay parser %1 chunks").arg(chunks.size()), bytes * rounds * 1e3 / ns, "MB/s");
+    benchReport("replay parser", frames ? ns / frames : 0, "ns/frame");
+    if (acks != frames)
+        benchReport("replay parser UNKNOWN FRAMES", frames - acks, "");
+}
+
+// 通过完整的端口 + 测试序列回放, 结果应与抓包时一致
+void runReplay(const QStringList &files, const QString &options, int expected)
+{
+    TestStation station;
+    station.comTest()->setPipelined(true);
+    QEventLoop loop;
+    QObject::connect(&station, &TestStation::finished, &loop, &QEventLoop::quit);
+
+    QVector<qint64> latency;
+    int unexpected = 0;
+    QElapsedTimer timer;
+    for (const QString &fileName : files) {
+        station.setPortName(QString("replay:%1%2").arg(fileName, options));
+        timer.start();
+        if (!station.start()) {
+            unexpected++;
+            continue;
+        }
+        loop.exec();
+        latency.append(timer.nsecsElapsed());
+        if (station.lastResult() != expected)
+            unexpected++;
+    }
+
+    std::sort(latency.begin(), latency.end());
+    const QString name = QString("replay%1").arg(options);
+    benchReport(name + " p50", percentile(latency, 0.50) / 1e6, "ms");
+    benchReport(name + " p99", percentile(latency, 0.99) / 1e6, "ms");
+    if (unexpected > 0)
+        benchReport(name + " UNEXPECTED RESULTS", unexpected, "");
+}
+
+}
+
+void benchReplay()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        benchReport("replay NO TEMP DIR", 0, "");
+        return;
+    }
+
+    // 拆段到达的应答更接近串口上的真实分段
+    const QStringList passed = captureCycles("sim:split=3,gap=1,delay=5", dir.path(), 100);
+    const QStringList failed = captureCycles("sim:nack=485,mask=7f", dir.path(), 20);
+
+    runParser(passed, 200);
+    // 按原始时间回放, 周期应接近抓包时(每项约 5 ms)
+    runReplay(passed.mid(0, 20), QString(), ComTest::GZ_END_SUCCESS);
+    runReplay(passed, "?speed=max", ComTest::GZ_END_SUCCESS);
+    runReplay(failed, "?speed=max", ComTest::GZ_END_FAILED);
+}
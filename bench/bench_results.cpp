@@ -0,0 +1,193 @@
+#include "bench.h"
+#include "ResultStore.h"
+#include "TestStation.h"
+#include "YieldStats.h"
+#include "ComTest.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QTemporaryDir>
+#include <algorithm>
+
+namespace {
+
+#define    RESULTS_SERIALS    2000
+
+RunRecord makeRun(int i, qint64 startedAt)
+{
+    RunRecord run;
+    run.serial = QString("SN%1").arg(i % RESULTS_SERIALS, 6, 10, QChar('0'));
+    run.port = QString("COM%1").arg(3 + i % 8);
+    run.startedAt = startedAt;
+    run.result = (i % 17 == 0) ? ComTest::GZ_END_FAILED : ComTest::GZ_END_SUCCESS;
+    run.pipelined = true;
+    run.cycleMs = 40 + i % 7;
+    run.mask485 = (i % 17 == 0) ? 0x7f : 0;
+    for (int item = 0; item < TEST_ITEMS_NUM; item++) {
+        run.done[item] = true;
+        run.pass[item] = !(item == TEST_IDX_485 && i % 17 == 0);
+        run.attempts[item] = 1;
+        run.rttUs[item] = 800 + (i * 31 + item * 7) % 400;
+    }
+    return run;
+}
+
+/*
+ * 写入: record 在调用线程中的开销和后台线程的持续写入速度(每次测试 1 行 runs + 5 行 items).
+ * 记录按 1 分钟一块板排开, 相当于产线连续生产 runs 分钟.
+ */
+void benchWrite(ResultStore *store, int runs, qint64 base)
+{
+    QVector<qint64> enqueue;
+    enqueue.reserve(runs);
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+    for (int i = 0; i < runs; i++) {
+        const RunRecord run = makeRun(i, base + i * 60000LL);
+        timer.start();
+        store->record(run);
+        enqueue.append(timer.nsecsElapsed());
+        // 队列有上限(RESULT_MAX_PENDING), 每攒够一批等后台写完再继续
+        if ((i + 1) % RESULT_BATCH_RUNS == 0)
+            store->flush();
+    }
+    store->flush();
+    const double seconds = total.nsecsElapsed() / 1e9;
+
+    std::sort(enqueue.begin(), enqueue.end());
+    benchReport("results record p50", percentile(enqueue, 0.50), "ns");
+    benchReport("results record p99", percentile(enqueue, 0.99), "ns");
+    benchReport("results sustained write", runs / seconds, "runs/s");
+    benchReport("results runs per batch", static_cast<double>(store->runsWritten()) / qMax<quint64>(1, store->batchesWritten()), "runs");
+    if (store->droppedRuns() > 0)
+        benchReport("results DROPPED RUNS", store->droppedRuns(), "");
+}
+
+void benchQuery(ResultStore *store, int runs, qint64 base)
+{
+    QVector<qint64> bySerial;
+    QVector<qint64> byTime;
+    int missing = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < 200; i++) {
+        const QString serial = QString("SN%1").arg((i * 37) % RESULTS_SERIALS, 6, 10, QChar('0'));
+        timer.start();
+        const QVector<RunRecord> found = store->query(serial, 0, base + runs * 60000LL);
+        bySerial.append(timer.nsecsElapsed());
+        if (found.size() != runs / RESULTS_SERIALS)
+            missing++;
+
+        // 任意一个小时
+        const qint64 from = base + ((i * 7919LL) % qMax(1, runs - 60)) * 60000LL;
+        timer.start();
+        const QVector<RunRecord> hour = store->query(QString(), from, from + 3600 * 1000LL);
+        byTime.append(timer.nsecsElapsed());
+        if (hour.size() != 60)
+            missing++;
+    }
+
+    // 控制接口的 results.query: 在后台线程中查询, 结果经事件循环交回
+    QVector<qint64> async;
+    QEventLoop loop;
+    for (int i = 0; i < 200; i++) {
+        const QString serial = QString("SN%1").arg((i * 37) % RESULTS_SERIALS, 6, 10, QChar('0'));
+        int found = -1;
+        timer.start();
+        store->queryAsync(serial, 0, base + runs * 60000LL, 1000, &loop, [&](const QVector<RunRecord> &result) {
+            found = result.size();
+            loop.quit();
+        });
+        loop.exec();
+        async.append(timer.nsecsElapsed());
+        if (found != runs / RESULTS_SERIALS)
+            missing++;
+    }
+    std::sort(bySerial.begin(), bySerial.end());
+    std::sort(byTime.begin(), byTime.end());
+    std::sort(async.begin(), async.end());
+    benchReport("results query by serial p50", percentile(bySerial, 0.50) / 1e3, "us");
+    benchReport("results query by serial p99", percentile(bySerial, 0.99) / 1e3, "us");
+    benchReport("results query 1h range p50", percentile(byTime, 0.50) / 1e3, "us");
+    benchReport("results query 1h range p99", percentile(byTime, 0.99) / 1e3, "us");
+    benchReport("results async query by serial p50", percentile(async, 0.50) / 1e3, "us");
+    benchReport("results async query by serial p99", percentile(async, 0.99) / 1e3, "us");
+    if (missing > 0)
+        benchReport("results UNEXPECTED QUERY RESULTS", missing, "");
+}
+
+// 良率看板第一次打开时的导入: 最近 24 小时在库中按分钟汇总, 对比逐条读出
+void benchYieldSeed(ResultStore *store, int runs, qint64 base)
+{
+    const qint64 to = base + runs * 60000LL;
+    const qint64 from = to - 24 * 3600 * 1000LL;
+    QEventLoop loop;
+    YieldStats stats;
+    QElapsedTimer timer;
+    timer.start();
+    store->yieldByMinuteAsync(from, to, &loop, [&](const QVector<QPair<qint64, YieldCounters>> &minutes) {
+        for (const QPair<qint64, YieldCounters> &minute : minutes)
+            stats.record(minute.first, minute.second);
+        loop.quit();
+    });
+    loop.exec();
+    benchReport("results yield seed 24h by minute", timer.nsecsElapsed() / 1e6, "ms");
+
+    timer.start();
+    const QVector<RunRecord> all = store->query(QString(), from, to, 1000000);
+    YieldStats rescan;
+    for (int i = all.size() - 1; i >= 0; i--)
+        rescan.record(all.at(i));
+    benchReport("results yield seed 24h row by row", timer.nsecsElapsed() / 1e6, "ms");
+    if (stats.total().runs != rescan.total().runs || stats.total().passed != rescan.total().passed)
+        benchReport("results YIELD SEED MISMATCH", stats.total().runs, "runs");
+}
+
+// 同一模拟工位连续测试, 对比开启结果库前后的周期
+void benchCycleImpact(ResultStore *store, int cycles)
+{
+    for (int pass = 0; pass < 2; pass++) {
+        TestStation station("sim");
+        station.comTest()->setPipelined(true);
+        station.setPersistentSession(true);
+        station.setResultStore(pass == 1 ? store : nullptr);
+        QEventLoop loop;
+        QObject::connect(&station, &TestStation::finished, &loop, &QEventLoop::quit);
+
+        QVector<qint64> latency;
+        latency.reserve(cycles);
+        QElapsedTimer timer;
+        for (int i = 0; i < cycles; i++) {
+            station.setBoardSerial(QString("CYCLE%1").arg(i));
+            timer.start();
+            if (!station.start())
+                continue;
+            loop.exec();
+            latency.append(timer.nsecsElapsed());
+        }
+        std::sort(latency.begin(), latency.end());
+        const QString name = QString("results cycle %1").arg(pass == 1 ? "with store" : "without store");
+        benchReport(name + " p50", percentile(latency, 0.50) / 1e6, "ms");
+        benchReport(name + " p99", percentile(latency, 0.99) / 1e6, "ms");
+    }
+    store->flush();
+}
+
+}
+
+void benchResults()
+{
+    QTemporaryDir dir;
+    ResultStore store;
+    if (!dir.isValid() || !store.open(dir.filePath("results.db"))) {
+        benchReport("results OPEN FAILED", 0, "");
+        return;
+    }
+
+    const int runs = 100000;
+    const qint64 base = 1700000000000LL;
+    benchWrite(&store, runs, base);
+    benchQuery(&store, runs, base);
+    benchYieldSeed(&store, runs, base);
+    benchCycleImpact(&store, 1000);
+}
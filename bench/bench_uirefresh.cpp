@@ -0,0 +1,79 @@
+#include "bench.h"
+#include "TestStation.h"
+#include "UiRefresher.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QTimer>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/*
+ * 多个模拟工位连续测试, 对比测试发出的进度事件数和 UiRefresher 实际触发的重绘数.
+ * 直接连接时每个事件都是一次重绘; 经过刷新层后重绘次数只与工位数和帧率有关.
+ */
+void runStations(int stationCnt, int durationMs)
+{
+    UiRefresher refresher;
+    std::vector<std::unique_ptr<TestStation>> stations;
+    quint64 events = 0;
+    quint64 cycles = 0;
+    bool stopping = false;
+
+    for (int i = 0; i < stationCnt; i++) {
+        std::unique_ptr<TestStation> station(new TestStation("sim:delay=1,jitter=2"));
+        TestStation *s = station.get();
+        s->comTest()->setPipelined(true);
+        s->setPersistentSession(true);
+        QObject::connect(s, &TestStation::progress, [&events]() { events++; });
+        QObject::connect(s, &TestStation::finished, [s, &refresher, &cycles, &stopping]() {
+            cycles++;
+            if (stopping)
+                return;
+            // 排队重启, 不在结束信号的调用栈内开始下一轮
+            QTimer::singleShot(0, s, [s, &refresher]() {
+                if (s->start())
+                    refresher.wake();
+            });
+        });
+        refresher.watch(s, [](const StationSnapshot &) {});
+        stations.push_back(std::move(station));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (auto &station : stations)
+        station->start();
+    refresher.wake();
+
+    QEventLoop loop;
+    QTimer::singleShot(durationMs, &loop, [&]() {
+        stopping = true;
+        loop.quit();
+    });
+    loop.exec();
+
+    // 还在测试的工位直接中止, 之后的事件不计入结果
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    const quint64 eventCnt = events;
+    const quint64 repaintCnt = refresher.repaintCount();
+    const quint64 frameCnt = refresher.frameCount();
+    for (auto &station : stations)
+        station->abort();
+
+    const QString name = QString("ui refresh %1 stations").arg(stationCnt);
+    benchReport(name + " cycles", cycles / seconds, "cycles/s");
+    benchReport(name + " progress events", eventCnt / seconds, "events/s");
+    benchReport(name + " repaints", repaintCnt / seconds, "repaints/s");
+    benchReport(name + " frames", frameCnt / seconds, "frames/s");
+}
+
+}
+
+void benchUiRefresh()
+{
+    runStations(1, 2000);
+    runStations(12, 2000);
+}
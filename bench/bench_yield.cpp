@@ -0,0 +1,107 @@
+#include "bench.h"
+#include "YieldStats.h"
+#include "ResultStore.h"
+#include "ComTest.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QVector>
+
+namespace {
+
+RunRecord makeRun(int i, qint64 startedAt)
+{
+    RunRecord run;
+    run.port = QString("COM%1").arg(3 + i % 8);
+    run.startedAt = startedAt;
+    run.result = (i % 13 == 0) ? ComTest::GZ_END_FAILED : ComTest::GZ_END_SUCCESS;
+    run.cycleMs = 40 + i % 7;
+    run.mask485 = (i % 13 == 0) ? 0xfb : 0;  // 通道3 失败
+    // 偶尔 can 之后超时: can 和 pmbus 没有测完, 不算失败
+    const bool timeout = (i % 97 == 0) && run.result == ComTest::GZ_END_SUCCESS;
+    if (timeout)
+        run.result = ComTest::GZ_END_COM_TIMEOUT;
+    for (int item = 0; item < TEST_ITEMS_NUM; item++) {
+        run.done[item] = !(timeout && item >= TEST_IDX_CAN);
+        run.pass[item] = run.done[item] && !(item == TEST_IDX_485 && i % 13 == 0);
+        run.attempts[item] = (item == TEST_IDX_CAN && i % 29 == 0) ? 2 : 1;
+    }
+    return run;
+}
+
+/*
+ * 增量统计与每次刷新都重新扫描历史的对比. 记录按每 3 秒一块板排开(12 工位满负荷),
+ * 刷新内容与良率看板相同: 当前/上一班次、最近 60 分钟、最近 24 小时.
+ */
+void runYield(int runs)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 spacing = 3000;
+    QVector<RunRecord> history;
+    history.reserve(runs);
+    for (int i = 0; i < runs; i++)
+        history.append(makeRun(i, now - (runs - i) * spacing));
+
+    YieldStats stats;
+    QElapsedTimer timer;
+    timer.start();
+    for (const RunRecord &run : history)
+        stats.record(run);
+    const double recordNs = static_cast<double>(timer.nsecsElapsed()) / runs;
+
+    const int refreshes = 1000;
+    quint64 sink = 0;
+    timer.start();
+    for (int i = 0; i < refreshes; i++) {
+        sink += stats.currentShift(now).runs + stats.previousShift(now).runs + stats.lastHour(now).runs;
+        for (const auto &hour : stats.hours(now))
+            sink += hour.second.runs;
+    }
+    const double refreshUs = timer.nsecsElapsed() / 1e3 / refreshes;
+
+    // 对照: 每次刷新扫描全部历史, 按时间窗口重新累加
+    qint64 shiftStart = 0;
+    stats.currentShift(now, &shiftStart);
+    const int rescans = 20;
+    quint64 rescanRuns = 0;
+    YieldCounters rescanShift;
+    timer.start();
+    for (int i = 0; i < rescans; i++) {
+        YieldCounters shift, lastHour;
+        YieldCounters hours[YIELD_HOURS];
+        for (const RunRecord &run : history) {
+            if (run.startedAt >= shiftStart)
+                shift.add(run);
+            if (run.startedAt > now - 3600 * 1000LL)
+                lastHour.add(run);
+            const qint64 age = (now / 3600000) - run.startedAt / 3600000;
+            if (age >= 0 && age < YIELD_HOURS)
+                hours[age].add(run);
+        }
+        rescanRuns += shift.runs;
+        rescanShift = shift;
+    }
+    const double rescanUs = timer.nsecsElapsed() / 1e3 / rescans;
+
+    const YieldCounters shift = stats.currentShift(now);
+    if (rescanRuns != static_cast<quint64>(rescans) * shift.runs)
+        benchReport("yield SHIFT MISMATCH", rescanRuns / rescans, "runs");
+    for (int item = 0; item < TEST_ITEMS_NUM; item++) {
+        if (shift.itemFailed[item] != rescanShift.itemFailed[item] || shift.itemMissing[item] != rescanShift.itemMissing[item])
+            benchReport(QString("yield ITEM %1 MISMATCH").arg(ComTest::itemName(item)), shift.itemFailed[item], "runs");
+    }
+    const QString name = QString("yield %1 runs").arg(runs);
+    benchReport(name + " record", recordNs, "ns/run");
+    benchReport(name + " incremental refresh", refreshUs, "us");
+    benchReport(name + " rescan refresh", rescanUs, "us");
+    if (sink == 0)
+        benchReport(name + " EMPTY", 0, "");
+}
+
+}
+
+void benchYield()
+{
+    runYield(10000);
+    runYield(100000);
+}
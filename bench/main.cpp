@@ -0,0 +1,66 @@
+#include "bench.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <cstdio>
+
+namespace {
+
+struct Benchmark {
+    const char *name;
+    void (*run)();
+};
+
+const Benchmark kBenchmarks[] = {
+    { "frameparser", benchFrameParser },
+    { "ackparse",    benchAckParse },
+    { "cycle",       benchCycle },
+    { "logmodel",    benchLogModel },
+    { "logging",     benchLogging },
+    { "hex",         benchHex },
+    { "replay",      benchReplay },
+    { "codec",       benchCodec },
+    { "uirefresh",   benchUiRefresh },
+    { "control",     benchControl },
+    { "results",     benchResults },
+    { "yield",       benchYield },
+};
+
+}
+
+void benchReport(const QString &name, double value, const char *unit)
+{
+    printf("%-40s %14.2f %s\n", name.toLatin1().constData(), value, unit);
+    fflush(stdout);
+}
+
+double percentile(const QVector<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty())
+        return 0.0;
+    int index = static_cast<int>(p * (sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted.at(index));
+}
+
+// 被测代码的调试输出会严重拖慢计时, 只保留警告及以上
+void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    if (type != QtDebugMsg && type != QtInfoMsg)
+        fprintf(stderr, "%s\n", qPrintable(msg));
+}
+
+// 用法: gz_bench [名称...], 不带参数时运行全部
+int main(int argc, char *argv[])
+{
+    qInstallMessageHandler(quietMessageHandler);
+    QCoreApplication a(argc, argv);
+    QStringList selected = a.arguments().mid(1);
+
+    for (const Benchmark &bench : kBenchmarks) {
+        if (!selected.isEmpty() && !selected.contains(bench.name))
+            continue;
+        printf("== %s\n", bench.name);
+        bench.run();
+    }
+    return 0;
+}
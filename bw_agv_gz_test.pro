@@ -1,41 +1,12 @@
-QT       += core gui
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-                                  QT += serialport
-                                  QT += network
-
-CONFIG += c++11
-
-# The following define makes your compiler emit warnings if you use
-# any Qt feature that has been marked deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
-
-# You can also make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    AbstractReadWriter.cpp \
-    SerialReadWriter.cpp \
-    global.cpp \
-    main.cpp \
-    widget.cpp
-
-HEADERS += \
-    AbstractReadWriter.h \
-    SerialReadWriter.h \
-    global.h \
-    widget.h
-
-FORMS += \
-    widget.ui
-
-RC_ICONS = res/logo.ico
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
+TEMPLATE = subdirs
+
+# core: 不依赖界面的核心库(静态库), app: 界面程序, bench: 基准测试 gz_bench, tests: 单元测试 gz_tests
+SUBDIRS += \
+    core \
+    app \
+    bench \
+    tests
+
+app.depends = core
+bench.depends = core
+tests.depends = core
@@ -0,0 +1,15 @@
+# 使用核心库的工程 include 此文件, 核心库改动后自动重新链接
+QT += core network serialport sql
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+CORE_OUT = $$OUT_PWD/../core
+win32 {
+    CONFIG(release, debug|release): CORE_OUT = $$CORE_OUT/release
+    else: CORE_OUT = $$CORE_OUT/debug
+}
+
+LIBS += -L$$CORE_OUT -lgz_core
+win32-msvc*: PRE_TARGETDEPS += $$CORE_OUT/gz_core.lib
+else: PRE_TARGETDEPS += $$CORE_OUT/libgz_core.a
@@ -0,0 +1,67 @@
+# 不依赖界面的核心库: 端口/传输、分帧与应答解析、测试序列、编解码(global)、统计、日志与结果库
+TEMPLATE = lib
+CONFIG += staticlib
+TARGET = gz_core
+
+QT       -= gui
+QT       += core network serialport sql
+
+include(../gz_common.pri)
+
+SRC_DIR = $$PWD/..
+INCLUDEPATH += $$SRC_DIR
+
+SOURCES += \
+    $$SRC_DIR/AbstractReadWriter.cpp \
+    $$SRC_DIR/AsyncReadWriter.cpp \
+    $$SRC_DIR/BinaryProtocol.cpp \
+    $$SRC_DIR/ComTest.cpp \
+    $$SRC_DIR/ControlServer.cpp \
+    $$SRC_DIR/FrameParser.cpp \
+    $$SRC_DIR/HexCodec.cpp \
+    $$SRC_DIR/LatencyStats.cpp \
+    $$SRC_DIR/Logging.cpp \
+    $$SRC_DIR/LogModel.cpp \
+    $$SRC_DIR/PortMonitor.cpp \
+    $$SRC_DIR/ReplayReadWriter.cpp \
+    $$SRC_DIR/ResultStore.cpp \
+    $$SRC_DIR/SerialReadWriter.cpp \
+    $$SRC_DIR/SimDut.cpp \
+    $$SRC_DIR/SimDutServer.cpp \
+    $$SRC_DIR/SimReadWriter.cpp \
+    $$SRC_DIR/TcpReadWriter.cpp \
+    $$SRC_DIR/TestStation.cpp \
+    $$SRC_DIR/TrafficCapture.cpp \
+    $$SRC_DIR/UiRefresher.cpp \
+    $$SRC_DIR/UdpReadWriter.cpp \
+    $$SRC_DIR/YieldStats.cpp \
+    $$SRC_DIR/global.cpp
+
+HEADERS += \
+    $$SRC_DIR/AbstractReadWriter.h \
+    $$SRC_DIR/AckParser.h \
+    $$SRC_DIR/AsyncReadWriter.h \
+    $$SRC_DIR/BinaryProtocol.h \
+    $$SRC_DIR/ByteRingBuffer.h \
+    $$SRC_DIR/ComTest.h \
+    $$SRC_DIR/ControlServer.h \
+    $$SRC_DIR/FrameParser.h \
+    $$SRC_DIR/HexCodec.h \
+    $$SRC_DIR/LatencyStats.h \
+    $$SRC_DIR/Logging.h \
+    $$SRC_DIR/LogModel.h \
+    $$SRC_DIR/NetSettings.h \
+    $$SRC_DIR/PortMonitor.h \
+    $$SRC_DIR/ReplayReadWriter.h \
+    $$SRC_DIR/ResultStore.h \
+    $$SRC_DIR/SerialReadWriter.h \
+    $$SRC_DIR/SimDut.h \
+    $$SRC_DIR/SimDutServer.h \
+    $$SRC_DIR/SimReadWriter.h \
+    $$SRC_DIR/TcpReadWriter.h \
+    $$SRC_DIR/TestStation.h \
+    $$SRC_DIR/TrafficCapture.h \
+    $$SRC_DIR/UiRefresher.h \
+    $$SRC_DIR/UdpReadWriter.h \
+    $$SRC_DIR/YieldStats.h \
+    $$SRC_DIR/global.h
@@ -5,20 +5,28 @@
 #include <QtCore/QString>
 #include <QtCore/QTextCodec>
 #include <QtCore/QTime>
-#include <QtWidgets/QWidget>
-#include <QtWidgets/QMessageBox>
 #include <QtNetwork/QHostInfo>
 #include "global.h"
+#include "Logging.h"
+#include "HexCodec.h"
 
-QTextCodec *gbk = QTextCodec::codecForName("GB18030");
-QTextCodec *utf8 = QTextCodec::codecForName("UTF-8");
+// 编码表在第一次转换时才查找, 不占用程序启动时间
+static QTextCodec *gbkCodec() {
+    static QTextCodec *codec = QTextCodec::codecForName("GB18030");
+    return codec;
+}
+
+static QTextCodec *utf8Codec() {
+    static QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+    return codec;
+}
 
 QString utf82Gbk(const QString &inStr) {
 //    QTextCodec *utf8 = QTextCodec::codecForName("UTF-8");
 
 //    gbk->fromUnicode(utf8->toUnicode(inStr.toLatin1()));
 
-    return QString(gbk->fromUnicode(inStr));
+    return QString(gbkCodec()->fromUnicode(inStr));
 
 //    QString utf2gbk = gbk->toUnicode(inStr.toLocal8Bit());
 //    return utf2gbk;
@@ -34,46 +42,25 @@ QString utf82Gbk(const QString &inStr) {
 //}
 
 QString fromUtf8(const QByteArray &data) {
-    qDebug() << "fromUtf8" << data.toHex();
-    return utf8->toUnicode(data);
+    qCDebug(lcUi) << "fromUtf8" << data.toHex();
+    return utf8Codec()->toUnicode(data);
 }
 
 QString fromGbk(const QByteArray &data) {
-    qDebug() << "fromGbk" << data.toHex();
-    return gbk->toUnicode(data);
+    qCDebug(lcUi) << "fromGbk" << data.toHex();
+    return gbkCodec()->toUnicode(data);
 }
 
 QByteArray toGbkByteArray(const QString &text) {
-    qDebug() << "toGbkByteArray" << text;
+    qCDebug(lcUi) << "toGbkByteArray" << text;
     return text.toLocal8Bit();
 }
 
 QByteArray toUtf8ByteArray(const QString &text) {
-    qDebug() << "toUtf8ByteArray" << text;
+    qCDebug(lcUi) << "toUtf8ByteArray" << text;
     return text.toUtf8();
 }
 
-bool okToContinue(const QString &title, const QString &text, QWidget *parent) {
-    return QMessageBox::Yes == QMessageBox::warning(parent, title, text, QMessageBox::Yes | QMessageBox::No);
-}
-
-bool showQuestion(const QString &title, const QString &text, QWidget *parent) {
-    return QMessageBox::question(parent, title, text, QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes;
-}
-
-void showError(const QString &title, const QString &text, QWidget *parent) {
-    return (void) QMessageBox::critical(parent, title, text, QMessageBox::Ok);
-}
-
-bool showWarning(const QString &title, const QString &text, QWidget *parent) {
-    return QMessageBox::warning(parent, title, text, QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes;
-//    return QMessageBox::warning(parent, title, text, QMessageBox::Yes | QMessageBox::Cancel) == QMessageBox::Yes;
-}
-
-void showMessage(const QString &title, const QString &text, QWidget *parent) {
-    return (void) QMessageBox::information(parent, title, text);
-};
-
 QString getTimestamp() {
     auto time = QTime(QTime::currentTime());
     return time.toString("hh:mm:ss.zzz");
@@ -91,9 +78,17 @@ QString getFileDir(const QString &filePath) {
 
 QString getIp() {
     auto localHostName = QHostInfo::localHostName();
-    qDebug() << "local host name:" << localHostName;
-    auto ipAddress = QHostInfo::fromName(localHostName).addresses();
-    qDebug() << "ip address:" << ipAddress;
+    qCDebug(lcUi) << "local host name:" << localHostName;
+    return ipFromHostInfo(QHostInfo::fromName(localHostName));
+}
+
+int lookupIp(QObject *receiver, const char *member) {
+    return QHostInfo::lookupHost(QHostInfo::localHostName(), receiver, member);
+}
+
+QString ipFromHostInfo(const QHostInfo &info) {
+    auto ipAddress = info.addresses();
+    qCDebug(lcUi) << "ip address:" << ipAddress;
 
     for (auto address:ipAddress) {
         if (address.protocol() == QAbstractSocket::IPv4Protocol) {
@@ -114,17 +109,19 @@ QString getAddressString(const QHostAddress &address) {
 }
 
 QByteArray dataToHex(const QByteArray &data) {
-    QByteArray result = data.toHex().toUpper();
-
-    for (int i = 2; i < result.size(); i += 3)
-        result.insert(i, ' ');
+    QByteArray result;
+    result.resize(int(HexCodec::encodedSize(size_t(data.size()))));
+    HexCodec::encode(reinterpret_cast<const unsigned char *>(data.constData()), size_t(data.size()), result.data());
 
     return result;
 }
 
 QByteArray dataFromHex(const QString &hex) {
-    QByteArray line = hex.toLatin1();
-    line.replace(' ', QByteArray());
-    auto result = QByteArray::fromHex(line);
+    const QByteArray line = hex.toLatin1();
+    QByteArray result;
+    result.resize(line.size() / 2);
+    const size_t n = HexCodec::decode(line.constData(), size_t(line.size()),
+                                      reinterpret_cast<unsigned char *>(result.data()));
+    result.resize(int(n));
     return result;
 }
@@ -5,8 +5,11 @@
 #ifndef SERIALWIZARD_GLOBAL_H
 #define SERIALWIZARD_GLOBAL_H
 
+#include <QByteArray>
 #include <QString>
-#include <QWidget>
+
+class QHostInfo;
+class QObject;
 
 extern QString utf82Gbk(const QString &inStr);
 
@@ -20,23 +23,18 @@ extern QByteArray toUtf8ByteArray(const QString &text);
 
 extern QString getTimestamp();
 
-
-extern bool okToContinue(const QString &title, const QString &text, QWidget *parent = nullptr);
-
-extern bool showQuestion(const QString &title, const QString &text, QWidget *parent = nullptr);
-
-extern void showError(const QString &title, const QString &text, QWidget *parent = nullptr);
-
-extern bool showWarning(const QString &title, const QString &text, QWidget *parent = nullptr);
-
-extern void showMessage(const QString &title, const QString &text, QWidget *parent = nullptr);
-
 extern QString getFileSuffix(const QString &filePath);
 
 extern QString getFileDir(const QString &filePath);
 
+// 阻塞的 DNS 查询, 不要在界面线程中调用
 extern QString getIp();
 
+// 异步查询本机地址, 完成后调用 receiver 的槽 member(QHostInfo), 用 ipFromHostInfo 取出地址
+extern int lookupIp(QObject *receiver, const char *member);
+
+extern QString ipFromHostInfo(const QHostInfo &info);
+
 extern QByteArray dataToHex(const QByteArray &data);
 
 extern QByteArray dataFromHex(const QString &data);
@@ -1,11 +1,43 @@
 #include "widget.h"
+#include "HeadlessRunner.h"
+#include "Logging.h"
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    StartupTrace::begin();
+
+    if (HeadlessRunner::isRequested(argc, argv)) {
+        // 无界面批处理模式, 不创建 QApplication 和任何窗口
+        QCoreApplication a(argc, argv);
+        StartupTrace::mark("QCoreApplication");
+        HeadlessRunner runner(startupTimer);
+        if (!runner.parseArguments(a.arguments()))
+            return HEADLESS_EXIT_USAGE;
+        if (runner.isHelpRequested())
+            return 0;
+        StartupTrace::mark("parse arguments");
+        QTimer::singleShot(0, &runner, SLOT(start()));
+        return a.exec();
+    }
+
     QApplication a(argc, argv);
+    StartupTrace::mark("QApplication");
     Widget w;
+    StartupTrace::mark("Widget");
     w.show();
+    StartupTrace::mark("show");
+    // 事件循环处理完第一批事件(含首次绘制)后界面才真正可用
+    QTimer::singleShot(0, &w, [&w]() {
+        const QString report = StartupTrace::finish("first paint");
+        if (!report.isEmpty())
+            w.logStartupReport(report);
+    });
     return a.exec();
 }
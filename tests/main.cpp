@@ -0,0 +1,32 @@
+#include "tests.h"
+
+#include <QtCore/QCoreApplication>
+
+namespace {
+
+struct TestCase {
+    const char *name;
+    int (*run)(int argc, char *argv[]);
+};
+
+const TestCase kTests[] = {
+    { "frameparser",    testFrameParser },
+    { "ackparse",       testAckParse },
+    { "binaryprotocol", testBinaryProtocol },
+    { "comtest",        testComTest },
+    { "logmodel",       testLogModel },
+    { "results",        testResults },
+    { "yield",          testYield },
+};
+
+}
+
+// 用法: gz_tests [QTest 选项], 依次运行全部测试类, 有失败时返回非 0
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int failed = 0;
+    for (const TestCase &test : kTests)
+        failed += test.run(argc, argv);
+    return failed != 0 ? 1 : 0;
+}
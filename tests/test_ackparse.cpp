@@ -0,0 +1,132 @@
+#include "tests.h"
+#include "AckParser.h"
+#include "BinaryProtocol.h"
+
+#include <QtTest/QtTest>
+
+class TestAckParse : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void ackAndNack_data();
+    void ackAndNack();
+    void mask485_data();
+    void mask485();
+    void binaryMask485();
+    void rejected_data();
+    void rejected();
+};
+
+namespace {
+
+bool parse(const QByteArray &frame, AckParser::ParsedAck *ack)
+{
+    return AckParser::parse(frame.constData(), frame.size(), ack);
+}
+
+}
+
+void TestAckParse::ackAndNack_data()
+{
+    QTest::addColumn<QByteArray>("frame");
+    QTest::addColumn<int>("ack");
+    QTest::addColumn<int>("id");
+    QTest::addColumn<bool>("pass");
+
+    QTest::newRow("ack uart_debug") << QByteArray("gz_test com ack uart_debug")
+                                    << int(ComTest::GZ_ACK_DEBUG_COM_SUCCESS) << TEST_IDX_DEBUG_COM << true;
+    QTest::newRow("nack ethernet") << QByteArray("gz_test com nack ethernet")
+                                   << int(ComTest::GZ_ACK_ETHERNET_FAILED) << TEST_IDX_ETHERNET << false;
+    QTest::newRow("ack 485") << QByteArray("gz_test com ack 485")
+                             << int(ComTest::GZ_ACK_485_SUCCESS) << TEST_IDX_485 << true;
+    QTest::newRow("nack can") << QByteArray("gz_test com nack can")
+                              << int(ComTest::GZ_ACK_CAN_FAILED) << TEST_IDX_CAN << false;
+    QTest::newRow("ack pmbus, extra spaces") << QByteArray("gz_test  com ack   pmbus")
+                                             << int(ComTest::GZ_ACK_PMBUS_SUCCESS) << TEST_IDX_PMBUS << true;
+}
+
+void TestAckParse::ackAndNack()
+{
+    QFETCH(QByteArray, frame);
+    QFETCH(int, ack);
+    QFETCH(int, id);
+    QFETCH(bool, pass);
+
+    AckParser::ParsedAck parsed;
+    QVERIFY(parse(frame, &parsed));
+    QCOMPARE(int(parsed.ack), ack);
+    QCOMPARE(parsed.id, id);
+    QCOMPARE(parsed.isPass, pass);
+    QCOMPARE(parsed.result, 0u);
+}
+
+// nack 485 带通道掩码, 位为 1 表示该通道正常
+void TestAckParse::mask485_data()
+{
+    QTest::addColumn<QByteArray>("frame");
+    QTest::addColumn<uint>("mask");
+
+    QTest::newRow("7f") << QByteArray("gz_test com nack 485 7f") << 0x7fu;
+    QTest::newRow("0x prefix") << QByteArray("gz_test com nack 485 0x80") << 0x80u;
+    QTest::newRow("upper case") << QByteArray("gz_test com nack 485 FE") << 0xfeu;
+    QTest::newRow("missing") << QByteArray("gz_test com nack 485") << 0u;
+    QTest::newRow("invalid") << QByteArray("gz_test com nack 485 zz") << 0u;
+}
+
+void TestAckParse::mask485()
+{
+    QFETCH(QByteArray, frame);
+    QFETCH(uint, mask);
+
+    AckParser::ParsedAck parsed;
+    QVERIFY(parse(frame, &parsed));
+    QCOMPARE(parsed.id, TEST_IDX_485);
+    QVERIFY(!parsed.isPass);
+    QCOMPARE(parsed.result, mask);
+}
+
+void TestAckParse::binaryMask485()
+{
+    const char payload[] = { 0x7f, 0x01 };
+    const QByteArray frame = BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, TEST_IDX_485,
+                                                    BinaryProtocol::STATUS_NACK, payload, 2);
+    AckParser::ParsedAck parsed;
+    QVERIFY(parse(frame, &parsed));
+    QCOMPARE(parsed.ack, ComTest::GZ_ACK_485_FAILED);
+    QVERIFY(!parsed.isPass);
+    QCOMPARE(parsed.result, 0x17fu);
+
+    const QByteArray ack = BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, TEST_IDX_CAN, BinaryProtocol::STATUS_ACK);
+    QVERIFY(parse(ack, &parsed));
+    QCOMPARE(parsed.ack, ComTest::GZ_ACK_CAN_SUCCESS);
+    QCOMPARE(parsed.id, TEST_IDX_CAN);
+    QVERIFY(parsed.isPass);
+}
+
+void TestAckParse::rejected_data()
+{
+    QTest::addColumn<QByteArray>("frame");
+
+    QTest::newRow("unknown item") << QByteArray("gz_test com ack usb");
+    QTest::newRow("unknown verb") << QByteArray("gz_test com ok can");
+    QTest::newRow("too short") << QByteArray("gz_test com ack");
+    QTest::newRow("item prefix") << QByteArray("gz_test com ack ca");
+    QTest::newRow("command echo") << QByteArray("gz_test com can");
+    QTest::newRow("binary command") << BinaryProtocol::command(TEST_IDX_CAN);
+}
+
+void TestAckParse::rejected()
+{
+    QFETCH(QByteArray, frame);
+    AckParser::ParsedAck parsed;
+    QVERIFY(!parse(frame, &parsed));
+}
+
+int testAckParse(int argc, char *argv[])
+{
+    TestAckParse test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_ackparse.moc"
@@ -0,0 +1,127 @@
+#include "tests.h"
+#include "BinaryProtocol.h"
+#include "FrameParser.h"
+#include "ComTest.h"
+
+#include <QtCore/QByteArrayList>
+#include <QtTest/QtTest>
+#include <cstring>
+
+class TestBinaryProtocol : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void crc16();
+    void encodeAndLength();
+    void truncatedFrame();
+    void corruptedFrame();
+    void resyncAfterNoise();
+    void truncatedFrameOnFlush();
+    void commandItems();
+};
+
+// CRC-16/CCITT-FALSE 的标准校验值
+void TestBinaryProtocol::crc16()
+{
+    QCOMPARE(BinaryProtocol::crc16("123456789", 9), quint16(0x29B1));
+    QCOMPARE(BinaryProtocol::crc16("", 0), quint16(0xFFFF));
+}
+
+void TestBinaryProtocol::encodeAndLength()
+{
+    const QByteArray command = BinaryProtocol::command(TEST_IDX_485);
+    QCOMPARE(command.size(), 8);
+    QCOMPARE(BinaryProtocol::frameLength(command.constData(), command.size()), 8);
+    QCOMPARE(BinaryProtocol::frameType(command.constData()), int(BinaryProtocol::TYPE_COMMAND));
+    QCOMPARE(BinaryProtocol::frameItem(command.constData()), TEST_IDX_485);
+
+    const char payload[] = { 0x12, 0x34, 0x56 };
+    const QByteArray ack = BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, TEST_IDX_485,
+                                                  BinaryProtocol::STATUS_NACK, payload, 3);
+    QCOMPARE(ack.size(), 11);
+    QCOMPARE(BinaryProtocol::frameLength(ack.constData(), ack.size()), 11);
+    QCOMPARE(BinaryProtocol::framePayloadLen(ack.constData()), 3);
+    QCOMPARE(QByteArray(BinaryProtocol::framePayload(ack.constData()), 3), QByteArray(payload, 3));
+    // 后面跟着其他数据时只取一帧
+    const QByteArray more = ack + "gz_test";
+    QCOMPARE(BinaryProtocol::frameLength(more.constData(), more.size()), 11);
+}
+
+void TestBinaryProtocol::truncatedFrame()
+{
+    const QByteArray command = BinaryProtocol::command(TEST_IDX_CAN);
+    for (int len = 1; len < command.size(); len++)
+        QCOMPARE(BinaryProtocol::frameLength(command.constData(), len), 0);
+}
+
+void TestBinaryProtocol::corruptedFrame()
+{
+    QByteArray command = BinaryProtocol::command(TEST_IDX_CAN);
+    command[4] = char(TEST_IDX_PMBUS);
+    QCOMPARE(BinaryProtocol::frameLength(command.constData(), command.size()), -1);
+
+    // 长度超出范围
+    QByteArray oversized = BinaryProtocol::command(TEST_IDX_CAN);
+    oversized[2] = char(BinaryProtocol::BODY_MAX + 1);
+    QCOMPARE(BinaryProtocol::frameLength(oversized.constData(), oversized.size()), -1);
+    QCOMPARE(BinaryProtocol::frameLength("gz_test", 7), -1);
+}
+
+// 噪声和校验失败的帧之后, 从下一个帧头重新同步
+void TestBinaryProtocol::resyncAfterNoise()
+{
+    QByteArray corrupted = BinaryProtocol::command(TEST_IDX_485);
+    corrupted[6] = char(corrupted[6] ^ 0x01);
+    const QByteArray valid = BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, TEST_IDX_CAN, BinaryProtocol::STATUS_ACK);
+    const QByteArray stream = QByteArray("\xA5\x00\xA5\x5A", 4) + corrupted + valid;
+
+    QByteArrayList frames;
+    FrameParser parser;
+    parser.setFrameHandler([&frames](const char *data, int len) {
+        frames.append(QByteArray(data, len));
+    });
+    parser.feed(stream.constData(), stream.size());
+    // 噪声按文本帧交出, 二进制帧只有有效的一帧
+    QCOMPARE(frames.count(valid), 1);
+    QCOMPARE(frames.last(), valid);
+    QVERIFY(!frames.contains(corrupted));
+}
+
+// 总线空闲时仍不完整的二进制帧丢弃, 不当作文本帧交出
+void TestBinaryProtocol::truncatedFrameOnFlush()
+{
+    const QByteArray command = BinaryProtocol::command(TEST_IDX_CAN);
+    int frames = 0;
+    FrameParser parser;
+    parser.setFrameHandler([&frames](const char *, int) { frames++; });
+    parser.feed(command.constData(), 5);
+    QVERIFY(parser.hasPending());
+    QCOMPARE(parser.flush(), 0);
+    QCOMPARE(frames, 0);
+    QCOMPARE(parser.discardedBytes(), 5ULL);
+
+    parser.feed(command.constData(), command.size());
+    QCOMPARE(frames, 1);
+}
+
+void TestBinaryProtocol::commandItems()
+{
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        const QByteArray &command = BinaryProtocol::command(i);
+        QCOMPARE(BinaryProtocol::itemOfCommand(command.constData(), command.size()), i);
+        QCOMPARE(ComTest::itemOfCommand(command.constData(), command.size()), i);
+    }
+    const QByteArray ack = BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, TEST_IDX_CAN, BinaryProtocol::STATUS_ACK);
+    QCOMPARE(BinaryProtocol::itemOfCommand(ack.constData(), ack.size()), -1);
+    QVERIFY(BinaryProtocol::isHelloAck(BinaryProtocol::kHelloAck, int(strlen(BinaryProtocol::kHelloAck))));
+    QVERIFY(!BinaryProtocol::isHelloAck(BinaryProtocol::kHello, int(strlen(BinaryProtocol::kHello))));
+}
+
+int testBinaryProtocol(int argc, char *argv[])
+{
+    TestBinaryProtocol test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_binaryprotocol.moc"
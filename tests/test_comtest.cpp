@@ -0,0 +1,313 @@
+#include "tests.h"
+#include "ComTest.h"
+#include "FrameParser.h"
+#include "SimReadWriter.h"
+#include "TestStation.h"
+#include "ResultStore.h"
+#include "TrafficCapture.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+#include <algorithm>
+
+namespace {
+
+/*
+ * ComTest 直接接到模拟端口, 与 TestStation 的收发路径相同: 命令写入 SimReadWriter,
+ * 回复分帧后交给 DealWithFrame. arrivals 按到达顺序记录各应答的测试项.
+ */
+class SimLink
+{
+public:
+    SimLink(ComTest *test, const QString &spec)
+        : m_test(test)
+        , m_port(SimDutConfig::fromSpec(spec))
+    {
+        m_parser.setFrameHandler([this](const char *data, int len) {
+            const int item = m_test->DealWithFrame(data, len);
+            if (item >= 0)
+                arrivals.append(item);
+        });
+        QObject::connect(test, &ComTest::sendData, &m_port, [this](const QByteArray &data) {
+            m_port.write(data);
+        });
+        QObject::connect(&m_port, &AbstractReadWriter::readyRead, &m_port, [this]() {
+            const QByteArray data = m_port.readAll();
+            m_parser.feed(data.constData(), data.size());
+        });
+        m_port.open();
+    }
+
+    // 开始测试并等到结束, 返回 eTestEndResult, 超时返回 -1
+    int run(int timeoutMs = 20000)
+    {
+        QSignalSpy finished(m_test, &ComTest::finished);
+        m_test->Test();
+        if (finished.isEmpty() && !finished.wait(timeoutMs))
+            return -1;
+        return finished.first().first().toInt();
+    }
+
+    QVector<int> arrivals;
+
+private:
+    ComTest *m_test;
+    SimReadWriter m_port;
+    FrameParser m_parser;
+};
+
+QVector<int> attempts(std::initializer_list<int> list)
+{
+    return QVector<int>(list);
+}
+
+}
+
+class TestComTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sequentialPass();
+    void retryAfterNack();
+    void retryBackoff();
+    void timeoutRetried();
+    void pipelinedTimeout();
+    void pipelinedOrdering();
+    void pipelinedRetryOrdering();
+    void binaryNegotiation();
+    void strayAckDropped();
+    void stationFinished();
+    void stationCapture();
+};
+
+void TestComTest::sequentialPass()
+{
+    ComTest test;
+    SimLink link(&test, "sim:delay=1");
+    QCOMPARE(link.run(), int(ComTest::GZ_END_SUCCESS));
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        QVERIFY(test.isItemDone(i));
+        QVERIFY(test.itemResult(i).isPass);
+        QCOMPARE(test.itemAttempts(i), attempts({ ComTest::GZ_ATTEMPT_PASS }));
+    }
+    QCOMPARE(link.arrivals, QVector<int>({ 0, 1, 2, 3, 4 }));
+    QCOMPARE(test.protocol(), ComTest::GZ_PROTO_ASCII);
+    QVERIFY(!test.isRunning());
+}
+
+// flaky 第一次 nack, 重发后 ack; 只有这一项重发
+void TestComTest::retryAfterNack()
+{
+    ComTest test;
+    SimLink link(&test, "sim:flaky=485");
+    QCOMPARE(link.run(), int(ComTest::GZ_END_SUCCESS));
+    QCOMPARE(test.itemAttempts(TEST_IDX_485), attempts({ ComTest::GZ_ATTEMPT_NACK, ComTest::GZ_ATTEMPT_PASS }));
+    QCOMPARE(test.itemAttempts(TEST_IDX_CAN), attempts({ ComTest::GZ_ATTEMPT_PASS }));
+    QCOMPARE(link.arrivals, QVector<int>({ 0, 1, 2, 2, 3, 4 }));
+    QVERIFY(test.cycleTime() >= TEST_RETRY_BACKOFF_MS);
+    QVERIFY(test.resultInfo().contains("nack, ack"));
+}
+
+// 每次重试前的等待加倍: 3 次尝试至少等 100 + 200 ms, 用完后按失败结束
+void TestComTest::retryBackoff()
+{
+    ComTest test;
+    test.setMaxAttempts(3);
+    SimLink link(&test, "sim:nack=can");
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(link.run(), int(ComTest::GZ_END_FAILED));
+    QVERIFY(timer.elapsed() >= TEST_RETRY_BACKOFF_MS * 3);
+    QCOMPARE(test.itemAttempts(TEST_IDX_CAN),
+             attempts({ ComTest::GZ_ATTEMPT_NACK, ComTest::GZ_ATTEMPT_NACK, ComTest::GZ_ATTEMPT_NACK }));
+    QVERIFY(test.isItemDone(TEST_IDX_CAN));
+    QVERIFY(!test.itemResult(TEST_IDX_CAN).isPass);
+    // 顺序模式下序列停在重试的项上, 之后的项照常测试
+    QVERIFY(test.isItemDone(TEST_IDX_PMBUS));
+
+    test.setMaxAttempts(1);
+    QCOMPARE(link.run(), int(ComTest::GZ_END_FAILED));
+    QCOMPARE(test.itemAttempts(TEST_IDX_CAN), attempts({ ComTest::GZ_ATTEMPT_NACK }));
+    QVERIFY(test.cycleTime() < TEST_RETRY_BACKOFF_MS);
+}
+
+void TestComTest::timeoutRetried()
+{
+    ComTest test;
+    test.setMaxAttempts(2);
+    test.setItemTimeout(TEST_IDX_PMBUS, 30);
+    SimLink link(&test, "sim:drop=pmbus");
+    QCOMPARE(link.run(), int(ComTest::GZ_END_COM_TIMEOUT));
+    QCOMPARE(test.itemAttempts(TEST_IDX_PMBUS),
+             attempts({ ComTest::GZ_ATTEMPT_TIMEOUT, ComTest::GZ_ATTEMPT_TIMEOUT }));
+    QVERIFY(!test.isItemDone(TEST_IDX_PMBUS));
+    QVERIFY(test.isItemDone(TEST_IDX_CAN));
+    QVERIFY(test.cycleTime() >= 30 + TEST_RETRY_BACKOFF_MS + 30);
+    // 超时不计入该模式的上一次完整用时
+    QCOMPARE(test.lastCycleTime(false), qint64(-1));
+}
+
+// 流水线模式下没有应答的项不妨碍后面的项
+void TestComTest::pipelinedTimeout()
+{
+    ComTest test;
+    test.setPipelined(true);
+    test.setMaxAttempts(1);
+    test.setItemTimeout(TEST_IDX_CAN, 50);
+    SimLink link(&test, "sim:drop=can");
+    QCOMPARE(link.run(), int(ComTest::GZ_END_COM_TIMEOUT));
+    QVERIFY(!test.isItemDone(TEST_IDX_CAN));
+    QVERIFY(test.isItemDone(TEST_IDX_PMBUS));
+    QCOMPARE(test.itemAttempts(TEST_IDX_CAN), attempts({ ComTest::GZ_ATTEMPT_TIMEOUT }));
+    QCOMPARE(link.arrivals, QVector<int>({ 0, 1, 2, 4 }));
+}
+
+// 模拟板与固件一样按收到的顺序处理命令, 抖动不会让应答乱序
+void TestComTest::pipelinedOrdering()
+{
+    ComTest test;
+    test.setPipelined(true);
+    SimLink link(&test, "sim:delay=2,jitter=20,split=3,gap=1");
+    for (int run = 0; run < 5; run++) {
+        link.arrivals.clear();
+        QCOMPARE(link.run(), int(ComTest::GZ_END_SUCCESS));
+        QCOMPARE(link.arrivals, QVector<int>({ 0, 1, 2, 3, 4 }));
+    }
+    QVERIFY(test.lastCycleTime(true) >= 0);
+}
+
+// 重发的项最后到达, 结果仍按测试项顺序排列
+void TestComTest::pipelinedRetryOrdering()
+{
+    ComTest test;
+    test.setPipelined(true);
+    SimLink link(&test, "sim:flaky=ethernet");
+    QCOMPARE(link.run(), int(ComTest::GZ_END_SUCCESS));
+    QCOMPARE(link.arrivals, QVector<int>({ 0, 1, 2, 3, 4, 1 }));
+    QCOMPARE(test.itemAttempts(TEST_IDX_ETHERNET), attempts({ ComTest::GZ_ATTEMPT_NACK, ComTest::GZ_ATTEMPT_PASS }));
+
+    const QString info = test.resultInfo();
+    const int ethernet = info.indexOf(QString("以太网通信"));
+    QVERIFY(ethernet >= 0);
+    QVERIFY(info.indexOf(QString("调试串口")) < ethernet);
+    QVERIFY(ethernet < info.indexOf(QString("485通信")));
+}
+
+void TestComTest::binaryNegotiation()
+{
+    ComTest test;
+    test.setPipelined(true);
+    test.setBinaryProtocol(true);
+    SimLink link(&test, "sim:proto=bin,nack=485,mask=7f");
+    QCOMPARE(link.run(), int(ComTest::GZ_END_FAILED));
+    QCOMPARE(test.protocol(), ComTest::GZ_PROTO_BINARY);
+    QCOMPARE(test.itemResult(TEST_IDX_485).result, 0x7fu);
+
+    // 旧固件不回复协商命令, 超时后按 ASCII 测试
+    ComTest legacy;
+    legacy.setBinaryProtocol(true);
+    SimLink legacyLink(&legacy, "sim");
+    QCOMPARE(legacyLink.run(), int(ComTest::GZ_END_SUCCESS));
+    QCOMPARE(legacy.protocol(), ComTest::GZ_PROTO_ASCII);
+    QVERIFY(legacy.cycleTime() >= PROTO_NEGOTIATE_MS);
+}
+
+// 顺序模式下还没发出的项的应答不改写该项结果, 也不推进序列
+void TestComTest::strayAckDropped()
+{
+    ComTest test;
+    QSignalSpy sent(&test, &ComTest::sendData);
+    test.Test();
+    QCOMPARE(sent.count(), 1);
+    const QByteArray stray("gz_test com ack can");
+    QCOMPARE(test.DealWithFrame(stray.constData(), stray.size()), TEST_IDX_CAN);
+    QVERIFY(!test.itemResult(TEST_IDX_CAN).isPass);
+    QVERIFY(!test.isItemDone(TEST_IDX_CAN));
+    QVERIFY(test.itemAttempts(TEST_IDX_CAN).isEmpty());
+
+    const QByteArray ack("gz_test com ack uart_debug");
+    QCOMPARE(test.DealWithFrame(ack.constData(), ack.size()), TEST_IDX_DEBUG_COM);
+    QVERIFY(test.isItemDone(TEST_IDX_DEBUG_COM));
+    QCOMPARE(sent.count(), 2);
+    // 已判定的项的重复应答同样丢弃
+    const QByteArray nack("gz_test com nack uart_debug");
+    test.DealWithFrame(nack.constData(), nack.size());
+    QVERIFY(test.itemResult(TEST_IDX_DEBUG_COM).isPass);
+    test.Abort();
+}
+
+// 经 TestStation 的完整路径(IO线程、分帧、结束处理)跑完一块板
+void TestComTest::stationFinished()
+{
+    TestStation station("sim:nack=485,mask=7f");
+    QSignalSpy finished(&station, &TestStation::finished);
+    QCOMPARE(station.lastResult(), -1);
+    QVERIFY(station.start());
+    QVERIFY(station.isRunning());
+    QVERIFY(finished.wait(20000));
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().first().toInt(), int(ComTest::GZ_END_FAILED));
+    QCOMPARE(station.lastResult(), int(ComTest::GZ_END_FAILED));
+    QVERIFY(station.resultInfo().contains(QString("485通信")));
+    QVERIFY(!station.isRunning());
+    QCOMPARE(station.snapshot().state, int(StationSnapshot::DONE));
+    QCOMPARE(station.snapshot().result, int(ComTest::GZ_END_FAILED));
+    const RunRecord run = station.runRecord();
+    QVERIFY(!run.pass[TEST_IDX_485]);
+    QCOMPARE(run.mask485, quint32(0x7f));
+
+    // 结束处理完就能开始下一块板, 持久会话复用端口
+    station.setPortName("sim");
+    station.setPersistentSession(true);
+    QVERIFY(station.start());
+    QVERIFY(finished.wait(20000));
+    QCOMPARE(station.lastResult(), int(ComTest::GZ_END_SUCCESS));
+    QVERIFY(!station.isRunning());
+    QVERIFY(station.isSessionOpen());
+}
+
+// 抓包文件由写线程关闭后才报告已保存
+void TestComTest::stationCapture()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TestStation station("sim");
+    station.setCaptureDir(dir.path());
+    QSignalSpy finished(&station, &TestStation::finished);
+    QSignalSpy logs(&station, &TestStation::logInfo);
+    QVERIFY(station.start());
+    QVERIFY(finished.wait(20000));
+
+    const QString fileName = station.captureFile();
+    QVERIFY(!fileName.isEmpty());
+    const QString saved = QString("报文已保存: %1").arg(fileName);
+    QTRY_VERIFY_WITH_TIMEOUT(std::any_of(logs.cbegin(), logs.cend(), [&](const QList<QVariant> &args) {
+        return args.first().toString() == saved;
+    }), 5000);
+    CaptureFile capture;
+    QVERIFY(capture.load(fileName));
+    QCOMPARE(capture.portName(), QString("sim"));
+    QVERIFY(!capture.records().isEmpty());
+
+    // 目录不存在时报告失败, 不报告已保存
+    station.setCaptureDir(dir.filePath("missing"));
+    logs.clear();
+    QVERIFY(station.start());
+    QVERIFY(finished.wait(20000));
+    const QString failed = station.captureFile();
+    QTRY_VERIFY_WITH_TIMEOUT(std::any_of(logs.cbegin(), logs.cend(), [&](const QList<QVariant> &args) {
+        return args.first().toString().startsWith(QString("抓包文件 %1 写入失败").arg(failed));
+    }), 5000);
+    QVERIFY(!QFileInfo::exists(failed));
+}
+
+int testComTest(int argc, char *argv[])
+{
+    TestComTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_comtest.moc"
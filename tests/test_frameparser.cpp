@@ -0,0 +1,114 @@
+#include "tests.h"
+#include "FrameParser.h"
+#include "BinaryProtocol.h"
+#include "ComTest.h"
+
+#include <QtCore/QByteArrayList>
+#include <QtTest/QtTest>
+
+class TestFrameParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void splitFrame();
+    void coalescedFrames();
+    void framesWithoutTerminator();
+    void idleFlush();
+    void binaryFrameAmongText();
+    void oversizedNoiseDiscarded();
+
+private:
+    int feed(const QByteArray &data) { return m_parser.feed(data.constData(), data.size()); }
+
+private:
+    FrameParser m_parser;
+    QByteArrayList m_frames;
+};
+
+void TestFrameParser::init()
+{
+    m_parser.reset();
+    m_frames.clear();
+    m_parser.setFrameHandler([this](const char *data, int len) {
+        m_frames.append(QByteArray(data, len));
+    });
+}
+
+// 一帧分几次到达, 逐字节也只交出一帧
+void TestFrameParser::splitFrame()
+{
+    QCOMPARE(feed("gz_test com a"), 0);
+    QCOMPARE(feed("ck ca"), 0);
+    QVERIFY(m_parser.hasPending());
+    QCOMPARE(feed("n\r\n"), 1);
+    QCOMPARE(m_frames, QByteArrayList() << "gz_test com ack can");
+    QVERIFY(!m_parser.hasPending());
+
+    const QByteArray frame("gz_test com nack 485 7f\r\n");
+    for (char c : frame)
+        m_parser.feed(&c, 1);
+    QCOMPARE(m_frames.size(), 2);
+    QCOMPARE(m_frames.last(), QByteArray("gz_test com nack 485 7f"));
+}
+
+// 一次读到多帧, 空行和首尾空白不算帧
+void TestFrameParser::coalescedFrames()
+{
+    QCOMPARE(feed("gz_test com ack uart_debug\r\n\r\n gz_test com ack ethernet \ngz_test com ack 485\r"), 3);
+    QCOMPARE(m_frames, QByteArrayList() << "gz_test com ack uart_debug"
+                                        << "gz_test com ack ethernet"
+                                        << "gz_test com ack 485");
+    QCOMPARE(m_parser.frameCount(), 3ULL);
+}
+
+// 固件不带结束符时在下一个帧头处分帧, 帧头被拆在两次 feed 之间也能识别
+void TestFrameParser::framesWithoutTerminator()
+{
+    QCOMPARE(feed("gz_test com ack cangz_te"), 0);
+    QCOMPARE(feed("st com ack pmbus"), 1);
+    QCOMPARE(m_frames, QByteArrayList() << "gz_test com ack can");
+    QVERIFY(m_parser.hasPending());
+}
+
+void TestFrameParser::idleFlush()
+{
+    QCOMPARE(feed("gz_test com ack pmbus"), 0);
+    QCOMPARE(m_parser.flush(), 1);
+    QCOMPARE(m_frames, QByteArrayList() << "gz_test com ack pmbus");
+    QVERIFY(!m_parser.hasPending());
+    QCOMPARE(m_parser.flush(), 0);
+}
+
+void TestFrameParser::binaryFrameAmongText()
+{
+    const char mask = 0x7f;
+    const QByteArray binary = BinaryProtocol::encode(BinaryProtocol::TYPE_ACK, TEST_IDX_485,
+                                                     BinaryProtocol::STATUS_NACK, &mask, 1);
+    QCOMPARE(feed("gz_test com ack can" + binary.left(4)), 1);
+    QCOMPARE(feed(binary.mid(4) + "gz_test com ack pmbus\r\n"), 2);
+    QCOMPARE(m_frames, QByteArrayList() << "gz_test com ack can" << binary << "gz_test com ack pmbus");
+}
+
+void TestFrameParser::oversizedNoiseDiscarded()
+{
+    FrameParser parser(16);
+    int frames = 0;
+    parser.setFrameHandler([&frames](const char *, int) { frames++; });
+    const QByteArray noise(40, 'x');
+    parser.feed(noise.constData(), noise.size());
+    QVERIFY(parser.discardedBytes() > 0);
+    QVERIFY(!parser.hasPending());
+    const QByteArray frame("gz_test com ack can\r\n");
+    parser.feed(frame.constData(), frame.size());
+    QCOMPARE(frames, 1);
+}
+
+int testFrameParser(int argc, char *argv[])
+{
+    TestFrameParser test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_frameparser.moc"
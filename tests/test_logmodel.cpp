@@ -0,0 +1,105 @@
+#include "tests.h"
+#include "LogModel.h"
+
+#include <QtTest/QtTest>
+
+class TestLogModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacity();
+    void multiLineMessage();
+    void pendingQueueBounded();
+    void flushTimer();
+    void clear();
+
+private:
+    static QString text(const LogModel &model, int row)
+    {
+        return model.data(model.index(row)).toString();
+    }
+};
+
+// 超出容量时丢弃最旧的行, 行数不超过容量
+void TestLogModel::capacity()
+{
+    LogModel model(3);
+    model.setTimeFormat("'#' ");
+    QCOMPARE(model.capacity(), 3);
+    for (int i = 0; i < 5; i++)
+        model.append(QString("line %1").arg(i));
+    QCOMPARE(model.rowCount(), 0);
+    model.flush();
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.droppedLines(), quint64(2));
+    QCOMPARE(text(model, 0), QString("# line 2"));
+    QCOMPARE(text(model, 2), QString("# line 4"));
+
+    // 环形存储绕回之后顺序不变
+    model.append("line 5");
+    model.flush();
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.droppedLines(), quint64(3));
+    QCOMPARE(text(model, 0), QString("# line 3"));
+    QCOMPARE(text(model, 2), QString("# line 5"));
+    QVERIFY(!model.data(model.index(3)).isValid());
+}
+
+void TestLogModel::multiLineMessage()
+{
+    LogModel model(10);
+    model.setTimeFormat("'#' ");
+    model.append("结果如下:\r\n\r\n调试串口\t正常\r\n485通信\t异常");
+    model.flush();
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(text(model, 0), QString("# 结果如下:"));
+    QCOMPARE(text(model, 1), QString("    调试串口\t正常"));
+    QCOMPARE(text(model, 2), QString("    485通信\t异常"));
+}
+
+// 刷新前追加的行超过容量时提前刷新, 待刷新队列同样有界
+void TestLogModel::pendingQueueBounded()
+{
+    LogModel model(4);
+    for (int i = 0; i < 100; i++)
+        model.append(QString::number(i));
+    QVERIFY(model.rowCount() <= 4);
+    model.flush();
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(model.droppedLines(), quint64(96));
+}
+
+void TestLogModel::flushTimer()
+{
+    LogModel model(10);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    model.append("a");
+    model.append("b");
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(inserted.wait(LOG_FLUSH_MS * 10));
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(model.rowCount(), 2);
+}
+
+void TestLogModel::clear()
+{
+    LogModel model(2);
+    model.append("a\nb\nc");
+    model.flush();
+    model.append("pending");
+    model.clear();
+    model.flush();
+    QCOMPARE(model.rowCount(), 0);
+    model.append("d");
+    model.flush();
+    QCOMPARE(model.rowCount(), 1);
+}
+
+int testLogModel(int argc, char *argv[])
+{
+    TestLogModel test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_logmodel.moc"
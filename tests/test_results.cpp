@@ -0,0 +1,225 @@
+#include "tests.h"
+#include "ResultStore.h"
+#include "YieldStats.h"
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+namespace {
+
+RunRecord makeRun(const QString &serial, qint64 startedAt, bool pass)
+{
+    RunRecord run;
+    run.serial = serial;
+    run.port = "COM3";
+    run.startedAt = startedAt;
+    run.result = pass ? ComTest::GZ_END_SUCCESS : ComTest::GZ_END_FAILED;
+    run.pipelined = true;
+    run.protocol = ComTest::GZ_PROTO_BINARY;
+    run.cycleMs = 42;
+    run.mask485 = pass ? 0 : 0x7f;
+    run.capture = pass ? QString() : QString("/tmp/%1.gzcap").arg(serial);
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        run.done[i] = true;
+        run.pass[i] = pass || i != TEST_IDX_485;
+        run.attempts[i] = (i == TEST_IDX_485 && !pass) ? 3 : 1;
+        run.rttUs[i] = 1000 + i;
+    }
+    return run;
+}
+
+}
+
+class TestResults : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void roundTrip();
+    void queryFilters();
+    void queryAsync();
+    void yieldByMinute();
+
+private:
+    QTemporaryDir *m_dir = nullptr;
+    ResultStore *m_store = nullptr;
+};
+
+void TestResults::init()
+{
+    m_dir = new QTemporaryDir;
+    QVERIFY(m_dir->isValid());
+    m_store = new ResultStore;
+    QVERIFY(m_store->open(m_dir->filePath("results.db")));
+}
+
+void TestResults::cleanup()
+{
+    delete m_store;
+    m_store = nullptr;
+    delete m_dir;
+    m_dir = nullptr;
+}
+
+// 写入后读出的记录与写入的相同
+void TestResults::roundTrip()
+{
+    const RunRecord passed = makeRun("SN000001", 1700000000000LL, true);
+    RunRecord failed = makeRun("SN000002", 1700000060000LL, false);
+    failed.done[TEST_IDX_PMBUS] = false;
+    failed.pass[TEST_IDX_PMBUS] = false;
+    failed.attempts[TEST_IDX_PMBUS] = 2;
+    failed.rttUs[TEST_IDX_PMBUS] = -1;
+    failed.cycleMs = -1;
+    failed.result = ComTest::GZ_END_COM_TIMEOUT;
+    m_store->record(passed);
+    m_store->record(failed);
+    m_store->flush();
+    QCOMPARE(m_store->runsWritten(), quint64(2));
+    QCOMPARE(m_store->droppedRuns(), quint64(0));
+    QVERIFY(m_store->errorString().isEmpty());
+
+    const QVector<RunRecord> runs = m_store->query(QString(), 0, 1800000000000LL);
+    QCOMPARE(runs.size(), 2);
+    // 按开始时间倒序
+    const RunRecord &a = runs.at(1);
+    const RunRecord &b = runs.at(0);
+    QVERIFY(a.id > 0 && b.id > a.id);
+    QCOMPARE(a.serial, passed.serial);
+    QCOMPARE(a.port, passed.port);
+    QCOMPARE(a.startedAt, passed.startedAt);
+    QCOMPARE(a.result, passed.result);
+    QCOMPARE(a.pipelined, true);
+    QCOMPARE(a.protocol, int(ComTest::GZ_PROTO_BINARY));
+    QCOMPARE(a.cycleMs, qint64(42));
+    QCOMPARE(a.capture, QString());
+
+    QCOMPARE(b.serial, failed.serial);
+    QCOMPARE(b.result, int(ComTest::GZ_END_COM_TIMEOUT));
+    QCOMPARE(b.cycleMs, qint64(-1));
+    QCOMPARE(b.mask485, quint32(0x7f));
+    QCOMPARE(b.capture, failed.capture);
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        QCOMPARE(b.done[i], failed.done[i]);
+        QCOMPARE(b.pass[i], failed.pass[i]);
+        QCOMPARE(b.attempts[i], failed.attempts[i]);
+        QCOMPARE(b.rttUs[i], failed.rttUs[i]);
+        QCOMPARE(a.rttUs[i], passed.rttUs[i]);
+    }
+}
+
+void TestResults::queryFilters()
+{
+    const qint64 base = 1700000000000LL;
+    for (int i = 0; i < 10; i++)
+        m_store->record(makeRun(QString("SN%1").arg(i % 2), base + i * 1000, true));
+    m_store->flush();
+
+    QCOMPARE(m_store->query("SN0", 0, base + 100000).size(), 5);
+    QCOMPARE(m_store->query("SN9", 0, base + 100000).size(), 0);
+    // [from, to)
+    QCOMPARE(m_store->query(QString(), base + 2000, base + 5000).size(), 3);
+    const QVector<RunRecord> latest = m_store->query(QString(), 0, base + 100000, 4);
+    QCOMPARE(latest.size(), 4);
+    QCOMPARE(latest.first().startedAt, base + 9000);
+    QCOMPARE(latest.last().startedAt, base + 6000);
+}
+
+// 后台线程中查询, 排在已入队的记录之后, 不需要先 flush
+void TestResults::queryAsync()
+{
+    const qint64 base = 1700000000000LL;
+    for (int i = 0; i < 3; i++)
+        m_store->record(makeRun("SN000003", base + i * 1000, i != 1));
+
+    QEventLoop loop;
+    QVector<RunRecord> runs;
+    bool called = false;
+    m_store->queryAsync("SN000003", 0, base + 100000, 1000, &loop, [&](const QVector<RunRecord> &result) {
+        runs = result;
+        called = true;
+        loop.quit();
+    });
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    loop.exec();
+    QVERIFY(called);
+    QCOMPARE(runs.size(), 3);
+    QCOMPARE(runs.at(1).result, int(ComTest::GZ_END_FAILED));
+    QVERIFY(!runs.at(1).pass[TEST_IDX_485]);
+
+    // context 先销毁时不再回调
+    bool late = false;
+    {
+        QObject context;
+        m_store->queryAsync(QString(), 0, base + 100000, 1000, &context, [&](const QVector<RunRecord> &) {
+            late = true;
+        });
+    }
+    // 后台按顺序执行, 下一次查询的结果交回时上一次的已经处理过
+    called = false;
+    m_store->queryAsync(QString(), 0, base + 100000, 1000, &loop, [&](const QVector<RunRecord> &) {
+        called = true;
+        loop.quit();
+    });
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    loop.exec();
+    QVERIFY(called);
+    QVERIFY(!late);
+}
+
+// 库中按分钟汇总的结果与逐条计数相同
+void TestResults::yieldByMinute()
+{
+    const qint64 base = 1700000000000LL / 60000 * 60000;
+    YieldCounters expected;
+    for (int i = 0; i < 12; i++) {
+        RunRecord run = makeRun(QString("SN%1").arg(i), base + i * 20000, i % 3 != 0);
+        if (i == 4) {
+            run.result = ComTest::GZ_END_COM_TIMEOUT;
+            run.done[TEST_IDX_CAN] = false;
+            run.done[TEST_IDX_PMBUS] = false;
+        }
+        expected.add(run);
+        m_store->record(run);
+    }
+
+    QEventLoop loop;
+    QVector<QPair<qint64, YieldCounters>> minutes;
+    m_store->yieldByMinuteAsync(base, base + 3600 * 1000LL, &loop, [&](const QVector<QPair<qint64, YieldCounters>> &result) {
+        minutes = result;
+        loop.quit();
+    });
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    QCOMPARE(minutes.size(), 4);
+    QCOMPARE(minutes.first().first, base);
+    QCOMPARE(minutes.first().second.runs, quint32(3));
+    YieldCounters total;
+    for (const QPair<qint64, YieldCounters> &minute : minutes)
+        total.merge(minute.second);
+    QCOMPARE(total.runs, expected.runs);
+    QCOMPARE(total.passed, expected.passed);
+    QCOMPARE(total.firstPass, expected.firstPass);
+    QCOMPARE(total.timeouts, expected.timeouts);
+    QCOMPARE(total.cycleMsSum, expected.cycleMsSum);
+    QCOMPARE(total.cycles, expected.cycles);
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        QCOMPARE(total.itemFailed[i], expected.itemFailed[i]);
+        QCOMPARE(total.itemMissing[i], expected.itemMissing[i]);
+        QCOMPARE(total.itemRetried[i], expected.itemRetried[i]);
+    }
+    for (int ch = 0; ch < YIELD_485_CHANNELS; ch++)
+        QCOMPARE(total.channel485Failed[ch], expected.channel485Failed[ch]);
+}
+
+int testResults(int argc, char *argv[])
+{
+    TestResults test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_results.moc"
@@ -0,0 +1,212 @@
+#include "tests.h"
+#include "YieldStats.h"
+#include "ResultStore.h"
+
+#include <QtCore/QDateTime>
+#include <QtTest/QtTest>
+
+namespace {
+
+const qint64 kMinuteMs = 60 * 1000;
+const qint64 kHourMs = 60 * kMinuteMs;
+// 整点, 分钟环和小时环的格子从这里开始
+const qint64 kBase = 1700000000000LL / kHourMs * kHourMs;
+
+RunRecord makeRun(qint64 startedAt, bool pass)
+{
+    RunRecord run;
+    run.startedAt = startedAt;
+    run.result = pass ? ComTest::GZ_END_SUCCESS : ComTest::GZ_END_FAILED;
+    run.cycleMs = 40;
+    run.mask485 = pass ? 0 : 0xfe;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++) {
+        run.done[i] = true;
+        run.pass[i] = pass || i != TEST_IDX_485;
+        run.attempts[i] = 1;
+    }
+    return run;
+}
+
+// 本地时间 2024-01-10 的 hh:mm
+qint64 localTime(int day, int hour, int minute)
+{
+    return QDateTime(QDate(2024, 1, day), QTime(hour, minute)).toMSecsSinceEpoch();
+}
+
+}
+
+class TestYield : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void counters();
+    void lastHourWindow();
+    void hourRing();
+    void shiftChange();
+    void shiftGap();
+    void shiftSpec();
+};
+
+void TestYield::counters()
+{
+    YieldCounters counters;
+    counters.add(makeRun(kBase, true));
+    RunRecord retried = makeRun(kBase, true);
+    retried.attempts[TEST_IDX_CAN] = 2;
+    counters.add(retried);
+    counters.add(makeRun(kBase, false));
+    // 调试串口超时, 之后的项都没有测到, 不算这些项的失败
+    RunRecord timeout = makeRun(kBase, false);
+    timeout.result = ComTest::GZ_END_COM_TIMEOUT;
+    timeout.cycleMs = -1;
+    for (int i = 0; i < TEST_ITEMS_NUM; i++)
+        timeout.done[i] = false;
+    counters.add(timeout);
+
+    QCOMPARE(counters.runs, quint32(4));
+    QCOMPARE(counters.passed, quint32(2));
+    QCOMPARE(counters.firstPass, quint32(1));
+    QCOMPARE(counters.timeouts, quint32(1));
+    QCOMPARE(counters.itemFailed[TEST_IDX_485], quint32(1));
+    QCOMPARE(counters.itemMissing[TEST_IDX_485], quint32(1));
+    QCOMPARE(counters.itemFailed[TEST_IDX_DEBUG_COM], quint32(0));
+    QCOMPARE(counters.itemRetried[TEST_IDX_CAN], quint32(1));
+    // 掩码 fe: 只有第 1 通道异常
+    QCOMPARE(counters.channel485Failed[0], quint32(1));
+    QCOMPARE(counters.channel485Failed[1], quint32(0));
+    QCOMPARE(counters.cycles, quint32(3));
+    QCOMPARE(counters.meanCycleMs(), 40.0);
+    QCOMPARE(counters.yield(), 0.5);
+}
+
+// 最近 60 分钟: 过期的分钟不计入, 被新的一分钟覆盖的格子整格清零
+void TestYield::lastHourWindow()
+{
+    YieldStats stats;
+    stats.record(makeRun(kBase, true));
+    stats.record(makeRun(kBase + 10 * kMinuteMs, false));
+    stats.record(makeRun(kBase + 30 * kMinuteMs, true));
+    QCOMPARE(stats.lastHour(kBase + 30 * kMinuteMs).runs, quint32(3));
+    QCOMPARE(stats.lastHour(kBase + 65 * kMinuteMs).runs, quint32(2));
+    QCOMPARE(stats.lastHour(kBase + 89 * kMinuteMs).runs, quint32(1));
+    QCOMPARE(stats.lastHour(kBase + 90 * kMinuteMs).runs, quint32(0));
+
+    // 与第 10 分钟同一个格子
+    stats.record(makeRun(kBase + 70 * kMinuteMs, true));
+    const YieldCounters window = stats.lastHour(kBase + 70 * kMinuteMs);
+    QCOMPARE(window.runs, quint32(2));
+    QCOMPARE(window.passed, quint32(2));
+    QCOMPARE(stats.total().runs, quint32(4));
+
+    // 导入的旧记录已不在窗口内, 不覆盖新的格子
+    stats.record(makeRun(kBase + 10 * kMinuteMs, false));
+    QCOMPARE(stats.lastHour(kBase + 70 * kMinuteMs).runs, quint32(2));
+    QCOMPARE(stats.total().runs, quint32(5));
+}
+
+void TestYield::hourRing()
+{
+    YieldStats stats;
+    stats.record(makeRun(kBase, true));
+    stats.record(makeRun(kBase + 20 * kMinuteMs, false));
+    stats.record(makeRun(kBase + kHourMs + 5 * kMinuteMs, true));
+
+    QList<QPair<qint64, YieldCounters>> hours = stats.hours(kBase + kHourMs + 30 * kMinuteMs);
+    QCOMPARE(hours.size(), YIELD_HOURS);
+    QCOMPARE(hours.last().first, kBase + kHourMs);
+    QCOMPARE(hours.last().second.runs, quint32(1));
+    QCOMPARE(hours.at(YIELD_HOURS - 2).first, kBase);
+    QCOMPARE(hours.at(YIELD_HOURS - 2).second.runs, quint32(2));
+    QCOMPARE(hours.at(YIELD_HOURS - 2).second.passed, quint32(1));
+
+    // 24 小时后第一个小时移出窗口
+    hours = stats.hours(kBase + 24 * kHourMs);
+    QCOMPARE(hours.first().first, kBase + kHourMs);
+    QCOMPARE(hours.first().second.runs, quint32(1));
+    for (int i = 1; i < YIELD_HOURS; i++)
+        QCOMPARE(hours.at(i).second.runs, quint32(0));
+
+    // 同一个格子写入 24 小时后的记录时, 旧的计数清零
+    stats.record(makeRun(kBase + 24 * kHourMs, true));
+    hours = stats.hours(kBase + 24 * kHourMs);
+    QCOMPARE(hours.last().second.runs, quint32(1));
+}
+
+// 默认 08:00 / 20:00 交班
+void TestYield::shiftChange()
+{
+    YieldStats stats;
+    stats.record(makeRun(localTime(10, 19, 50), true));
+    stats.record(makeRun(localTime(10, 19, 55), false));
+    stats.record(makeRun(localTime(10, 20, 10), true));
+
+    qint64 start = 0;
+    YieldCounters current = stats.currentShift(localTime(10, 20, 30), &start);
+    QCOMPARE(start, localTime(10, 20, 0));
+    QCOMPARE(current.runs, quint32(1));
+    YieldCounters previous = stats.previousShift(localTime(10, 20, 30), &start);
+    QCOMPARE(start, localTime(10, 8, 0));
+    QCOMPARE(previous.runs, quint32(2));
+    QCOMPARE(previous.passed, quint32(1));
+
+    // 夜班跨过 0 点
+    stats.record(makeRun(localTime(11, 2, 0), true));
+    current = stats.currentShift(localTime(11, 7, 59), &start);
+    QCOMPARE(start, localTime(10, 20, 0));
+    QCOMPARE(current.runs, quint32(2));
+
+    // 交班后还没有测试: 本班为空, 上一班是刚结束的夜班
+    current = stats.currentShift(localTime(11, 8, 0), &start);
+    QCOMPARE(start, localTime(11, 8, 0));
+    QCOMPARE(current.runs, quint32(0));
+    QCOMPARE(stats.previousShift(localTime(11, 8, 0)).runs, quint32(2));
+
+    // 导入的上一班记录计入上一班, 更早的不计入
+    stats.record(makeRun(localTime(10, 9, 0), false));
+    stats.record(makeRun(localTime(10, 7, 0), false));
+    QCOMPARE(stats.previousShift(localTime(10, 20, 30)).runs, quint32(3));
+    QCOMPARE(stats.total().runs, quint32(6));
+}
+
+// 中间隔了整班没有测试时, 上一班为空
+void TestYield::shiftGap()
+{
+    YieldStats stats;
+    stats.record(makeRun(localTime(10, 9, 0), true));
+    stats.record(makeRun(localTime(11, 9, 0), true));
+    QCOMPARE(stats.currentShift(localTime(11, 10, 0)).runs, quint32(1));
+    QCOMPARE(stats.previousShift(localTime(11, 10, 0)).runs, quint32(0));
+}
+
+void TestYield::shiftSpec()
+{
+    YieldStats stats;
+    QVERIFY(!stats.setShiftStarts(QString("25:00")));
+    QVERIFY(!stats.setShiftStarts(QString("")));
+    QCOMPARE(stats.shiftStarts(), QList<int>() << 8 * 60 << 20 * 60);
+
+    QVERIFY(stats.setShiftStarts(QString("22:00, 6:00,14:00")));
+    QCOMPARE(stats.shiftStarts(), QList<int>() << 6 * 60 << 14 * 60 << 22 * 60);
+
+    stats.record(makeRun(localTime(10, 13, 0), true));
+    stats.record(makeRun(localTime(10, 15, 0), true));
+    qint64 start = 0;
+    QCOMPARE(stats.currentShift(localTime(10, 15, 30), &start).runs, quint32(1));
+    QCOMPARE(start, localTime(10, 14, 0));
+    QCOMPARE(stats.previousShift(localTime(10, 15, 30), &start).runs, quint32(1));
+    QCOMPARE(start, localTime(10, 6, 0));
+
+    // 修改交班时刻后当前班次重新开始
+    stats.setShiftStarts(QList<int>() << 0);
+    QCOMPARE(stats.currentShift(localTime(10, 15, 30)).runs, quint32(0));
+    QCOMPARE(stats.total().runs, quint32(2));
+}
+
+int testYield(int argc, char *argv[])
+{
+    TestYield test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_yield.moc"
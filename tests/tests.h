@@ -0,0 +1,13 @@
+#ifndef TESTS_H
+#define TESTS_H
+
+// 各测试入口, 在 main.cpp 的 kTests 中登记; 返回失败的用例数
+int testFrameParser(int argc, char *argv[]);
+int testAckParse(int argc, char *argv[]);
+int testBinaryProtocol(int argc, char *argv[]);
+int testComTest(int argc, char *argv[]);
+int testLogModel(int argc, char *argv[]);
+int testResults(int argc, char *argv[]);
+int testYield(int argc, char *argv[]);
+
+#endif // TESTS_H
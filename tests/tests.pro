@@ -0,0 +1,23 @@
+QT       -= gui
+QT       += core network serialport sql testlib
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = gz_tests
+
+include(../gz_common.pri)
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp \
+    test_frameparser.cpp \
+    test_ackparse.cpp \
+    test_binaryprotocol.cpp \
+    test_comtest.cpp \
+    test_logmodel.cpp \
+    test_results.cpp \
+    test_yield.cpp
+
+HEADERS += \
+    tests.h
@@ -0,0 +1,27 @@
+//
+// Created by chang on 2017-08-02.
+//
+
+#include <QtWidgets/QMessageBox>
+#include "uiglobal.h"
+
+bool okToContinue(const QString &title, const QString &text, QWidget *parent) {
+    return QMessageBox::Yes == QMessageBox::warning(parent, title, text, QMessageBox::Yes | QMessageBox::No);
+}
+
+bool showQuestion(const QString &title, const QString &text, QWidget *parent) {
+    return QMessageBox::question(parent, title, text, QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes;
+}
+
+void showError(const QString &title, const QString &text, QWidget *parent) {
+    return (void) QMessageBox::critical(parent, title, text, QMessageBox::Ok);
+}
+
+bool showWarning(const QString &title, const QString &text, QWidget *parent) {
+    return QMessageBox::warning(parent, title, text, QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes;
+//    return QMessageBox::warning(parent, title, text, QMessageBox::Yes | QMessageBox::Cancel) == QMessageBox::Yes;
+}
+
+void showMessage(const QString &title, const QString &text, QWidget *parent) {
+    return (void) QMessageBox::information(parent, title, text);
+};
@@ -0,0 +1,24 @@
+//
+// Created by chang on 2017-08-02.
+//
+
+#ifndef SERIALWIZARD_UIGLOBAL_H
+#define SERIALWIZARD_UIGLOBAL_H
+
+#include <QString>
+#include <QWidget>
+
+// 消息框, 只在界面程序中使用; 其余工具函数见 global.h(不依赖 QtWidgets)
+
+extern bool okToContinue(const QString &title, const QString &text, QWidget *parent = nullptr);
+
+extern bool showQuestion(const QString &title, const QString &text, QWidget *parent = nullptr);
+
+extern void showError(const QString &title, const QString &text, QWidget *parent = nullptr);
+
+extern bool showWarning(const QString &title, const QString &text, QWidget *parent = nullptr);
+
+extern void showMessage(const QString &title, const QString &text, QWidget *parent = nullptr);
+
+
+#endif //SERIALWIZARD_UIGLOBAL_H
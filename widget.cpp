@@ -1,191 +1,243 @@
 #include "widget.h"
 #include "ui_widget.h"
+#include "ComTest.h"
+#include "TestStation.h"
+#include "StationGrid.h"
+#include "NetSettings.h"
+#include "LogModel.h"
+#include "LatencyStats.h"
+#include "LatencyDialog.h"
+#include "YieldStats.h"
+#include "YieldDialog.h"
+#include "HexMonitorDialog.h"
+#include "PortMonitor.h"
+#include "UiRefresher.h"
+#include "ControlServer.h"
+#include "ResultStore.h"
 
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 #include <QtSerialPort/qserialport.h>
-#include "SerialReadWriter.h"
 #include "global.h"
-#include <QDebug>
+#include "uiglobal.h"
+#include "Logging.h"
 #include <QDate>
 #include <QMessageBox>
 #include <QKeyEvent>
 #include <QTimer>
 #include <QAction>
 #include <QMenu>
+#include <QScrollBar>
+#include <QHostInfo>
+#include <QDir>
+#include <QStandardPaths>
 
 
-void Delay_MSec_Suspend(unsigned int msec)
-{
-    QTime _Timer = QTime::currentTime().addMSecs(msec);
-    while( QTime::currentTime() < _Timer );
-}
-
 Widget::Widget(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::Widget)
-    , comTest(new ComTest)
-    , testProgressDlg(new MyProgressDlg(this))
+    , station(new TestStation(QString(), this))
+    , logModel(new LogModel(LOG_MODEL_CAPACITY, this))
+    , uiRefresher(new UiRefresher(this))
+    , latencyStats(new LatencyStats)
+    , resultStore(new ResultStore)
+    , yieldStats(new YieldStats)
+    , startedAt(QDateTime::currentMSecsSinceEpoch())
 {
+    StartupTrace::mark("widget members");
     ui->setupUi(this);
     this->setWindowTitle(tr("agv工装测试软件"));
     this->setFixedSize( W_MAIN_WIDGET, H_MAIN_WIDGET );
-
-    QStringList serialPortNameList = getSerialNameList();
-    ui->serialPortNameComboBox->addItems(serialPortNameList);
+    StartupTrace::mark("setupUi");
+
+    // 多工位状态表, 与详细信息共用窗口下方区域; 端口列表由 portMonitor 在后台枚举后填入
+    stationGrid = new StationGrid(this);
+    stationGrid->setVisible(false);
+
+    // 详细信息: 定长日志模型, 只绘制可见行
+    ui->listView_ExecInfo->setModel(logModel);
+    connect(logModel, &QAbstractItemModel::rowsAboutToBeInserted, this, [this]() {
+        QScrollBar *bar = ui->listView_ExecInfo->verticalScrollBar();
+        logFollowTail = (bar->value() == bar->maximum());
+    });
+    connect(logModel, &QAbstractItemModel::rowsInserted, this, [this]() {
+        // 用户向上翻看时不打断
+        if (logFollowTail)
+            ui->listView_ExecInfo->scrollToBottom();
+    });
+
+    station->setLatencyStats(latencyStats);
+    traceDir = QString::fromLocal8Bit(qgetenv("GZ_TRACE_DIR"));
+    captureDir = QString::fromLocal8Bit(qgetenv("GZ_CAPTURE_DIR"));
+    station->setCaptureDir(captureDir);
+    TraceRing::instance().setEnabled(!traceDir.isEmpty());
+    openResultStore();
+    // 交班时刻, 例如 GZ_SHIFTS=08:00,16:00,00:00; 默认 08:00 和 20:00 两班
+    const QString shifts = QString::fromLocal8Bit(qgetenv("GZ_SHIFTS"));
+    if (!shifts.isEmpty() && !yieldStats->setShiftStarts(shifts))
+        qCWarning(lcUi) << "invalid GZ_SHIFTS" << shifts;
+    station->setResultStore(resultStore);
+
+    StartupTrace::mark("log view");
+
+    // 串口热插拔: 列表保持最新, 新插入的工装板探测到后可自动开始测试.
+    // 第一次枚举也在后台线程中进行, 窗口不等串口列表就显示
+    portMonitor = new PortMonitor(this);
+    connect(portMonitor, &PortMonitor::portsChanged, this, &Widget::onPortsChanged);
+    connect(portMonitor, &PortMonitor::portAdded, this, &Widget::onPortAdded);
+    connect(portMonitor, &PortMonitor::portRemoved, this, &Widget::onPortRemoved);
+    connect(portMonitor, &PortMonitor::dutDetected, this, &Widget::onDutDetected);
+    connect(portMonitor, &PortMonitor::probeFinished, this, &Widget::onProbeFinished);
+    portMonitor->start();
+    StartupTrace::mark("port monitor");
+
+    startControlServer();
+
+    // 本机地址只在"关于"中显示, 后台查询, 不阻塞启动
+    lookupIp(this, SLOT(onHostLookedUp(QHostInfo)));
 
     // 测试相关
-    qDebug() << "test part num: " << comTest->m_testItemsNum;
-//    comTest->m_testItemsNum = 4;
-
-    // 进度条
-    testProgressDlg->setMaxNum(100);
-    testProgressDlg->setPartNum( comTest->m_testItemsNum );
-    testProgressDlg->reset();
+    qCDebug(lcUi) << "test part num: " << TEST_ITEMS_NUM;
 
     createConnect();
+    updateLayout();
+    StartupTrace::mark("layout");
 }
 
 Widget::~Widget()
 {
+    qDeleteAll(stations);
+    delete station;
     delete ui;
-    delete comTest;
     delete testProgressDlg;
+    delete latencyStats;
+    delete resultStore;
+    delete yieldStats;
 }
 
-QStringList Widget::getSerialNameList() {
+// 进度条第一次测试时才创建
+MyProgressDlg *Widget::progressDlg(void)
+{
+    if (testProgressDlg == nullptr) {
+        testProgressDlg = new MyProgressDlg(this);
+        testProgressDlg->setMaxNum(100);
+        testProgressDlg->setPartNum( TEST_ITEMS_NUM );
+        testProgressDlg->reset();
+    }
+    return testProgressDlg;
+}
 
-    auto serialPortInfoList = QSerialPortInfo::availablePorts();
-    QStringList l;
-    for (auto &s:serialPortInfoList) {
-        l.append(s.portName());
+void Widget::updateLayout(void)
+{
+    // 窗口下方依次排列: 多工位状态表(多工位模式) -> 详细信息(展开时)
+    const bool multi = ui->multiStationCheckBox->isChecked();
+    const bool detail = ui->showDetailBtn->isChecked();
+    int y = H_MAIN_WIDGET;
+
+    stationGrid->setVisible(multi);
+    if (multi) {
+        stationGrid->setGeometry(10, y, W_MAIN_WIDGET - 19, H_DETAIL_AREA - 9);
+        y += H_DETAIL_AREA;
     }
-    return l;
+
+    ui->listView_ExecInfo->setVisible(detail);
+    if (detail) {
+        ui->listView_ExecInfo->move(10, y);
+        y += H_DETAIL_AREA;
+    }
+
+    this->setFixedSize( W_MAIN_WIDGET, y );
 }
 
 void Widget::on_showDetailBtn_toggled(bool checked)
 {
     if(checked)
     {
-        this->setFixedSize( W_MAIN_WIDGET, H_EXT_MAIN_WIDGET);
-        ui->textBrowser_ExecInfo->setVisible(checked);
         ui->showDetailBtn->setText(tr("隐藏详细信息"));
     }
     else
     {
-        this->setFixedSize( W_MAIN_WIDGET, H_MAIN_WIDGET);
-        ui->textBrowser_ExecInfo->setVisible(false);
         ui->showDetailBtn->setText(tr("显示详细信息"));
     }
+    updateLayout();
 }
 
-void Widget::createConnect()
+void Widget::on_multiStationCheckBox_toggled(bool checked)
 {
-    connect(this, &Widget::serialStateChanged, [this](bool isOpen) {
-//    setOpenButtonText(isOpen);
-    QString stateText;
-    if (isOpen) {
-        stateText = QString("串口打开成功，%1").arg(_readWriter->settingsText());
+    if (checked) {
+        // 手工输入的网口地址也作为一个工位
+        QStringList ports = portMonitor->ports();
+        const QString current = ui->serialPortNameComboBox->currentText().trimmed();
+        if (NetSettings::isNetSpec(current) && !ports.contains(current))
+            ports.append(current);
+        stationGrid->setPorts(ports);
+        // 单工位保持打开的端口要让给多工位
+        station->closeSession();
     } else {
-        stateText = QString("串口关闭\r\n");
+        for (auto s : stations)
+            s->closeSession();
     }
-    logMsg(stateText);
-});
-
-    connect(this, &Widget::readBytesChanged, this, &Widget::dealWithRecData);
-    connect(this, &Widget::writeBytesChanged, this, &Widget::dealWithSendData);
-    connect(comTest, SIGNAL(sendData(QByteArray)), this, SLOT(readToSend(QByteArray)));
+    ui->serialPortNameComboBox->setDisabled(checked);
+    updateLayout();
 }
 
-void Widget::logMsg(const QString &msg)
+void Widget::on_keepOpenCheckBox_toggled(bool checked)
 {
-    QString str = QDateTime::currentDateTime().toString(QString("[yyyy-MM-dd HH:mm:ss] "));
-    str.append(msg);
-    ui->textBrowser_ExecInfo->append(str);
+    // 取消时空闲工位的端口立即关闭
+    station->setPersistentSession(checked);
+    for (auto s : stations)
+        s->setPersistentSession(checked);
 }
 
-bool Widget::openReadWriter()
+void Widget::createConnect()
 {
-    bool result;
-    auto settings = new SerialSettings();
-    settings->name = ui->serialPortNameComboBox->currentText();
-    settings->baudRate = QSerialPort::Baud115200;
-    settings->dataBits = QSerialPort::Data8;
-    settings->stopBits = QSerialPort::OneStop;
-    settings->parity = QSerialPort::NoParity;
-    settings->flowControl = QSerialPort::NoFlowControl;
-
-    auto readWriter = new SerialReadWriter(this);
-    readWriter->setSerialSettings(*settings);
-
-    qDebug() << settings->name << settings->baudRate << settings->dataBits << settings->stopBits << settings->parity;
-    result = readWriter->open();
-    if (!result) {
-//        showWarning(tr("消息"), tr("串口被占用或者不存在"));
-        return result;
-    }
-    _readWriter = readWriter;
-    connect(_readWriter, &AbstractReadWriter::readyRead,
-            this, &Widget::readData);
-
-    emit serialStateChanged(result);
-
-    return result;
+    // 进度条不直接连到测试信号, 由 uiRefresher 按帧率取快照刷新
+    uiRefresher->watch(station, [this](const StationSnapshot &snapshot) {
+        if (snapshot.state == StationSnapshot::RUNNING)
+            progressDlg()->showProgress(snapshot.part, snapshot.cnt);
+    });
+    connect(station, &TestStation::logInfo, this, &Widget::logMsg);
+    connect(station, &TestStation::finished, this, &Widget::onTestFinished);
 }
 
-void Widget::closeReadWriter()
+void Widget::logMsg(const QString &msg)
 {
-    if (_readWriter != nullptr) {
-        _readWriter->close();
-        qDebug("close");
-        delete _readWriter;
-        _readWriter = nullptr;
-    }
-    emit serialStateChanged(false);
-}
-
-void Widget::readData() {
-    auto data = _readWriter->readAll();
-    if (!data.isEmpty()) {
-        recBuff = data;
-        receiveCount = data.length();
-
-        QString s( QString::fromLocal8Bit(data) );
-        qDebug() << s;
-        emit readBytesChanged(receiveCount);
-    }
+    // 时间戳由模型记录, 显示时才格式化
+    logModel->append(msg);
 }
 
-qint64 Widget::writeData(const QByteArray &data)
+void Widget::on_startBtn_clicked()
 {
-    if (!data.isEmpty() && isReadWriterConnected()) {
-        auto count = _readWriter->write(data);
-        return count;
+    qCDebug(lcUi) << "clicked";
+    if (ui->multiStationCheckBox->isChecked()) {
+        startMultiStation();
+        return;
     }
-    return 0;
-}
-
-bool Widget::isReadWriterConnected() {
-    return _readWriter != nullptr && _readWriter->isConnected();
-}
 
-void Widget::on_startBtn_clicked()
-{
-    qDebug() << "clicked";
-    if( openReadWriter() ) {
-        qDebug("open success");
+    const QString portName = ui->serialPortNameComboBox->currentText().trimmed();
+    if (portMonitor->isProbing(portName)) {
+        // 探测者正占用端口, 同时打开会失败或收到探测的应答
+        pendingStartPort = portName;
+        logMsg(QString("[%1] 正在探测, 探测结束后开始测试").arg(portName));
+        return;
+    }
+    pendingStartPort.clear();
+    station->setPortName(portName);
+    station->comTest()->setPipelined(ui->pipelineCheckBox->isChecked());
+    station->setAdaptiveTimeout(ui->adaptiveTimeoutCheckBox->isChecked());
+    station->setPersistentSession(ui->keepOpenCheckBox->isChecked());
+    station->comTest()->setBinaryProtocol(ui->binaryProtocolCheckBox->isChecked());
+    station->setBoardSerial(ui->serialLineEdit->text().trimmed());
+    if( station->start() ) {
+        qCDebug(lcUi, "open success");
+        uiRefresher->wake();
         ui->serialPortNameComboBox->setDisabled(true);
-        connect(_readWriter, &AbstractReadWriter::readyRead,
-                this, &Widget::readData);
         startTest();
     }
     else
     {
-        qDebug("open failed");
-        closeReadWriter();
+        qCDebug(lcUi, "open failed");
         ui->serialPortNameComboBox->setDisabled(false);
-        disconnect(_readWriter, &AbstractReadWriter::readyRead,
-                this, &Widget::readData);
 
         QMessageBox::warning(this, "端口打开失败", "请检查接口是否被占用", u8"退出");
 //        showWarning(tr("消息"), tr("串口被占用或者不存在"));
@@ -194,61 +246,227 @@ void Widget::on_startBtn_clicked()
 
 void Widget::startTest(void)
 {
-        testProgressDlg->setMaxNum(100);
-        testProgressDlg->move(this->x() + this->width()/2 - testProgressDlg->width()/2, this->y() + this->height()/2 - testProgressDlg->height()/2 + 10);
-        testProgressDlg->show();
-
-        connect(comTest, SIGNAL(progress(int, int)), testProgressDlg, SLOT(showProgress(int, int)));
-        connect(comTest, SIGNAL(logInfo(const QString &)), this, SLOT(logMsg(const QString &)));
+        MyProgressDlg *dlg = progressDlg();
+        dlg->setMaxNum(100);
+        dlg->move(this->x() + this->width()/2 - dlg->width()/2, this->y() + this->height()/2 - dlg->height()/2 + 10);
+        dlg->show();
+}
 
-        int ret = comTest->Test();
+void Widget::onTestFinished(int ret)
+{
         // 进度条处理
         testProgressDlg->reset();
-        // 串口处理
-        closeReadWriter();
+        // 串口已由工位关闭, 保持连接时仍打开
+        if(ret != ComTest::GZ_END_SUCCESS)
+            dumpTrace(station);
+        yieldStats->record(station->runRecord());
         ui->serialPortNameComboBox->setDisabled(false);
+        // 下一块板扫码时直接覆盖
+        ui->serialLineEdit->selectAll();
+        ui->serialLineEdit->setFocus();
 
         if(ret == ComTest::GZ_END_SUCCESS){
             QMessageBox::information(this, "测试结果", "测试通过", u8"退出");
         }else if(ret == ComTest::GZ_END_FAILED){
-            QMessageBox::warning(this, "测试未通过", comTest->m_result_info, u8"退出");
+            QMessageBox::warning(this, "测试未通过", station->resultInfo(), u8"退出");
         }else if(ret == ComTest::GZ_END_COM_TIMEOUT){
 //            QMessageBox::warning(this, "通信失败", "请检查通信连接", u8"退出");
             showError("通信失败", "请检查通信连接");
         }
+}
+
+TestStation *Widget::multiStation(const QString &portName)
+{
+    for (auto s : stations) {
+        if (s->portName() == portName)
+            return s;
+    }
+
+    // 每个端口独立的会话: 自己的IO线程、缓冲区、结果和超时
+    auto s = new TestStation(portName);
+    s->setLatencyStats(latencyStats);
+    s->setResultStore(resultStore);
+    s->setCaptureDir(captureDir);
+    connect(s, &TestStation::logInfo, this, [this, portName](const QString &msg) {
+        logMsg(QString("[%1] %2").arg(portName, msg));
+    });
+    uiRefresher->watch(s, [this, portName](const StationSnapshot &snapshot) {
+        if (snapshot.state == StationSnapshot::RUNNING)
+            stationGrid->setProgress(portName, snapshot.part, snapshot.cnt);
+    });
+    connect(s, &TestStation::finished, this, [this, portName, s](int result) {
+        stationGrid->setResult(portName, result);
+        if (result != ComTest::GZ_END_SUCCESS)
+            dumpTrace(s);
+        yieldStats->record(s->runRecord());
+    });
+    if (hexMonitor != nullptr)
+        hexMonitor->attach(s);
+    stations.append(s);
+    return s;
+}
+
+void Widget::dumpTrace(TestStation *s)
+{
+    if (traceDir.isEmpty())
+        return;
+    const QString fileName = QString("%1/trace_%2_%3.txt").arg(traceDir)
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz")).arg(s->traceId());
+    if (TraceRing::instance().dumpToFile(fileName, s->traceId()))
+        logMsg(QString("跟踪记录已保存: %1").arg(fileName));
+}
+
+// 结果库在后台线程中打开, 不阻塞启动; GZ_RESULT_DB 未设置时放在用户数据目录
+void Widget::openResultStore(void)
+{
+    QString fileName;
+    if (qEnvironmentVariableIsSet("GZ_RESULT_DB")) {
+        fileName = QString::fromLocal8Bit(qgetenv("GZ_RESULT_DB"));
+    } else {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+        if (!dir.isEmpty() && QDir().mkpath(dir))
+            fileName = dir + "/results.db";
+    }
+    if (!fileName.isEmpty())
+        resultStore->open(fileName);
+}
+
+void Widget::on_serialLineEdit_returnPressed()
+{
+    // 扫码枪扫完板号自动回车
+    if (!ui->multiStationCheckBox->isChecked() && !station->isRunning())
+        on_startBtn_clicked();
+}
+
+// MES 通过控制接口按端口启动测试, 使用与多工位表相同的工位, 界面同步显示进度和结果
+void Widget::startControlServer(void)
+{
+    const QString tcpPort = QString::fromLocal8Bit(qgetenv("GZ_CONTROL_PORT"));
+    const QString socketName = QString::fromLocal8Bit(qgetenv("GZ_CONTROL_SOCKET"));
+    if (tcpPort.isEmpty() && socketName.isEmpty())
+        return;
 
-        // 测试对象处理
-        comTest->Reset();
+    controlServer = new ControlServer(this);
+    controlServer->setStationProvider([this](const QString &portName) {
+        return multiStation(portName);
+    });
+    controlServer->setResultStore(resultStore);
+    controlServer->setPortMonitor(portMonitor);
+    controlServer->setPortLister([this]() {
+        return portMonitor->ports();
+    });
+    connect(controlServer, &ControlServer::logInfo, this, &Widget::logMsg);
+    connect(controlServer, &ControlServer::testStarted, this, [this](const QString &portName) {
+        stationGrid->addPort(portName);
+        stationGrid->setState(portName, tr("测试中"));
+        stationGrid->setProgress(portName, 0, 0);
+        uiRefresher->wake();
+    });
+    if (!tcpPort.isEmpty() && !controlServer->listenTcp(static_cast<quint16>(tcpPort.toUInt())))
+        logMsg(QString("控制接口监听端口 %1 失败: %2").arg(tcpPort, controlServer->errorString()));
+    if (!socketName.isEmpty() && !controlServer->listenLocal(socketName))
+        logMsg(QString("控制接口监听 %1 失败: %2").arg(socketName, controlServer->errorString()));
+}
 
-        disconnect(comTest, SIGNAL(progress(int, int)), testProgressDlg, SLOT(showProgress(int, int)));
-        disconnect(comTest, SIGNAL(logInfo(const QString &)), this, SLOT(logMsg(const QString &)));
+void Widget::startMultiStation(void)
+{
+    const QStringList ports = stationGrid->checkedPorts();
+    if (ports.isEmpty()) {
+        showMessage(tr("多工位测试"), tr("请在列表中勾选要测试的端口"), this);
+        return;
+    }
+
+    for (const QString &port : ports)
+        startStation(port);
+}
+
+void Widget::startStation(const QString &portName)
+{
+    auto s = multiStation(portName);
+    if (s->isRunning())
+        return;
+    if (portMonitor->isProbing(portName)) {
+        pendingStations.insert(portName);
+        stationGrid->setState(portName, tr("等待探测结束"));
+        return;
+    }
+    s->comTest()->setPipelined(ui->pipelineCheckBox->isChecked());
+    s->setAdaptiveTimeout(ui->adaptiveTimeoutCheckBox->isChecked());
+    s->setPersistentSession(ui->keepOpenCheckBox->isChecked());
+    s->comTest()->setBinaryProtocol(ui->binaryProtocolCheckBox->isChecked());
+    // 板号输入框只对应单工位
+    s->setBoardSerial(QString());
+    if (s->start()) {
+        stationGrid->setState(portName, tr("测试中"));
+        stationGrid->setProgress(portName, 0, 0);
+        uiRefresher->wake();
+    } else {
+        stationGrid->setState(portName, tr("端口打开失败"));
+    }
 }
 
-void Widget::dealWithRecData(qint64 bytes)
+void Widget::onPortsChanged(const QStringList &ports)
 {
-    QString tmpBuff;
-    for(int i=0; i < bytes; i++) {
-        tmpBuff.append( recBuff.at(i) );
+    for (const QString &port : ports) {
+        if (ui->serialPortNameComboBox->findText(port) < 0)
+            ui->serialPortNameComboBox->addItem(port);
+        stationGrid->addPort(port);
     }
+}
 
-    // 处理返回的结果
-    comTest->DealWithAck( tmpBuff );
+void Widget::onPortAdded(const QString &portName)
+{
+    logMsg(QString("检测到新端口 %1").arg(portName));
+}
 
-    qDebug() << "len:" << bytes << " data:" << tmpBuff;
-//    qDebug() << "debug_com buff:" << gzAckBuffList[IDX_DEBUG_COM];
+void Widget::onPortRemoved(const QString &portName)
+{
+    logMsg(QString("端口已拔出 %1").arg(portName));
+    const int index = ui->serialPortNameComboBox->findText(portName);
+    if (index >= 0 && ui->serialPortNameComboBox->currentText() != portName)
+        ui->serialPortNameComboBox->removeItem(index);
+    // 空闲工位保持打开的端口一并关闭; 正在测试的工位保留, 由测试结果报告断线
+    if (station->portName() == portName)
+        station->closeSession();
+    for (auto s : stations) {
+        if (s->portName() != portName)
+            continue;
+        if (s->isRunning())
+            return;
+        s->closeSession();
+    }
+    stationGrid->removePort(portName);
 }
 
-void Widget::readToSend(QByteArray data)
+void Widget::onDutDetected(const QString &portName)
 {
-    sendBuff.clear();
-    sendBuff = data;
-    emit writeBytesChanged( sendBuff.length() );
+    logMsg(QString("[%1] 检测到工装板").arg(portName));
+    if (!ui->autoStartCheckBox->isChecked())
+        return;
+
+    if (ui->multiStationCheckBox->isChecked()) {
+        stationGrid->addPort(portName, true);
+        startStation(portName);
+        return;
+    }
+    if (station->isRunning())
+        return;
+    ui->serialPortNameComboBox->setCurrentText(portName);
+    on_startBtn_clicked();
 }
 
-void Widget::dealWithSendData(qint64 bytes)
+// 先于 onDutDetected, 等探测的开始先执行, 自动开始时工位已在测试
+void Widget::onProbeFinished(const QString &portName)
 {
-    auto count = writeData( sendBuff );
-    qDebug() << "send data len: " << count << "actual send data len:" << count;
+    if (pendingStations.remove(portName))
+        startStation(portName);
+    if (pendingStartPort != portName)
+        return;
+    pendingStartPort.clear();
+    // 等待期间切换了端口或模式时不再开始
+    if (!ui->multiStationCheckBox->isChecked() && !station->isRunning()
+            && ui->serialPortNameComboBox->currentText().trimmed() == portName)
+        on_startBtn_clicked();
 }
 
 MyProgressDlg::MyProgressDlg(QWidget *parent)
@@ -277,11 +495,11 @@ MyProgressDlg::~MyProgressDlg()
 
 void MyProgressDlg::keyPressEvent(QKeyEvent *event)
 {
-    qDebug("widget, esc pressed");
+    qCDebug(lcUi, "widget, esc pressed");
     switch (event->key())
     {
     case Qt::Key_Escape:
-        qDebug("widget, esc pressed");
+        qCDebug(lcUi, "widget, esc pressed");
         break;
     default:
         QDialog::keyPressEvent(event);
@@ -289,292 +507,36 @@ void MyProgressDlg::keyPressEvent(QKeyEvent *event)
     }
 }
 
-ComTest::ComTest(void)
-{
-    QString header = "gz_test com";
-    m_gzTestBuffList << header + " uart_debug";
-    m_gzTestBuffList << header + " ethernet";
-    m_gzTestBuffList << header + " 485";
-    m_gzTestBuffList << header + " can";
-    m_gzTestBuffList << header + " pmbus";
-
-    m_ackMap.insert("uart_debug", TEST_IDX_DEBUG_COM);
-    m_ackMap.insert("ethernet",   TEST_IDX_ETHERNET);
-    m_ackMap.insert("485",        TEST_IDX_485);
-    m_ackMap.insert("can",        TEST_IDX_CAN);
-    m_ackMap.insert("pmbus",      TEST_IDX_PMBUS);
-
-    m_stepMap.insert("ack uart_debug",  GZ_ACK_DEBUG_COM_SUCCESS);
-    m_stepMap.insert("nack uart_debug", GZ_ACK_DEBUG_COM_FAILED);
-    m_stepMap.insert("ack ethernet",    GZ_ACK_ETHERNET_SUCCESS);
-    m_stepMap.insert("nack ethernet",   GZ_ACK_ETHERNET_FAILED);
-    m_stepMap.insert("ack 485",         GZ_ACK_485_SUCCESS);
-    m_stepMap.insert("nack 485",        GZ_ACK_485_FAILED);
-    m_stepMap.insert("ack can",         GZ_ACK_CAN_SUCCESS);
-    m_stepMap.insert("nack can",        GZ_ACK_CAN_FAILED);
-    m_stepMap.insert("ack pmbus",       GZ_ACK_PMBUS_SUCCESS);
-    m_stepMap.insert("nack pmbus",      GZ_ACK_PMBUS_FAILED);
-}
-
-ComTest::~ComTest(void)
-{
-
-}
 
-int ComTest::Test(void)
+void Widget::on_btn_latency_clicked()
 {
-    quint32 timeout = 0;
-    eTestStepDef step = GZ_STEP_DEBUG_COM;
-    uint32_t progress_cnt = 0;
-    uint32_t progress_part = 0;
-    QString log;
-    uint8_t mask = 0;
-
-    // 发送查询设备是否在线
-    while( true )
-    {
-restart:
-        switch( step ) {
-        case GZ_STEP_DEBUG_COM:
-            // 测试调试用串口
-            emit sendData(m_gzTestBuffList[ TEST_IDX_DEBUG_COM ].toLatin1());
-            qDebug() << "debug com test";
-            break;
-        case GZ_STEP_ETHERNET:
-            // 测试以太网
-            emit sendData(m_gzTestBuffList[ TEST_IDX_ETHERNET ].toLatin1());
-            break;
-        case GZ_STEP_485:
-            // 测试485
-            emit sendData(m_gzTestBuffList[ TEST_IDX_485 ].toLatin1());
-            break;
-        case GZ_STEP_CAN:
-            // 测试can
-            emit sendData(m_gzTestBuffList[ TEST_IDX_CAN ].toLatin1());
-            break;
-        case GZ_STEP_PMBUS:
-            // 测试pmbus
-            emit sendData(m_gzTestBuffList[ TEST_IDX_PMBUS ].toLatin1());
-            break;
-        default:
-            break;
-        }
-        m_ack = GZ_ACK_NONE;
-
-        // waiting
-        while( true )
-        {
-            switch( m_ack ) {
-            case GZ_ACK_NONE:
-                // todo...
-                Delay_MSec_Suspend(200);
-                timeout ++;
-                progress_cnt++;
-                emit progress(progress_part, progress_cnt);
-                qDebug() << "timeout: " << timeout;
-                if( timeout > 15 ) // 3s超时
-                {
-                    // timeout, debug comm has problem
-                    return GZ_END_COM_TIMEOUT;
-                }
-                break;
-            case GZ_ACK_DEBUG_COM_SUCCESS:
-                step = GZ_STEP_ETHERNET;
-                timeout = 0;
-                progress_part = 1;
-                progress_cnt = 0;
-                log = "debug com success";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\n调试串口  \t正常"));
-                goto restart;
-                break;
-            case GZ_ACK_DEBUG_COM_FAILED:
-                step = GZ_STEP_ETHERNET;
-                timeout = 0;
-                progress_part = 1;
-                progress_cnt = 0;
-                log = "debug com failed";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\n调试串口  \t异常"));
-                goto restart;
-                break;
-            case GZ_ACK_ETHERNET_SUCCESS:
-                step = GZ_STEP_485;
-                timeout = 0;
-                progress_part = 2;
-                progress_cnt = 0;
-                log = "ethernet com success";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\n以太网通信  \t正常"));
-                goto restart;
-                break;
-            case GZ_ACK_ETHERNET_FAILED:
-                step = GZ_STEP_485;
-                timeout = 0;
-                progress_part = 2;
-                progress_cnt = 0;
-                log = "ethernet com failed";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\n以太网通信  \t异常"));
-                goto restart;
-                break;
-            case GZ_ACK_485_SUCCESS:
-                step = GZ_STEP_CAN;
-                timeout = 0;
-                progress_part = 3;
-                progress_cnt = 0;
-                log = "485 com success";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\n485通信  \t正常"));
-                goto restart;
-                break;
-            case GZ_ACK_485_FAILED:
-                step = GZ_STEP_CAN;
-                timeout = 0;
-                progress_part = 3;
-                progress_cnt = 0;
-                log = "485 com failed, result:";
-                log += QString::number( m_result[TEST_IDX_485].result, 16);
-                qDebug() << log;
-                emit logInfo(log);
-
-                m_result_info.append(tr("\r\n485通信  \t异常"));
-                m_result_info.append(tr("\r\n(详情如下)："));
-                for(int i=0; i<8; i++) {
-                    m_result_info.append(tr("\r\n\t通道"));
-                    m_result_info.append( QString::number( (i+1), 10 ) );
-
-                    mask = 1<<i;
-                    if(m_result[TEST_IDX_485].result & mask)
-                        m_result_info.append(tr("正常"));
-                    else
-                        m_result_info.append(tr("异常"));
-                }
-                goto restart;
-                break;
-            case GZ_ACK_CAN_SUCCESS:
-                step = GZ_STEP_PMBUS;
-                timeout = 0;
-                progress_part = 4;
-                progress_cnt = 0;
-                emit progress(progress_part, progress_cnt);
-                log = "can com success";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\ncan通信  \t正常"));
-                goto restart;
-                break;
-            case GZ_ACK_CAN_FAILED:
-                step = GZ_STEP_PMBUS;
-                timeout = 0;
-                progress_part = 4;
-                progress_cnt = 0;
-                emit progress(progress_part, progress_cnt);
-                log = "can com failed";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\ncan通信  \t异常"));
-                goto restart;
-                break;
-            case GZ_ACK_PMBUS_SUCCESS:
-                // end
-                timeout = 0;
-                progress_part = 5;
-                progress_cnt = 0;
-                emit progress(progress_part, progress_cnt);
-                log = "pmbus com success";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\npmbus通信  \t正常"));
-                goto end;
-                break;
-            case GZ_ACK_PMBUS_FAILED:
-                // end
-                timeout = 0;
-                progress_part = 5;
-                progress_cnt = 0;
-                emit progress(progress_part, progress_cnt);
-                log = "pmbus com failed";
-                qDebug() << log;
-                emit logInfo(log);
-                m_result_info.append(tr("\r\npmbus通信  \t异常"));
-                goto end;
-                break;
-            default:
-                break;
-            }
-        }
-        timeout = 0;
-    }
-
-end:
-    for(int i = 0; i < TEST_ITEMS_NUM; i++ ) {
-        if( m_result[i].isPass != true )
-            return GZ_END_FAILED;
-    }
-
-    return GZ_END_SUCCESS;
+    if (latencyDlg == nullptr)
+        latencyDlg = new LatencyDialog(latencyStats, this);
+    latencyDlg->show();
+    latencyDlg->raise();
+    latencyDlg->refresh();
 }
 
-void ComTest::DealWithAck( QString ackBuff )
+void Widget::on_btn_yield_clicked()
 {
-    /* eg. ackBuff: gz_com test ack/nack debug_com */
-    QStringList ack = ackBuff.split(' ');
-
-    if(ack.size() < 4){
-        qDebug("err ack, return");
-        return;
-    }
-
-    QMap<QString, int>::const_iterator it = m_ackMap.find(ack.at(3));
-    if(it == m_ackMap.end()) {
-        qDebug("err, not find buff1 ,return");
-        return;
-    }
-
-    int id = it.value();
-    qDebug()<<"id:"<<id;
-    SaveResult(ackBuff, id);
-
-    // verify step
-    QString toVerifyStep;
-    toVerifyStep.append(ack.at(2));
-    toVerifyStep.append(" ");
-    toVerifyStep.append(ack.at(3));
-    QMap<QString, eTestAckDef>::const_iterator it2;
-    it2 = m_stepMap.find(toVerifyStep);
-    if(it2 == m_stepMap.end())
-    {
-        qDebug("err, not find buff2, return");
-        return;
-    }
-    m_ack = it2.value();
+    if (yieldDlg == nullptr)
+        yieldDlg = new YieldDialog(yieldStats, resultStore, startedAt, this);
+    yieldDlg->show();
+    yieldDlg->raise();
 }
 
-void ComTest::SaveResult(QString ackBuff, int id)
+void Widget::on_btn_monitor_clicked()
 {
-    QStringList ack = ackBuff.split(' ');
-    qDebug() << "ack list size:" << ack.size();
-
-    if( 0 == ack[2].compare("ack") ){
-        m_result[id].isPass = true;
-    }else if( 0 == ack[2].compare("nack") ){
-        m_result[id].isPass = false;
-        if( 0 == ack[3].compare("485") ) {
-            if(ack.size() <= 4)
-                m_result[id].result = 0;
-            else
-                m_result[id].result = static_cast<uint32_t>( ack[4].toULong(nullptr, 16) );
-        }
+    if (hexMonitor == nullptr) {
+        hexMonitor = new HexMonitorDialog(this);
+        hexMonitor->attach(station);
+        for (auto s : stations)
+            hexMonitor->attach(s);
     }
+    hexMonitor->show();
+    hexMonitor->raise();
 }
 
-
 void Widget::on_btn_about_clicked()
 {
     QMessageBox::about(this, tr("关于"), tr("功能: avg充电站工装测试软件\r\n"
@@ -582,5 +544,11 @@ void Widget::on_btn_about_clicked()
                                           "编译时间:  20191126 16:26\r\n"
                                           "作者:  李扬\r\n"
                                           "邮箱:  liyang@ecthf.com\r\n"
-                                          "公司：安徽博微智能电气有限公司"));
+                                          "公司：安徽博微智能电气有限公司\r\n"
+                                          "本机地址:  %1").arg(hostIp.isEmpty() ? tr("未知") : hostIp));
+}
+
+void Widget::onHostLookedUp(const QHostInfo &info)
+{
+    hostIp = ipFromHostInfo(info);
 }
@@ -4,14 +4,27 @@
 #include <QWidget>
 #include <QProgressDialog>
 #include <QMap>
+#include <QSet>
+#include <QTimer>
+#include <QHostInfo>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class Widget; }
 QT_END_NAMESPACE
 
-class AbstractReadWriter;
-class ComTest;
+class HexMonitorDialog;
+class LatencyDialog;
+class LatencyStats;
+class YieldDialog;
+class YieldStats;
+class LogModel;
 class MyProgressDlg;
+class PortMonitor;
+class StationGrid;
+class TestStation;
+class ControlServer;
+class ResultStore;
+class UiRefresher;
 
 class Widget : public QWidget
 {
@@ -20,6 +33,7 @@ class Widget : public QWidget
 #define    W_MAIN_WIDGET      580
 #define    H_MAIN_WIDGET      100
 #define    H_EXT_MAIN_WIDGET  350
+#define    H_DETAIL_AREA      (H_EXT_MAIN_WIDGET - H_MAIN_WIDGET)
 
 
 public:
@@ -27,44 +41,66 @@ public:
     ~Widget();
 
     void createConnect();
-
-public:
-signals:
-    void serialStateChanged(bool);
-    void writeBytesChanged(qint64 bytes);
-    void readBytesChanged(qint64 bytes);
+    // 启动耗时报告写入详细信息
+    void logStartupReport(const QString &report) { logMsg(report); }
 
 private slots:
     void on_showDetailBtn_toggled(bool checked);
+    void on_multiStationCheckBox_toggled(bool checked);
+    void on_serialLineEdit_returnPressed();
+    void on_keepOpenCheckBox_toggled(bool checked);
     void on_startBtn_clicked();
 
-    bool openReadWriter();
-    void closeReadWriter();
-    void readData();
-    qint64 writeData(const QByteArray &data);
-
-    void readToSend(QByteArray data);
-    void dealWithRecData(qint64 bytes);
-    void dealWithSendData(qint64 bytes);
     void startTest(void);
+    void onTestFinished(int ret);
+    void startMultiStation(void);
 
     void logMsg(const QString &message);
 
     void on_btn_about_clicked();
+    void onHostLookedUp(const QHostInfo &info);
+    void on_btn_latency_clicked();
+    void on_btn_yield_clicked();
+    void on_btn_monitor_clicked();
+
+    void onPortsChanged(const QStringList &ports);
+    void onPortAdded(const QString &portName);
+    void onPortRemoved(const QString &portName);
+    void onDutDetected(const QString &portName);
+    void onProbeFinished(const QString &portName);
 
 private:
-    QStringList getSerialNameList();
-    bool isReadWriterConnected();
-    void parse_rec_data(QByteArray rec);
+    MyProgressDlg *progressDlg(void);
+    void updateLayout(void);
+    TestStation *multiStation(const QString &portName);
+    void startStation(const QString &portName);
+    void dumpTrace(TestStation *s);
+    void startControlServer(void);
+    void openResultStore(void);
 
 private:
     Ui::Widget *ui;
-    AbstractReadWriter *_readWriter{nullptr};
-    qint64 sendCount{0};
-    qint64 receiveCount{0};
-    QByteArray recBuff;
-    QByteArray sendBuff;
-    ComTest *comTest = nullptr;
+    TestStation *station = nullptr;
+    QList<TestStation *> stations;  // 多工位模式, 每个端口一个
+    StationGrid *stationGrid = nullptr;
+    LogModel *logModel = nullptr;
+    UiRefresher *uiRefresher = nullptr;  // 进度按固定帧率刷新, 所有工位共用
+    LatencyStats *latencyStats = nullptr;  // 本次运行所有工位共用
+    ResultStore *resultStore = nullptr;  // 所有工位共用, 环境变量 GZ_RESULT_DB 为空时不保存
+    LatencyDialog *latencyDlg = nullptr;
+    YieldStats *yieldStats = nullptr;  // 良率与产能, 每次测试结束时增量更新
+    YieldDialog *yieldDlg = nullptr;
+    qint64 startedAt = 0;  // 此后的测试实时计入 yieldStats, 之前的从结果库导入
+    HexMonitorDialog *hexMonitor = nullptr;  // 第一次打开时创建
+    PortMonitor *portMonitor = nullptr;
+    // 点开始时端口正在被探测, 探测结束后再开始
+    QString pendingStartPort;
+    QSet<QString> pendingStations;
+    ControlServer *controlServer = nullptr;  // 环境变量 GZ_CONTROL_PORT / GZ_CONTROL_SOCKET 设置时开启
+    QString hostIp;
+    QString traceDir;  // 环境变量 GZ_TRACE_DIR, 非空时开启跟踪环, 测试未通过时写入该目录
+    QString captureDir;  // 环境变量 GZ_CAPTURE_DIR, 非空时每次测试抓包到该目录
+    bool logFollowTail = true;
     MyProgressDlg *testProgressDlg = nullptr;
 };
 
@@ -107,86 +143,5 @@ private:
     int m_partNum = 0; // m_maxValue一共分为m_partNum份，用来作为阶段进度显示
 };
 
-class ComTest : public QObject
-{
-    Q_OBJECT
-
-#define    TEST_ITEMS_NUM  5
-
-#define    MAX_FAIL_CNT    3
-
-#define    TEST_IDX_DEBUG_COM    0
-#define    TEST_IDX_ETHERNET     1
-#define    TEST_IDX_485          2
-#define    TEST_IDX_CAN          3
-#define    TEST_IDX_PMBUS        4
-
-    typedef enum _gz_test_step{
-        GZ_STEP_DEBUG_COM,
-        GZ_STEP_ETHERNET,
-        GZ_STEP_485,
-        GZ_STEP_CAN,
-        GZ_STEP_PMBUS
-    }eTestStepDef;
-    typedef enum _gz_test_ack_def{
-        GZ_ACK_NONE,
-        GZ_ACK_DEBUG_COM_SUCCESS,
-        GZ_ACK_DEBUG_COM_FAILED,
-        GZ_ACK_ETHERNET_SUCCESS,
-        GZ_ACK_ETHERNET_FAILED,
-        GZ_ACK_485_SUCCESS,
-        GZ_ACK_485_FAILED,
-        GZ_ACK_CAN_SUCCESS,
-        GZ_ACK_CAN_FAILED,
-        GZ_ACK_PMBUS_SUCCESS,
-        GZ_ACK_PMBUS_FAILED
-    }eTestAckDef;
-    Q_ENUM(eTestAckDef)
-
-    typedef struct {
-        bool isPass;
-        uint32_t result;
-    }eTestDetailDef;
-
-    typedef enum _gz_test_end {
-        GZ_END_SUCCESS,
-        GZ_END_FAILED,
-        GZ_END_COM_TIMEOUT
-    }eTestEndResult;
-
-public:
-    ComTest();
-    ~ComTest();
-
-public slots:
-    int Test(void);
-    void DealWithAck( QString ackBuff );
-    void SaveResult(QString ack, int id);
-    void Reset(void) {
-        m_ack = GZ_ACK_NONE;
-        m_result_info = "\r\n结果如下:\r\n";
-        for(int i=0; i<TEST_ITEMS_NUM; i++) {
-            m_result[i].isPass = false;
-            m_result[i].result = 0;
-        }
-    }
-signals:
-    void sendData(QByteArray data);
-    void progress(int part, int cnt);
-    void logInfo(const QString &message);
-
-private:
-    friend class Widget;
-
-    eTestAckDef m_ack = GZ_ACK_NONE;
-    eTestDetailDef m_result[TEST_ITEMS_NUM];
-    QString m_result_info = "\r\n结果如下:\r\n";
-
-    QStringList m_gzTestBuffList;
-    QMap<QString, int> m_ackMap;
-    QMap<QString, eTestAckDef> m_stepMap;
-    int m_testItemsNum = TEST_ITEMS_NUM;
-};
-
 
 #endif // WIDGET_H